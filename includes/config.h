@@ -60,6 +60,197 @@ ServerConfig_GetMaxFilesNo(const server_config_t* config);
 unsigned long
 ServerConfig_GetStorageSize(const server_config_t* config);
 
+/**
+ * @brief Gets maximum length of the queue of pending connections.
+ * @returns Maximum number of pending connections on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to "SOMAXCONN".
+*/
+unsigned long
+ServerConfig_GetMaxPendingConnections(const server_config_t* config);
+
+/**
+ * @brief Gets number of reactors, i.e. threads monitoring clients.
+ * @returns Number of reactors on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 1.
+*/
+unsigned long
+ServerConfig_GetReactorsNo(const server_config_t* config);
+
+/**
+ * @brief Gets I/O backend used to receive requests.
+ * @returns I/O backend on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to "EPOLL".
+*/
+io_backend_t
+ServerConfig_GetIOBackend(const server_config_t* config);
+
+/**
+ * @brief Gets size of the largest payload which is copied into a reply: larger ones are sent from their own buffer.
+ * @returns Threshold in bytes on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 16384.
+*/
+unsigned long
+ServerConfig_GetCopyThreshold(const server_config_t* config);
+
+/**
+ * @brief Gets minimum number of workers: idle ones are retired as long as there are more.
+ * @returns Minimum number of workers on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to the number of workers.
+*/
+unsigned long
+ServerConfig_GetMinWorkersNo(const server_config_t* config);
+
+/**
+ * @brief Gets maximum number of workers: more are spawned under load as long as there are fewer.
+ * @returns Maximum number of workers on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to the number of workers.
+*/
+unsigned long
+ServerConfig_GetMaxWorkersNo(const server_config_t* config);
+
+/**
+ * @brief Gets average time ready clients may wait for a worker, in microseconds, before more workers are spawned.
+ * @returns Threshold on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 1000.
+*/
+unsigned long
+ServerConfig_GetScaleUpWait(const server_config_t* config);
+
+/**
+ * @brief Gets number of ready clients which may wait for a worker before more workers are spawned.
+ * @returns Threshold on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 16.
+*/
+unsigned long
+ServerConfig_GetScaleUpDepth(const server_config_t* config);
+
+/**
+ * @brief Gets time a worker has to be idle for, in milliseconds, before it gets retired.
+ * @returns Cooldown on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 5000.
+*/
+unsigned long
+ServerConfig_GetIdleCooldown(const server_config_t* config);
+
+/**
+ * @brief Gets number of workers serving metadata requests only, i.e. those which do not move file contents
+ * or move no more than a threshold. They are not counted among the other workers.
+ * @returns Number of metadata workers on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 0, i.e. every worker serves any request.
+*/
+unsigned long
+ServerConfig_GetMetadataWorkersNo(const server_config_t* config);
+
+/**
+ * @brief Gets size of the largest payload a request may move to be served by metadata workers.
+ * @returns Threshold in bytes on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 65536.
+*/
+unsigned long
+ServerConfig_GetMetadataThreshold(const server_config_t* config);
+
+/**
+ * @brief Gets quantum of bytes credited to a client every time it is served: clients which have moved more
+ * than their credit yield to the others as soon as their current request has been served.
+ * @returns Quantum in bytes on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 1048576.
+*/
+unsigned long
+ServerConfig_GetClientQuantum(const server_config_t* config);
+
+/**
+ * @brief Gets maximum number of requests of a client served before their replies are sent and it yields to the others.
+ * @returns Maximum number of requests in flight on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 64.
+*/
+unsigned long
+ServerConfig_GetClientInFlight(const server_config_t* config);
+
+/**
+ * @brief Gets what threads do when their log buffer is full: either wait for it to be flushed or drop the record.
+ * @returns Overflow policy on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to "LOG_BLOCK".
+*/
+log_overflow_t
+ServerConfig_GetLogOverflow(const server_config_t* config);
+
+/**
+ * @brief Gets sampling rate of the log: one request in as many as it tells is logged by each thread,
+ * whereas clients joining and leaving, evictions and pools being resized are always logged.
+ * @returns Sampling rate on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to 1, i.e. every request is logged.
+*/
+unsigned long
+ServerConfig_GetLogSampling(const server_config_t* config);
+
+/**
+ * @brief Gets format log is written in: binary logs are read by "logstat", which may render them as text.
+ * @returns Log format on success, 0 on failure.
+ * @param config cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note It is an optional param: when it is not specified, it defaults to "LOG_TEXT".
+*/
+log_format_t
+ServerConfig_GetLogFormat(const server_config_t* config);
+
+/**
+ * @brief Copies CPUs reactors are pinned to into non-allocated buffer, in the order they have been specified:
+ * reactor i is pinned to the i-th one, round-robin.
+ * @returns Number of CPUs on success, 0 on failure or if they have not been specified.
+ * @param config cannot be NULL.
+ * @param cpus_ptr cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "malloc".
+ * @note It is an optional param: when it is not specified, reactors are not pinned. CPUs are given as a list
+ * of ids and ranges, such as "0-3,8".
+*/
+unsigned long
+ServerConfig_GetReactorsCPUs(const server_config_t* config, int** cpus_ptr);
+
+/**
+ * @brief Copies CPUs workers are pinned to into non-allocated buffer: workers of a reactor are pinned to those
+ * lying on the same NUMA node as their reactor, if any.
+ * @returns Number of CPUs on success, 0 on failure or if they have not been specified.
+ * @param config cannot be NULL.
+ * @param cpus_ptr cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "malloc".
+ * @note It is an optional param: when it is not specified, workers are not pinned. CPUs are given as a list
+ * of ids and ranges, such as "0-3,8".
+*/
+unsigned long
+ServerConfig_GetWorkersCPUs(const server_config_t* config, int** cpus_ptr);
+
 /**
  * @brief Copies log file path to non-allocated buffer.
  * @returns Length of the string identifying log file path on success, 0 on failure.
@@ -0,0 +1,150 @@
+/**
+ * @brief Header file for an asynchronous log: each thread appends fixed-size binary records to a ring of its own,
+ * a background thread writes them to the log file in batches, either rendered as text or as they are.
+ * @author Giacomo Trapani.
+*/
+
+#ifndef _EVENT_LOG_H_
+#define _EVENT_LOG_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <server_defines.h>
+
+// Struct fields are not exposed to force callee to access it using the implemented methods.
+typedef struct _event_log event_log_t;
+
+// Used to denote logged events: fields each one of them fills in are listed next to it.
+typedef enum _log_event
+{
+	// requests, as served by workers: they are subject to sampling
+	LOG_OPEN, // path, flags, status
+	LOG_OPEN_CREATE, // path, flags, status, count of victims
+	LOG_CLOSE, // path, status
+	LOG_READ, // path, flags, status, bytes
+	LOG_READ_RANGE, // path, args (offset and length), status, bytes
+	LOG_STAT, // path, status, bytes (file size)
+	LOG_RESERVE, // path, status, bytes, count of victims
+	LOG_WRITE, // path, status, bytes, count of victims
+	LOG_APPEND, // path, status, bytes, count of victims
+	LOG_READ_N, // path (prefix), args (N), status, bytes
+	LOG_LIST, // path (prefix), status, bytes
+	LOG_LOCK_WAIT, // path, flags
+	LOG_LOCK, // path, flags, status
+	LOG_UNLOCK, // path, flags, status
+	LOG_REMOVE, // path, status
+	LOG_BATCH, // fd, args (number of requests)
+	LOG_UPLOAD_LEFT, // fd, path
+	LOG_PAYLOAD_LEFT, // fd
+	// events which are always logged
+	LOG_VICTIM, // path
+	LOG_CLIENT_ACCEPTED, // fd
+	LOG_ONLINE_CLIENTS, // count of online clients
+	LOG_CLIENT_LEFT, // fd
+	LOG_WORKER_REPLIES, // args (replies and writes)
+	LOG_RESIZE_FAILED, // fd (reactor), status
+	LOG_SCALE_UP, // fd (reactor), args (workers before and after), bytes (average wait in us), count of queued clients
+	LOG_SCALE_DOWN, // fd (reactor), args (workers before and after), bytes (idle time in ms)
+	LOG_MAX_SIZE, // bytes
+	LOG_MAX_FILES, // count of files
+	LOG_DROPPED // count of dropped records
+} log_event_t;
+
+// Used to denote a logged event: fields an event does not fill in are left to 0.
+typedef struct _log_record
+{
+	uint64_t timestamp; // time record has been appended at, in nanoseconds, as given by a monotonic clock
+	uint64_t started; // time the request started being served at, on the same clock, 0 for any other event
+	uint64_t bytes; // bytes moved by the request, or the quantity the event reports
+	uint64_t args[2]; // numerical arguments of the request, or those the event reports
+	uint64_t count; // victims of the request, or the number of things the event reports
+	int32_t thread; // thread which appended the record
+	int32_t fd; // client the request has been sent by, or reactor whose workers have been resized
+	int32_t status; // outcome of the request
+	int32_t flags; // flags of the request
+	uint16_t event; // logged event, as a log_event_t
+	uint16_t path_len; // length of the path record refers to, 0 if there is none
+	uint32_t path_pos; // position of the path in the ring of paths of the thread which appended the record
+} log_record_t;
+
+/**
+ * A binary log starts with a header and goes on with blocks, each one written at once: their header tells
+ * their length so that readers may split the log without going through every record. A block holds entries,
+ * i.e. a record followed by the path it refers to, which is not terminated and is padded to a multiple of 8 bytes.
+ * Entries are laid out as they are in memory: logs are to be read on the machine which has written them.
+*/
+#define LOG_FILE_MAGIC "SOLLOG1" // terminator included, it takes 8 bytes
+#define LOG_BLOCK_MAGIC 0x4b4c4253
+#define LOG_ENTRY_SIZE(path_len) (sizeof(log_record_t) + (((size_t) (path_len) + 7) & ~((size_t) 7)))
+
+// Header of a binary log.
+typedef struct _log_file_header
+{
+	char magic[8]; // LOG_FILE_MAGIC
+	uint32_t record_size; // sizeof(log_record_t)
+	uint32_t sampling; // one request in as many as it tells has been logged by each thread
+} log_file_header_t;
+
+// Header of a block of a binary log.
+typedef struct _log_block
+{
+	uint32_t magic; // LOG_BLOCK_MAGIC
+	uint32_t records; // number of entries block holds
+	uint64_t length; // bytes of entries following the header
+} log_block_t;
+
+/**
+ * @brief Initializes log writing to given file and starts the thread flushing it.
+ * @returns Initialized data structure on success, NULL on failure.
+ * @param file cannot be NULL. Binary logs write their header to it at once.
+ * @param format tells whether records are rendered as text or written as they are.
+ * @param overflow tells whether threads whose ring is full wait for it to be flushed or drop their records.
+ * @param sampling cannot be 0: one request in sampling is logged by each thread.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "malloc", "fwrite", "pthread_mutex_init", "pthread_cond_init",
+ * "pthread_create".
+*/
+event_log_t*
+EventLog_Init(FILE* file, log_format_t format, log_overflow_t overflow, unsigned long sampling);
+
+/**
+ * @brief Appends given record, along with a copy of given path, to callee's own ring. Timestamp and thread are
+ * filled in, the other fields are taken as they are.
+ * @returns 0 on success, -1 on failure.
+ * @param log cannot be NULL.
+ * @param record cannot be NULL.
+ * @param path may be NULL if record refers to none.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "malloc".
+ * @note Records sampled out, or dropped because ring is full, count as a success. The first record appended
+ * by a thread allocates its ring: it is the only one which may fail.
+*/
+int
+EventLog_Append(event_log_t* log, log_record_t* record, const char* path);
+
+/**
+ * @brief Hands callee's ring over to threads started later: records it holds are flushed all the same.
+ * @note It is to be called by threads which exit before the log is freed.
+*/
+void
+EventLog_Detach(event_log_t* log);
+
+/**
+ * @brief Renders given record, along with given path, as a line of text into given buffer.
+ * @returns Length of the line, as "snprintf" would: it has been truncated if it is not lower than size.
+ * @param path is ignored if record refers to none, it cannot be NULL otherwise.
+*/
+size_t
+LogRecord_Format(const log_record_t* record, const char* path, char* buf, size_t size);
+
+/**
+ * @brief Flushes every record appended so far, stops the thread flushing the log and frees allocated resources.
+ * The number of records dropped, if any, is logged last.
+ * @note Log file is flushed but not closed. No thread may append records from now on.
+*/
+void
+EventLog_Free(event_log_t* log);
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @brief Header file for a minimal io_uring submission and completion ring.
+ * @author Giacomo Trapani.
+*/
+
+#ifndef _IO_RING_H_
+#define _IO_RING_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Struct fields are not exposed to force callee to access it using the implemented methods.
+typedef struct _io_ring io_ring_t;
+
+// Used to denote a completed operation.
+typedef struct _io_ring_completion
+{
+	uint64_t user_data; // value given when the operation was prepared
+	int res; // operation's result: on failure, it is a negated errno value
+} io_ring_completion_t;
+
+/**
+ * @brief Initializes ring given the number of operations which may be submitted at once.
+ * @returns Initialized data structure on success, NULL on failure.
+ * @param entries cannot be 0.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "io_uring_setup", "mmap", "malloc", "pthread_mutex_init".
+*/
+io_ring_t*
+IoRing_Init(unsigned entries);
+
+/**
+ * @brief Prepares the receipt of up to given size from given socket into given buffer.
+ * @returns 0 on success, -1 on failure.
+ * @param ring cannot be NULL.
+ * @param buf cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "IoRing_Submit".
+ * @note Operation is not started until "IoRing_Submit" is called.
+*/
+int
+IoRing_PrepareRecv(io_ring_t* ring, int fd, void* buf, size_t size, uint64_t user_data);
+
+/**
+ * @brief Prepares a oneshot wait for given descriptor to be ready for given events, as for "poll".
+ * @returns 0 on success, -1 on failure.
+ * @param ring cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "IoRing_Submit".
+ * @note Operation is not started until "IoRing_Submit" is called.
+*/
+int
+IoRing_PreparePoll(io_ring_t* ring, int fd, short events, uint64_t user_data);
+
+/**
+ * @brief Submits every prepared operation with a single system call.
+ * @returns 0 on success, -1 on failure.
+ * @param ring cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "io_uring_enter".
+*/
+int
+IoRing_Submit(io_ring_t* ring);
+
+/**
+ * @brief Waits for at least a completion, then copies up to given number of completions to given array.
+ * @returns Number of copied completions on success, -1 on failure.
+ * @param ring cannot be NULL.
+ * @param completions cannot be NULL.
+ * @param max cannot be 0.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "io_uring_enter".
+ * @note Operations may be prepared and submitted by any thread, but completions are to be waited for by a single one.
+*/
+int
+IoRing_WaitCompletions(io_ring_t* ring, io_ring_completion_t* completions, unsigned max);
+
+/**
+ * Frees allocated resources. Pending operations are cancelled.
+*/
+void
+IoRing_Free(io_ring_t* ring);
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @brief Header file for radix tree data structure.
+ * @author Giacomo Trapani.
+*/
+
+#ifndef _RADIX_TREE_H_
+#define _RADIX_TREE_H_
+
+#include <stdlib.h>
+
+#include <linked_list.h>
+
+// Struct fields are not exposed to maintain invariant.
+typedef struct _radix_tree radix_tree_t;
+
+/**
+ * @brief Initializes empty radix tree data structure.
+ * @returns Initialized data structure on success, NULL on failure.
+ * @exception It sets "errno" for any of the errors specified for the routine "malloc".
+*/
+radix_tree_t*
+RadixTree_Init();
+
+/**
+ * @brief Inserts given key into tree. Duplicates are not allowed.
+ * @returns 1 on successful insertion, 0 if it is a duplicate, -1 on failure.
+ * @param tree cannot be NULL.
+ * @param key cannot be NULL or empty.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "malloc", "realloc".
+*/
+int
+RadixTree_Insert(radix_tree_t* tree, const char* key);
+
+/**
+ * @brief Removes given key from tree.
+ * @returns 1 on successful deletion, 0 if such key does not exist, -1 on failure.
+ * @param tree cannot be NULL.
+ * @param key cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+*/
+int
+RadixTree_Remove(radix_tree_t* tree, const char* key);
+
+/**
+ * @brief Checks whether tree contains given key.
+ * @returns 1 if it contains the key, 0 if it does not, -1 on failure.
+ * @param tree cannot be NULL.
+ * @param key cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+*/
+int
+RadixTree_Contains(const radix_tree_t* tree, const char* key);
+
+/**
+ * @brief Copies keys starting with given prefix into a new list, sorted in lexicographical order.
+ * @returns Copied list on success (which may be empty), NULL on failure.
+ * @param tree cannot be NULL.
+ * @param prefix if NULL or empty, every key is copied.
+ * @param max if 0, every matching key is copied.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "malloc", "realloc", "LinkedList_Init", "LinkedList_PushBack".
+ * @note Only the subtree rooted at the node matching the prefix is visited.
+*/
+linked_list_t*
+RadixTree_CopyKeysWithPrefix(const radix_tree_t* tree, const char* prefix, size_t max);
+
+/**
+ * @brief Gets number of keys in tree.
+*/
+size_t
+RadixTree_GetNumberOfKeys(const radix_tree_t* tree);
+
+/**
+ * Frees allocated resources.
+*/
+void
+RadixTree_Free(radix_tree_t* tree);
+
+#endif
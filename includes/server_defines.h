@@ -6,6 +6,9 @@
 #ifndef _OPCODES_H_
 #define _OPCODES_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define SET_FLAG(mask, flag) mask |= flag // sets flag in mask
 #define RESET_MASK(mask) mask = 0 // resets mask
 
@@ -22,6 +25,13 @@
 #define MAXPATH 108
 #define SIZELEN 32 // used when converting numerical types to strings
 #define REQUESTLEN 2048
+#define STATLEN (4 * SIZELEN) // used when sending a file's metadata as a message
+
+#define PROTOCOL_MAGIC 0xB1 // first byte of every binary frame: text requests always start with a digit
+#define PROTOCOL_VERSION 1 // incremented whenever binary frames' layout changes
+#define IS_BINARY_FRAME(buf) (((const unsigned char*) (buf))[0] == PROTOCOL_MAGIC)
+#define READ_CONTENTS 1 // flag used when file contents are to be sent back by READ
+#define WRITE_RESERVE 1 // flag used when space is to be reserved by WRITE before file contents are sent
 
 // Used to denote allowed operations on file system
 typedef enum opcodes
@@ -35,9 +45,56 @@ typedef enum opcodes
 	LOCK,
 	UNLOCK,
 	REMOVE,
-	TERMINATE
+	TERMINATE,
+	READ_RANGE,
+	STAT,
+	LIST,
+	BATCH
 } opcodes_t;
 
+/**
+ * Used to denote the fixed size header of a binary request. It is followed by "path_len" bytes of path
+ * (not nul terminated) and then by "payload_len" bytes of payload, holding either the contents to be written
+ * or the numerical arguments of the request as 64-bit integers.
+ * A BATCH request carries the number of requests it is made of as a 64-bit integer, followed by the requests
+ * themselves as binary frames: its payload length accounts for all of them.
+ * Integers are sent in host byte order as both ends share the same machine.
+*/
+typedef struct _request_header
+{
+	uint8_t magic; // always set to PROTOCOL_MAGIC
+	uint8_t version; // always set to PROTOCOL_VERSION
+	uint8_t opcode; // operation to be run
+	uint8_t flags; // operation's flags
+	uint16_t path_len; // length of the following path
+	uint16_t reserved; // always set to 0
+	uint64_t payload_len; // length of the payload following the path
+	uint64_t request_id; // echoed back inside the reply
+} request_header_t;
+
+/**
+ * Used to denote the fixed size header of a binary reply. Sizes, counts and names sent after it
+ * follow the same format: a 64-bit integer, followed by the bytes it accounts for when sending a name or contents.
+ * The reply to a BATCH request is followed by the number of requests it is made of and by their replies, in order.
+*/
+typedef struct _reply_header
+{
+	uint8_t magic; // always set to PROTOCOL_MAGIC
+	uint8_t status; // OP_SUCCESS, OP_FAILURE or OP_FATAL
+	uint16_t reserved; // always set to 0
+	int32_t error; // errno value, set to 0 on success
+	uint64_t request_id; // id of the request being replied to
+} reply_header_t;
+
+// Used to denote metadata of a file inside the storage
+typedef struct _file_stat
+{
+	size_t size; // size of file contents
+	unsigned long version; // incremented whenever file contents get modified
+	int lock_owner; // lock owner's fd; when there is none, it is set to 0.
+	size_t open_count; // number of clients which called open on this file
+} file_stat_t;
+
 // Used to denote implemented replacement policies
 typedef enum _replacement_policy
 {
@@ -46,4 +103,25 @@ typedef enum _replacement_policy
 	LFU
 } replacement_policy_t;
 
+// Used to denote implemented I/O backends
+typedef enum _io_backend
+{
+	EPOLL,
+	IO_URING
+} io_backend_t;
+
+// Used to denote what threads do when their log buffer is full
+typedef enum _log_overflow
+{
+	LOG_BLOCK,
+	LOG_DROP
+} log_overflow_t;
+
+// Used to denote formats the log may be written in
+typedef enum _log_format
+{
+	LOG_TEXT,
+	LOG_BINARY
+} log_format_t;
+
 #endif
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 #include <sys/time.h>
 
+#include <server_defines.h>
+
 extern bool print_enabled; // toggled on when client enables output on stdout
 extern bool exit_on_fatal_errors; // if toggled on, when any fatal error occurs in the filesystem the client exits.
 
@@ -44,12 +46,26 @@ closeConnection(const char* sockname);
  * any of the errors specified for the routines "writen", "readn", "Storage_openFile".
  * @note A fatal error may be triggered inside the storage when processing this request, therefore the callee may exit with
  * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
- * In order for the routine to succeed, the storage needs to have enough room for a new file and - if mutual exclusion over
- * it has been requested - the lock over the file must either be owned by callee or by none.
+ * In order for the routine to succeed - if mutual exclusion over it has been requested - the lock over the file must either
+ * be owned by callee or by none. Files evicted to make room for a new file are discarded: see "openFileEvicted".
 */
 int
 openFile(const char* pathname, int flags);
 
+/**
+ * @brief Requests server to open or create given file; files evicted to make room for it are stored in given directory.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @param dirname if NULL, files evicted because of this operation will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one. The function may also fail and set "errno" for
+ * any of the errors specified for the routines "writen", "readn", "malloc", "savefile", "Storage_openFile".
+ * @note The same notes as "openFile" apply. When "O_CREATE" is set and the storage already holds its maximum number of
+ * files, the server evicts files according to its replacement policy instead of failing.
+*/
+int
+openFileEvicted(const char* pathname, int flags, const char* dirname);
+
 /**
  * @brief Requests server to read given file; it also sets given pointers to its contents and its size.
  * @returns 0 on success, -1 on failure.
@@ -66,6 +82,41 @@ openFile(const char* pathname, int flags);
 int
 readFile(const char* pathname, void** buf, size_t* size);
 
+/**
+ * @brief Requests server to read a slice of given file, starting at given offset and spanning up to given length bytes.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @param offset if it is not less than the size of the file, an empty slice will be read.
+ * @param len if 0, the slice will span until the end of the file.
+ * @param buf cannot be NULL.
+ * @param size cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one. The function may also fail and set "errno" for
+ * any of the errors specified for the routines "writen", "readn", "malloc", "Storage_readFileRange".
+ * @note A fatal error may be triggered inside the storage when processing this request, therefore the callee may exit with
+ * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+ * In order for a file to be read, it is required from the callee to have already opened it. Only the requested slice
+ * is sent over the socket.
+*/
+int
+readFileRange(const char* pathname, size_t offset, size_t len, void** buf, size_t* size);
+
+/**
+ * @brief Requests server for given file's metadata; neither its contents are transferred nor the file is opened.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @param stat cannot be NULL. On success it is set to the file's size, version, lock owner and number of clients
+ * which opened it.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one. The function may also fail and set "errno" for
+ * any of the errors specified for the routines "writen", "readn", "Storage_statFile".
+ * @note A fatal error may be triggered inside the storage when processing this request, therefore the callee may exit with
+ * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+ * The file is not required to have been opened by the callee.
+*/
+int
+statFile(const char* pathname, file_stat_t* stat);
+
 /**
  * @brief Requests server to read up to given param files.
  * @returns 0 on success, -1 on failure.
@@ -77,20 +128,54 @@ readFile(const char* pathname, void** buf, size_t* size);
  * @note A fatal error may be triggered inside the storage when processing this request, therefore the callee may exit with
  * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
  * The only files this routine cannot access are the ones locked by other callees: it does not require the files to be opened by
- * callee.
+ * callee. Files are streamed by the server one at a time and each of them is stored as soon as it has been received.
 */
 int
 readNFiles(int N, const char* dirname);
 
 /**
- * @brief Uploads given file to server.
+ * @brief Requests server to read up to given param files whose name starts with given prefix.
+ * @returns 0 on success, -1 on failure.
+ * @param N cannot be negative; if it is 0 or greater than the number of matching files, every matching file will be read.
+ * @param prefix if NULL or empty, it behaves like "readNFiles". Its length must be less than 108 and it cannot contain spaces.
+ * @param dirname if NULL, read files will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one. The function may also fail and set "errno" for
+ * any of the errors specified for the routines "writen", "readn", "malloc", "savefile", "Storage_readNFiles".
+ * @note The same notes as "readNFiles" apply. Only files matching prefix are visited by the server and they are sent
+ * sorted in lexicographical order.
+*/
+int
+readNFilesPrefix(int N, const char* prefix, const char* dirname);
+
+/**
+ * @brief Requests server to list the names of the files whose name starts with given prefix.
+ * @returns 0 on success, -1 on failure.
+ * @param prefix if NULL or empty, every file is listed. Its length must be less than 108 and it cannot contain spaces.
+ * @param list cannot be NULL. On success it is set to a nul terminated buffer of newline separated names, sorted in
+ * lexicographical order, or to NULL if no file matches; it must be freed by the callee.
+ * @param size cannot be NULL. On success it is set to the length of list.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one. The function may also fail and set "errno" for
+ * any of the errors specified for the routines "writen", "readn", "malloc", "Storage_listFiles".
+ * @note A fatal error may be triggered inside the storage when processing this request, therefore the callee may exit with
+ * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+ * Listed files are neither required to be opened by the callee nor to be unlocked.
+*/
+int
+listFiles(const char* prefix, char** list, size_t* size);
+
+/**
+ * @brief Uploads given file to server. Its contents are read and sent in fixed-size chunks, hence the file
+ * is never held in memory as a whole. Files spanning more than a chunk are sent only once the server has reserved
+ * space for them, evicting files if needed: if it cannot, the upload fails before any contents are sent.
  * @returns 0 on success, -1 on failure.
  * @param pathname cannot be NULL, its length must be less than 108.
  * @param dirname if NULL, files evicted because of this operation will not be stored.
  * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
- * "EBADMSG" if any response read from the socket is not a valid one. The function may also fail and set "errno" for
- * any of the errors specified for the routines "writen", "readn", "malloc", "savefile", "is_regular_file", "fopen",
- * "fseek", "fread", "Storage_writeFile".
+ * "EBADMSG" if any response read from the socket is not a valid one, to "EBADE" if the file has got shorter while being
+ * sent. The function may also fail and set "errno" for any of the errors specified for the routines "writen", "readn",
+ * "malloc", "savefile", "is_regular_file", "fopen", "fseek", "ftell", "fread", "Storage_writeFile".
  * @note A fatal error may be triggered inside the storage when processing this request, therefore the callee may exit with
  * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
  * In order for a file to be uploaded, it is required from the callee to have called "openFile" with flags "O_CREATE", "O_LOCK"
@@ -172,4 +257,197 @@ closeFile(const char* pathname);
 int
 removeFile(const char* pathname);
 
+/**
+ * @brief Requests server to open every given file with given flags, sending a single batch of requests.
+ * @returns 0 if every file has been opened, -1 otherwise.
+ * @param pathnames cannot be NULL, neither can any of its n elements. Their length must be less than 108.
+ * @param n cannot be 0.
+ * @param dirname if NULL, files evicted because of this operation will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first file which could not
+ * be opened if any. The function may also fail and set "errno" for any of the errors specified for the routines "writen",
+ * "readn", "malloc", "savefile".
+ * @note The outcome on every file is printed just as "openFile" prints it. A fatal error may be triggered inside the storage
+ * when processing any request, therefore the callee may exit with an exit status equal to the "errno" value set in the
+ * storage if "exit_on_fatal_errors" has been toggled on.
+*/
+int
+openFiles(const char** pathnames, size_t n, int flags, const char* dirname);
+
+/**
+ * @brief Reads every given file from server, sending a single batch of requests.
+ * @returns 0 if every file has been read, -1 otherwise.
+ * @param pathnames cannot be NULL, neither can any of its n elements. Their length must be less than 108.
+ * @param n cannot be 0.
+ * @param bufs if NULL, contents are not sent back. Otherwise it must hold n elements: each is set to a null terminated
+ * buffer to be freed by callee, or to NULL if the matching file could not be read.
+ * @param sizes if NULL, contents are not sent back. Otherwise it must hold n elements: each is set to the size of
+ * the matching file.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first file which could not
+ * be read if any. The function may also fail and set "errno" for any of the errors specified for the routines "writen",
+ * "readn", "malloc", "calloc".
+ * @note The outcome on every file is printed just as "readFile" prints it. A fatal error may be triggered inside the storage
+ * when processing any request, therefore the callee may exit with an exit status equal to the "errno" value set in the
+ * storage if "exit_on_fatal_errors" has been toggled on.
+*/
+int
+readFiles(const char** pathnames, size_t n, void** bufs, size_t* sizes);
+
+/**
+ * @brief Uploads every given file to server, sending a single batch of requests. Contents are streamed just as
+ * "writeFile" does.
+ * @returns 0 if every file has been uploaded, -1 otherwise.
+ * @param pathnames cannot be NULL, neither can any of its n elements. Their length must be less than 108.
+ * @param n cannot be 0.
+ * @param dirname if NULL, files evicted because of this operation will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first file which could not
+ * be uploaded if any. The function may also fail and set "errno" for any of the errors specified for the routines "writen",
+ * "readn", "malloc", "savefile", "is_regular_file", "fopen", "fseek", "ftell", "fread".
+ * @note The outcome on every file is printed just as "writeFile" prints it; files which cannot be opened are not sent.
+ * A fatal error may be triggered inside the storage when processing any request, therefore the callee may exit with
+ * an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+ * The same requirements as "writeFile" apply to every file.
+*/
+int
+writeFiles(const char** pathnames, size_t n, const char* dirname);
+
+/**
+ * @brief Requests server to lock every given file, sending a single batch of requests.
+ * @returns 0 if every file has been locked, -1 otherwise.
+ * @param pathnames cannot be NULL, neither can any of its n elements. Their length must be less than 108.
+ * @param n cannot be 0.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first file which could not
+ * be locked if any. The function may also fail and set "errno" for any of the errors specified for the routines "writen",
+ * "readn", "malloc".
+ * @note The outcome on every file is printed just as "lockFile" prints it, but files whose lock is held by another client
+ * are not waited for. A fatal error may be triggered inside the storage when processing any request, therefore the callee
+ * may exit with an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+*/
+int
+lockFiles(const char** pathnames, size_t n);
+
+/**
+ * @brief Requests server to unlock every given file, sending a single batch of requests.
+ * @returns 0 if every file has been unlocked, -1 otherwise.
+ * @param pathnames cannot be NULL, neither can any of its n elements. Their length must be less than 108.
+ * @param n cannot be 0.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first file which could not
+ * be unlocked if any. The function may also fail and set "errno" for any of the errors specified for the routines "writen",
+ * "readn", "malloc".
+ * @note The outcome on every file is printed just as "unlockFile" prints it. A fatal error may be triggered inside the storage
+ * when processing any request, therefore the callee may exit with an exit status equal to the "errno" value set in the
+ * storage if "exit_on_fatal_errors" has been toggled on.
+*/
+int
+unlockFiles(const char** pathnames, size_t n);
+
+/**
+ * @brief Requests server to close every given file, sending a single batch of requests.
+ * @returns 0 if every file has been closed, -1 otherwise.
+ * @param pathnames cannot be NULL, neither can any of its n elements. Their length must be less than 108.
+ * @param n cannot be 0.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket, to
+ * "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first file which could not
+ * be closed if any. The function may also fail and set "errno" for any of the errors specified for the routines "writen",
+ * "readn", "malloc".
+ * @note The outcome on every file is printed just as "closeFile" prints it. A fatal error may be triggered inside the storage
+ * when processing any request, therefore the callee may exit with an exit status equal to the "errno" value set in the
+ * storage if "exit_on_fatal_errors" has been toggled on.
+*/
+int
+closeFiles(const char** pathnames, size_t n);
+
+/**
+ * @brief Sends a request to open given file without waiting for its reply.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @param dirname if NULL, files evicted because of this operation will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "send", "poll", "strdup".
+ * @note The outcome of the request is only known once "pipelineDrain" is called; it is printed as soon as its reply
+ * is received. Pipelined requests are handled by the server in the same order they are sent.
+*/
+int
+pipelineOpenFile(const char* pathname, int flags, const char* dirname);
+
+/**
+ * @brief Uploads given file to server without waiting for the reply. Just like "writeFile", contents are
+ * streamed one chunk at a time.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @param dirname if NULL, files evicted because of this operation will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket,
+ * to "EBADE" if the file has got shorter while being sent: its request is pipelined nonetheless.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "send", "poll", "strdup",
+ * "is_regular_file", "fopen", "fseek", "ftell", "fread".
+ * @note The outcome of the request is only known once "pipelineDrain" is called. The same requirements as "writeFile"
+ * apply, hence it may follow a pipelined open of the same file. Files spanning more than a chunk need space to be
+ * reserved just as "writeFile" does: replies to pipelined requests are received first and, if the reservation
+ * is denied, the request is not sent at all.
+*/
+int
+pipelineWriteFile(const char* pathname, const char* dirname);
+
+/**
+ * @brief Requests server to append up to given size bytes to given file without waiting for the reply.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @param dirname if NULL, files evicted because of this operation will not be stored.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "send", "poll", "strdup".
+ * @note The outcome of the request is only known once "pipelineDrain" is called.
+*/
+int
+pipelineAppendToFile(const char* pathname, void* buf, size_t size, const char* dirname);
+
+/**
+ * @brief Requests server to unlock given file without waiting for the reply.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "send", "poll".
+ * @note The outcome of the request is only known once "pipelineDrain" is called.
+*/
+int
+pipelineUnlockFile(const char* pathname);
+
+/**
+ * @brief Requests server to close given file without waiting for the reply.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "send", "poll".
+ * @note The outcome of the request is only known once "pipelineDrain" is called.
+*/
+int
+pipelineCloseFile(const char* pathname);
+
+/**
+ * @brief Requests server to delete given file without waiting for the reply.
+ * @returns 0 on success, -1 on failure.
+ * @param pathname cannot be NULL, its length must be less than 108.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid, to "ENOTCONN" if callee is not connected to a socket.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "send", "poll".
+ * @note The outcome of the request is only known once "pipelineDrain" is called.
+*/
+int
+pipelineRemoveFile(const char* pathname);
+
+/**
+ * @brief Waits for the replies to every pipelined request sent so far.
+ * @returns 0 if every pipelined request sent since last call has succeeded, -1 otherwise.
+ * @exception It sets "errno" to "ENOTCONN" if callee is not connected to a socket, to the "errno" value of the first
+ * failed request if any has failed. The function may also fail and set "errno" for any of the errors specified for the
+ * routines "readn", "malloc", "savefile".
+ * @note A fatal error may have been triggered inside the storage when processing any request, therefore the callee may exit
+ * with an exit status equal to the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+ * Any non pipelined request waits for the replies to the pipelined ones first.
+*/
+int
+pipelineDrain(void);
+
 #endif
\ No newline at end of file
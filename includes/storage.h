@@ -14,6 +14,9 @@
 // Struct fields are not exposed to force callee to access it using the implemented methods.
 typedef struct _storage storage_t;
 
+// Used to read files from storage one at a time.
+typedef struct _storage_cursor storage_cursor_t;
+
 /**
  * @brief Initializes empty storage data structure.
  * @returns Initialized data structure on success,
@@ -27,22 +30,24 @@ storage_t*
 Storage_Init(size_t max_files_no, size_t max_storage_size, replacement_policy_t chosen_algo);
 
 /**
- * @brief Handles file opening.
+ * @brief Handles file opening. May evict files from storage when a file is to be created and storage is already full.
  * @returns 0 on success, 1 on failure, 2 on fatal errors.
  * @param storage cannot be NULL.
  * @param pathname cannot be NULL.
+ * @param evicted if NULL, files evicted to make room for a new file are not saved; otherwise it is set to the list of
+ * evicted files (or to NULL if none was). It must be freed by calling "LinkedList_Free".
  * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_ReadLock",
  * "RWLock_ReadUnlock", "RWLock_WriteLock", "RWLock_WriteUnlock", "LinkedList_PushFront", "LinkedList_Contains",
- * "StoredFile_Init", "HashTable_Find", "HashTable_Insert", "HashTable_GetPointerToData" which are all considered fatal errors.
+ * "StoredFile_Init", "HashTable_Find", "HashTable_Insert", "HashTable_GetPointerToData", "Storage_getVictim",
+ * "HashTable_DeleteNode", "LinkedList_Init" which are all considered fatal errors.
  * Non-fatal failures may happen because:
  *  	- any param is not valid (sets "errno" to "EINVAL");
- *  	- storage is already full (sets "errno" to "ENOSPC");
  *  	- file has already been opened by this client (sets "errno" to "EBADF");
  *  	- another client owns this file's lock and this client is trying to acquire it (sets "errno" to "EACCES");
  *  	- client is trying to create an already existing file (sets "errno" to "EEXIST").
 */
 int
-Storage_openFile(storage_t* storage, const char* pathname, int flags, int client);
+Storage_openFile(storage_t* storage, const char* pathname, int flags, linked_list_t** evicted, int client);
 
 /**
  * @brief Handles file reading.
@@ -64,28 +69,127 @@ int
 Storage_readFile(storage_t* storage, const char* pathname, void** buf, size_t* size, int client);
 
 /**
- * @brief Handles reading up to n files from storage.
+ * @brief Handles reading a slice of given file made up of up to len bytes starting from given offset.
+ * @returns 0 on success, 1 on failure, 2 on fatal errors.
+ * @param storage cannot be NULL.
+ * @param pathname cannot be NULL.
+ * @param offset if it is not less than file size, an empty slice is read.
+ * @param len if 0, file is read from offset to its end.
+ * @param buf cannot be NULL.
+ * @param size cannot be NULL.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_ReadLock",
+ * "RWLock_ReadUnlock", "RWLock_WriteLock", "RWLock_WriteUnlock", "LinkedList_Contains", "HashTable_Find",
+ * "HashTable_GetPointerToData", "malloc" which are all considered fatal errors.
+ * Non-fatal failures may happen because:
+ *  	- any param is not valid (sets "errno" to "EINVAL");
+ *  	- another client owns this file's lock (sets "errno" to "EPERM");
+ *  	- client has yet to open this file (sets "errno" to "EACCES");
+ *  	- file is not inside the storage (sets "errno" to "EBADF").
+*/
+int
+Storage_readFileRange(storage_t* storage, const char* pathname, size_t offset, size_t len, void** buf, size_t* size,
+			int client);
+
+/**
+ * @brief Handles retrieving given file's metadata without accessing its contents.
+ * @returns 0 on success, 1 on failure, 2 on fatal errors.
+ * @param storage cannot be NULL.
+ * @param pathname cannot be NULL.
+ * @param stat cannot be NULL.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_ReadLock",
+ * "RWLock_ReadUnlock", "HashTable_Find", "HashTable_GetPointerToData" which are all considered fatal errors.
+ * Non-fatal failures may happen because:
+ *  	- any param is not valid (sets "errno" to "EINVAL");
+ *  	- file is not inside the storage (sets "errno" to "EBADF").
+ * @note Only read locks are acquired and the file is not required to have been opened by any client.
+*/
+int
+Storage_statFile(storage_t* storage, const char* pathname, file_stat_t* stat);
+
+/**
+ * @brief Handles listing the names of files whose name starts with given prefix, sorted in lexicographical order.
+ * @returns 0 on success, 1 on failure, 2 on fatal errors.
+ * @param storage cannot be NULL.
+ * @param prefix if NULL or empty, every file name is listed.
+ * @param names cannot be NULL. It must be freed by calling "LinkedList_Free".
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_ReadLock",
+ * "RWLock_ReadUnlock", "RadixTree_CopyKeysWithPrefix" which are all considered fatal errors.
+ * Non-fatal failures may happen because:
+ *  	- any param is not valid (sets "errno" to "EINVAL").
+ * @note Only the names matching prefix are visited, locks over files are neither required nor checked.
+*/
+int
+Storage_listFiles(storage_t* storage, const char* prefix, linked_list_t** names);
+
+/**
+ * @brief Handles reading up to n files from storage by opening a cursor over it; file contents are not read
+ * until "Storage_cursorNext" is called.
  * @returns 0 on success, 1 on failure, 2 on fatal errors.
  * @param storage cannot be NULL.
- * @param read_files cannot be NULL.
+ * @param cursor cannot be NULL. It must be freed by calling "Storage_cursorFree".
  * @param n if 0, every readable file is read.
+ * @param prefix if neither NULL nor empty, only files whose name starts with it are read.
  * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_ReadLock",
- * "RWLock_ReadUnlock", "LinkedList_CopyAllKeys", "LinkedList_Init", "LinkedList_PopFront", "HashTable_GetPointerToData",
- * "LinkedList_PushBack", "RWLock_WriteLock", "RWLock_WriteUnlock" which are all considered fatal errors.
+ * "RWLock_ReadUnlock", "LinkedList_CopyAllKeys", "LinkedList_Init", "RadixTree_CopyKeysWithPrefix", "malloc" which are
+ * all considered fatal errors.
  * Non-fatal failures may happen because:
  *  	- any param is not valid (sets "errno" to "EINVAL").
  * @note In this function: a file is considered readable if and only if it exists inside the storage and either its lock owner
  * has not been set or it is equal to given client.
 */
 int
-Storage_readNFiles(storage_t* storage, linked_list_t** read_files, size_t n, int client);
+Storage_readNFiles(storage_t* storage, storage_cursor_t** cursor, size_t n, const char* prefix, int client);
+
+/**
+ * @brief Reads next readable file the cursor is pointing to. Storage lock is only held while the file is being copied.
+ * @returns 0 on success, 1 on failure, 2 on fatal errors.
+ * @param cursor cannot be NULL.
+ * @param name cannot be NULL. It is set to NULL if there are no more files to be read.
+ * @param buf cannot be NULL.
+ * @param size cannot be NULL.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_ReadLock",
+ * "RWLock_ReadUnlock", "RWLock_WriteLock", "RWLock_WriteUnlock", "LinkedList_PopFront", "HashTable_Find",
+ * "HashTable_GetPointerToData", "malloc" which are all considered fatal errors.
+ * Non-fatal failures may happen because:
+ *  	- any param is not valid (sets "errno" to "EINVAL").
+*/
+int
+Storage_cursorNext(storage_cursor_t* cursor, char** name, void** buf, size_t* size);
+
+/**
+ * Frees allocated resources.
+*/
+void
+Storage_cursorFree(storage_cursor_t* cursor);
+
+/**
+ * @brief Reserves space for the contents of a file which is about to be written. May evict files from storage.
+ * @returns 0 on success, 1 on failure, 2 on fatal errors.
+ * @param storage cannot be NULL.
+ * @param pathname cannot be NULL.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines
+ * "RWLock_WriteLock", "RWLock_WriteUnlock", "HashTable_GetPointerToData", "HashTable_Find", "HashTable_DeleteNode",
+ * "LinkedList_Init", "LinkedList_PushFront" which are all considered fatal errors.
+ * Non-fatal failures may happen because:
+ *  	- any param is not valid (sets "errno" to "EINVAL");
+ *  	- file to be written is bigger than the whole storage (sets "errno" to "EFBIG");
+ *  	- client is not a potential writer for the file or has already reserved space for it (sets "errno" to "EACCES");
+ *  	- file to be written has been evicted while attempting to free storage space (sets "errno" to "EIDRM");
+ *  	- file is not inside the storage (sets "errno" to "EBADF").
+ * @note Reserved space is counted in storage size until the file gets written by "Storage_writeFile", removed
+ * or evicted, or until the client leaves.
+*/
+int
+Storage_reserveFile(storage_t* storage, const char* pathname, size_t length, linked_list_t** evicted, int client);
 
 /**
  * @brief Handles file writing. May evict files from storage.
  * @returns 0 on success, 1 on failure, 2 on fatal errors.
  * @param storage cannot be NULL.
  * @param pathname cannot be NULL.
- * @exception The function may fail and set "errno" for any of the errors specified for the routines "malloc",
+ * @param contents if not NULL, it must be an allocated buffer at least length + 1 bytes long: it becomes the file's
+ * contents as it is, hence it is not to be used by callee anymore whatever the outcome.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines
  * "RWLock_WriteLock", "RWLock_WriteUnlock", "HashTable_GetPointerToData", "HashTable_Find", "HashTable_DeleteNode",
  * "LinkedList_Init", "LinkedList_PushFront" which are all considered fatal errors.
  * Non-fatal failures may happen because:
@@ -96,7 +200,7 @@ Storage_readNFiles(storage_t* storage, linked_list_t** read_files, size_t n, int
  *  	- file is not inside the storage (sets "errno" to "EBADF").
 */
 int
-Storage_writeFile(storage_t* storage, const char* pathname, size_t length, const char* contents, linked_list_t** evicted, int client);
+Storage_writeFile(storage_t* storage, const char* pathname, size_t length, char* contents, linked_list_t** evicted, int client);
 
 /**
  * @brief Handles append to file. May evict files from storage.
@@ -177,6 +281,20 @@ Storage_closeFile(storage_t* storage, const char* pathname, int client);
 int
 Storage_removeFile(storage_t* storage, const char* pathname, int client);
 
+/**
+ * @brief Drops every open, every lock and every space reservation held by given client.
+ * @returns 0 on success, 1 on failure, 2 on fatal errors.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "RWLock_WriteLock",
+ * "RWLock_WriteUnlock", "HashTable_GetPointerToData", "HashTable_DeleteNode", "LinkedList_PopFront",
+ * "LinkedList_Remove" which are all considered fatal errors.
+ * Non-fatal failures may happen because:
+ *  	- any param is not valid (sets "errno" to "EINVAL").
+ * @note It is to be called whenever a client leaves, as its descriptor may be handed to a new client.
+ * Only the files client has opened, locked or reserved space in are visited.
+*/
+int
+Storage_clientLeft(storage_t* storage, int client);
+
 /**
  * @brief Gets maximum amount of files stored.
  * @param storage cannot be NULL.
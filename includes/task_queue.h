@@ -0,0 +1,85 @@
+/**
+ * @brief Header file for a bounded lock-free queue of integers and related operations.
+ * @author Giacomo Trapani.
+*/
+
+#ifndef _TASK_QUEUE_H_
+#define _TASK_QUEUE_H_
+
+#include <stdlib.h>
+
+// Struct fields are not exposed to force callee to access it using the implemented methods.
+typedef struct _task_queue task_queue_t;
+
+/**
+ * @brief Initializes empty queue given its capacity.
+ * @returns Initialized data structure on success, NULL on failure.
+ * @param capacity cannot be 0.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "posix_memalign", "malloc".
+ * @note Capacity is rounded up to the next power of two.
+*/
+task_queue_t*
+TaskQueue_Init(size_t capacity);
+
+/**
+ * @brief Enqueues value to queue, waiting for a free slot if it is full.
+ * @returns 0 on success, -1 on failure.
+ * @param queue cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "futex".
+ * @note Any number of threads may enqueue and dequeue at once: callee is put to sleep only when the queue is full.
+*/
+int
+TaskQueue_Enqueue(task_queue_t* queue, int value);
+
+/**
+ * @brief Enqueues value to queue, if there is a free slot.
+ * @returns 1 if value has been enqueued, 0 if queue is full, -1 on failure.
+ * @param queue cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "futex".
+*/
+int
+TaskQueue_TryEnqueue(task_queue_t* queue, int value);
+
+/**
+ * @brief Dequeues oldest value from queue, waiting for one to be enqueued if it is empty.
+ * @returns 0 on success, -1 on failure.
+ * @param queue cannot be NULL.
+ * @param valueptr cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "futex".
+ * @note Any number of threads may enqueue and dequeue at once: callee is put to sleep only when the queue is empty.
+*/
+int
+TaskQueue_Dequeue(task_queue_t* queue, int* valueptr);
+
+/**
+ * @brief Dequeues oldest value from queue, if there is any.
+ * @returns 1 if a value has been dequeued, 0 if queue is empty, -1 on failure.
+ * @param queue cannot be NULL.
+ * @param valueptr cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routine "futex".
+*/
+int
+TaskQueue_TryDequeue(task_queue_t* queue, int* valueptr);
+
+/**
+ * @brief Gets number of values currently in queue.
+ * @returns Number of values in queue on success, 0 on failure.
+ * @param queue cannot be NULL.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid.
+ * @note Result is a snapshot: it may be stale as soon as it is returned.
+*/
+size_t
+TaskQueue_GetNumberOfElements(const task_queue_t* queue);
+
+/**
+ * Frees allocated resources.
+*/
+void
+TaskQueue_Free(task_queue_t* queue);
+
+#endif
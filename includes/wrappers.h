@@ -94,4 +94,9 @@
 */
 #define MAX(a, b) ((a >= b) ? (a) : (b))
 
+/**
+ * @brief Gets minimum value between given params.
+*/
+#define MIN(a, b) ((a <= b) ? (a) : (b))
+
 #endif
\ No newline at end of file
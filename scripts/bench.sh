@@ -0,0 +1,70 @@
+#!/bin/bash
+# usage: scripts/bench.sh <scenario>
+# Boots a server for each run and measures it with build/server_bench.
+# WORKERS, LIGHT and ITERATIONS override the defaults below; CONFIG holds config lines added to every run.
+# PRELOAD names a library preloaded into the server.
+# fairness : latency of LOCK/UNLOCK clients alone, then next to a client reading 64 MB batches flat out.
+# slow     : latency of LOCK/UNLOCK clients alone, then next to clients trickling requests, trickling payloads
+#            and reading replies slowly.
+# backends : throughput and system calls per request of LOCK/UNLOCK clients with epoll, then with io_uring.
+# numa     : throughput of clients reading 64 MB batches next to LOCK/UNLOCK clients, with a reactor per NUMA node,
+#            unpinned and then with reactors and workers pinned to CPUs.
+
+GREEN="\033[0;32m"
+RESET_COLOR="\033[0m"
+
+WORKERS=${WORKERS:-1}
+LIGHT=${LIGHT:-4}
+ITERATIONS=${ITERATIONS:-2000}
+
+# run <label> <extra config lines> <server_bench arguments>
+run() {
+	echo -e "${GREEN}$1${RESET_COLOR}"
+	echo -e "NUMBER OF THREAD WORKERS = ${WORKERS}\nMAXIMUM NUMBER OF STORABLE FILES = 1000\nMAXIMUM STORAGE SIZE = 400000000\nSOCKET FILE PATH = $(pwd)/bench.sk\nLOG FILE PATH = $(pwd)/logs/bench.log\nREPLACEMENT POLICY = 0" > bench.txt
+	[ -n "$2" ] && echo -e "$2" >> bench.txt
+	[ -n "${CONFIG}" ] && echo -e "${CONFIG}" >> bench.txt
+	rm -f bench.sk
+	LD_PRELOAD=${PRELOAD} SYSCALL_COUNT_FILE=$(pwd)/logs/syscalls.log build/server ./bench.txt > /dev/null &
+	SERVER_PID=$!
+	sleep 1s
+	shift 2
+	OUTPUT=$(build/server_bench -f bench.sk -c ${LIGHT} -n ${ITERATIONS} "$@")
+	echo "${OUTPUT}"
+	kill -s SIGINT $SERVER_PID
+	wait $SERVER_PID
+}
+
+case "$1" in
+	fairness)
+		run "[FAIRNESS] Light clients only" ""
+		run "[FAIRNESS] Light clients next to a heavy one" "" -H 1 -s 1000000
+		;;
+	slow)
+		run "[SLOW] Light clients only" ""
+		run "[SLOW] Light clients next to slow ones" "" -S 2
+		;;
+	backends)
+		for BACKEND in 0 1; do
+			PRELOAD=$(pwd)/build/syscall_count.so run "[BACKENDS] I/O BACKEND = ${BACKEND}" "I/O BACKEND = ${BACKEND}"
+			# "light: <clients> clients, <requests> requests ..."
+			REQUESTS=$(echo "${OUTPUT}" | awk '/^light/ { print $4 }')
+			# "total <count> <call> <count> ..."
+			awk -v requests=${REQUESTS} '{
+				printf "syscalls per request: %.2f (", $2 / requests
+				for (i = 3; i < NF; i += 2) printf "%s%s %.2f", (i > 3 ? ", " : ""), $i, $(i + 1) / requests
+				print ")"
+			}' logs/syscalls.log
+		done
+		;;
+	numa)
+		# the first CPU of every node with CPUs hosts one of its reactors
+		REACTORS_CPUS=$(for NODE in /sys/devices/system/node/node*; do cut -d, -f1 ${NODE}/cpulist | cut -d- -f1; done | grep . | paste -sd,)
+		NODES=$(echo ${REACTORS_CPUS} | tr , '\n' | wc -l)
+		run "[NUMA] ${NODES} reactors, unpinned" "NUMBER OF REACTORS = ${NODES}" -H 4 -s 1000000
+		run "[NUMA] ${NODES} reactors, pinned" "NUMBER OF REACTORS = ${NODES}\nREACTORS CPUS = ${REACTORS_CPUS}\nWORKERS CPUS = $(cat /sys/devices/system/cpu/online)" -H 4 -s 1000000
+		;;
+	*)
+		echo "usage: $0 fairness|slow|backends|numa"
+		exit 1
+		;;
+esac
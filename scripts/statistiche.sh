@@ -14,22 +14,28 @@ LOG_FILE=$1
 # starting
 
 echo -e "DATA ${GREEN}READ${RESET_COLOR} BY CLIENTS"
-# count lines containing readFile
-n_READFILE=$(grep "readFile" -c $LOG_FILE)
+# count lines containing readFile: space is needed, otherwise it would also match with readFileRange
+n_READFILE=$(grep "readFile " -c $LOG_FILE)
+# count lines containing readFileRange
+n_READFILERANGE=$(grep "readFileRange" -c $LOG_FILE)
 # count lines containing readNFiles
 n_READNFILES=$(grep "readNFiles" -c $LOG_FILE)
 # take the sum
 # get strings containing readFile, get part after "->", remove trailing dots, sum the values
-READFILE_BYTES=$(grep -E "readFile.*->" $LOG_FILE | grep -oE '[^ ]+$' | sed -e 's/\.//g' | { sum=0; while read num; do ((sum+=num)); done; echo $sum; })
+READFILE_BYTES=$(grep -E "readFile .*->" $LOG_FILE | grep -oE '[^ ]+$' | sed -e 's/\.//g' | { sum=0; while read num; do ((sum+=num)); done; echo $sum; })
+# the logic is the same for readFileRange and readNFiles
+READFILERANGE_BYTES=$(grep -E "readFileRange.*->" $LOG_FILE | grep -oE '[^ ]+$' | sed -e 's/\.//g' | { sum=0; while read num; do ((sum+=num)); done; echo $sum; })
 # get strings containing readNFiles, get part after "->", remove trailing dots, sum the values
 READNFILES_BYTES=$(grep -E "readNFiles.*->" $LOG_FILE | grep -oE '[^ ]+$' | sed -e 's/\.//g' | { sum=0; while read num; do ((sum+=num)); done; echo $sum; })
-READ_BYTES=$((READFILE_BYTES+READNFILES_BYTES))
-n_READS=$((n_READFILE+n_READNFILES))
+READ_BYTES=$((READFILE_BYTES+READFILERANGE_BYTES+READNFILES_BYTES))
+n_READS=$((n_READFILE+n_READFILERANGE+n_READNFILES))
 echo -e "\tNumber of reading operations: ${n_READS}."
 echo -e "\t\treadFile : ${n_READFILE}."
+echo -e "\t\treadFileRange : ${n_READFILERANGE}."
 echo -e "\t\treadNFiles : ${n_READNFILES}."
 echo -e "\tRead size : ${READ_BYTES} [BYTES]."
 echo -e "\t\treadFile : ${READFILE_BYTES} [BYTES]."
+echo -e "\t\treadFileRange : ${READFILERANGE_BYTES} [BYTES]."
 echo -e "\t\treadNFiles : ${READNFILES_BYTES} [BYTES]."
 
 # calculate means
@@ -42,6 +48,10 @@ if [ ${n_READFILE} -gt 0 ]; then
 	MEAN_READFILES=$(echo "scale=3; ${READFILE_BYTES} / ${n_READFILE}" | bc -l)
 	echo -e "\t\treadFile : ${MEAN_READFILES} [BYTES]."
 fi
+if [ ${n_READFILERANGE} -gt 0 ]; then
+	MEAN_READFILERANGE=$(echo "scale=3; ${READFILERANGE_BYTES} / ${n_READFILERANGE}" | bc -l)
+	echo -e "\t\treadFileRange : ${MEAN_READFILERANGE} [BYTES]."
+fi
 if [ ${n_READNFILES} -gt 0 ]; then
 	MEAN_READNFILES=$(echo "scale=3; ${READNFILES_BYTES} / ${n_READNFILES}" | bc -l)
 	echo -e "\t\treadNFiles : ${MEAN_READNFILES} [BYTES]."
@@ -107,4 +117,16 @@ MAXFILES=$(grep "Maximum file" $LOG_FILE | grep -oE '[^ ]+$' | sed -e 's/\.//g')
 echo -e "\tMaximum online clients : ${MAXCLIENTS}."
 echo -e "\tReplacement algorithm got triggered : ${EVICTIONS} time(s)."
 echo -e "\tMaximum reached size : ${MAXSIZE_MBYTES} [MB]."
-echo -e "\tMaximum files stored : ${MAXFILES}."
\ No newline at end of file
+echo -e "\tMaximum files stored : ${MAXFILES}."
+
+echo -e "${GREEN}REPLIES${RESET_COLOR} SENT"
+# get lines summing up each worker's replies, take the number of replies, sum the values
+REPLIES=$(grep "Worker replies : " $LOG_FILE | grep -oE 'replies : [0-9]+' | grep -oE '[0-9]+$' | { sum=0; while read num; do ((sum+=num)); done; echo $sum; })
+# the logic is the same for the number of writes
+WRITES=$(grep "Worker replies : " $LOG_FILE | grep -oE 'writes : [0-9]+' | grep -oE '[0-9]+$' | { sum=0; while read num; do ((sum+=num)); done; echo $sum; })
+echo -e "\tReplies : ${REPLIES}."
+echo -e "\tWrites : ${WRITES}."
+if [ ${REPLIES} -gt 0 ]; then
+	MEAN_WRITES=$(echo "scale=3; ${WRITES} / ${REPLIES}" | bc -l)
+	echo -e "\tMean writes per reply : ${MEAN_WRITES}."
+fi
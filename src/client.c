@@ -77,6 +77,17 @@ cwd();
 static int
 list_files(const char dirname[], linked_list_t* list);
 
+/**
+ * @brief Splits given comma separated list of files, thus initializing given array to its elements.
+ * @returns Number of files on success, 0 on failure.
+ * @param list cannot be NULL. It is modified as by "strtok_r" and it must outlive the array.
+ * @param files cannot be NULL. Array is to be freed by callee.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid or the list is empty. The function may also fail
+ * and set "errno" for any of the errors specified for routine "malloc".
+*/
+static size_t
+split_files(char* list, const char*** files);
+
 /**
  * @brief Validates commands and arguments. It also sets h_set and sockname.
  * @param commands cannot be NULL.
@@ -108,6 +119,10 @@ bool h_set = false; // toggled on when -h flag is passed
 char sockname[MAXPATH]; // name of the socket to connect to
 char* filename = NULL; // used to denote a filename
 char* read_contents = NULL; // used to store read content
+const char** listed_files = NULL; // files a comma separated list is made of
+size_t files_no = 0; // number of files a comma separated list is made of
+char** read_files_contents = NULL; // used to store contents of files read as a batch
+size_t* read_files_sizes = NULL; // used to store sizes of files read as a batch
 
 
 
@@ -135,6 +150,7 @@ main(int argc, char* argv[])
 	size_t read_size = 0; // used to store read content size
 	char* cwd_copy = NULL; // copy of current working directory
 	int upto = 0; // used to denote N value in readNFiles operation
+	char* evicted_dirname = NULL; // used to denote the folder evicted files are to be stored in
 	char filepath[PATH_MAX]; // used to denote path to a file
 	int err; // used to handle functions' output values
 	int i = 0; // index used in loops 
@@ -242,6 +258,7 @@ main(int argc, char* argv[])
 				// write directory
 				// get dirname from arguments
 				tmp = arguments[i];
+				evicted_dirname = (i + 2 < argc - 1 && commands[i+2][0] == 'D') ? arguments[i+2] : NULL;
 				R_files = LinkedList_Init(NULL);
 				if (!R_files)
 				{
@@ -282,20 +299,21 @@ main(int argc, char* argv[])
 						}
 						SET_FLAG(open_flags, O_CREATE);
 						SET_FLAG(open_flags, O_LOCK);
-						openFile(filename, open_flags);
+						pipelineOpenFile(filename, open_flags, evicted_dirname);
 						RESET_MASK(open_flags);
 						if (i + 2 < argc -1)
 						{
 							if (commands[i+2][0] == 'D')
-								writeFile(filename, arguments[i+2]);
+								pipelineWriteFile(filename, arguments[i+2]);
 						}
 						else
-							writeFile(filename, NULL);
-						unlockFile(filename);
-						closeFile(filename);
+							pipelineWriteFile(filename, NULL);
+						pipelineUnlockFile(filename);
+						pipelineCloseFile(filename);
 						usleep(1000 * msec_sleeping);
 						free(filename); filename = NULL;
 					}
+					pipelineDrain();
 					LinkedList_Free(R_files); R_files = NULL;
 					break;
 
@@ -336,21 +354,22 @@ main(int argc, char* argv[])
 						}
 						SET_FLAG(open_flags, O_CREATE);
 						SET_FLAG(open_flags, O_LOCK);
-						openFile(filename, open_flags);
+						pipelineOpenFile(filename, open_flags, evicted_dirname);
 						RESET_MASK(open_flags);
 						if (i + 2 < argc -1)
 						{
 							if (commands[i+2][0] == 'D')
-								writeFile(filename, arguments[i+2]);
+								pipelineWriteFile(filename, arguments[i+2]);
 						}
 						else
-							writeFile(filename, NULL);
-						unlockFile(filename);
-						closeFile(filename);
+							pipelineWriteFile(filename, NULL);
+						pipelineUnlockFile(filename);
+						pipelineCloseFile(filename);
 						usleep(1000 * msec_sleeping);
 						free(filename); filename = NULL;
 						upto--;
 					}
+					pipelineDrain();
 					LinkedList_Free(R_files); R_files = NULL;
 					break;
 				}
@@ -359,44 +378,42 @@ main(int argc, char* argv[])
 			case 'W':
 				// write files
 				tmp = arguments[i];
+				evicted_dirname = (i + 2 < argc - 1 && commands[i+2][0] == 'D') ? arguments[i+2] : NULL;
 				// check whether multiple files have been specified
 				if (strchr(tmp, ',') == NULL) // single file
 				{
 					SET_FLAG(open_flags, O_CREATE);
 					SET_FLAG(open_flags, O_LOCK);
-					openFile(tmp, open_flags);
+					pipelineOpenFile(tmp, open_flags, evicted_dirname);
 					RESET_MASK(open_flags);
-					if (i + 2 < argc -1)
-					{
-						if (commands[i+2][0] == 'D')
-							writeFile(tmp, arguments[i+2]);
-					}
-					else
-						writeFile(tmp, NULL);
-					unlockFile(tmp);
-					closeFile(tmp);
+					pipelineWriteFile(tmp, evicted_dirname);
+					pipelineUnlockFile(tmp);
+					pipelineCloseFile(tmp);
+					pipelineDrain();
 					usleep(1000 * msec_sleeping);
 					break;
 				}
 				else // multiple files
 				{
-					token = strtok_r(tmp, ",", &saveptr);
-					while (1)
+					// each operation is run on every file at once
+					files_no = split_files(tmp, &listed_files);
+					if (files_no == 0)
 					{
-						if (!token) break;
-						SET_FLAG(open_flags, O_CREATE);
-						SET_FLAG(open_flags, O_LOCK);
-						openFile(token, open_flags);
-						RESET_MASK(open_flags);
-						if (i + 2 < argc - 1 && commands[i+2][0] == 'D')
-							writeFile(token, arguments[i+2]);
-						else
-							writeFile(token, NULL);
-						unlockFile(token);
-						closeFile(token);
-						usleep(msec_sleeping * 1000);
-						token = strtok_r(NULL, ",", &saveptr);
+						perror("split_files");
+						goto cleanup;
 					}
+					SET_FLAG(open_flags, O_CREATE);
+					SET_FLAG(open_flags, O_LOCK);
+					openFiles(listed_files, files_no, open_flags, evicted_dirname);
+					RESET_MASK(open_flags);
+					if (i + 2 < argc - 1 && commands[i+2][0] == 'D')
+						writeFiles(listed_files, files_no, arguments[i+2]);
+					else
+						writeFiles(listed_files, files_no, NULL);
+					unlockFiles(listed_files, files_no);
+					closeFiles(listed_files, files_no);
+					usleep(msec_sleeping * 1000);
+					free(listed_files); listed_files = NULL;
 				}
 				break;
 
@@ -432,36 +449,49 @@ main(int argc, char* argv[])
 				}
 				else // multiple files
 				{
-					token = strtok_r(tmp, ",", &saveptr);
-					while (1)
+					// each operation is run on every file at once
+					files_no = split_files(tmp, &listed_files);
+					if (files_no == 0)
 					{
-						if (!token) break;
-						RESET_MASK(open_flags);
-						openFile(token, open_flags);
-						readFile(token, (void**) &read_contents, &read_size);
-						closeFile(token);
-						if (i + 2 < argc - 1 && commands[i+2][0] == 'd')
+						perror("split_files");
+						goto cleanup;
+					}
+					read_files_contents = (char**) calloc(files_no, sizeof(char*));
+					read_files_sizes = (size_t*) calloc(files_no, sizeof(size_t));
+					if (!read_files_contents || !read_files_sizes)
+					{
+						perror("calloc");
+						goto cleanup;
+					}
+					RESET_MASK(open_flags);
+					openFiles(listed_files, files_no, open_flags, NULL);
+					readFiles(listed_files, files_no, (void**) read_files_contents, read_files_sizes);
+					closeFiles(listed_files, files_no);
+					for (size_t k = 0; k < files_no; k++)
+					{
+						// files which could not be read are not saved
+						if (i + 2 < argc - 1 && commands[i+2][0] == 'd' && read_files_contents[k])
 						{
 							// prepend dirname to filename
 							memset(filepath, 0, PATH_MAX);
-							err = snprintf(filepath, PATH_MAX, "%s/%s", token, arguments[i+2]);
+							err = snprintf(filepath, PATH_MAX, "%s/%s", arguments[i+2], listed_files[k]);
 							if (err <= 0 || err > PATH_MAX)
 							{
 								perror("snprintf");
 								goto cleanup;
 							}
-							if (savefile(filepath, read_contents) == -1)
+							if (savefile(filepath, read_files_contents[k]) == -1)
 							{
 								perror("savefile");
 								goto cleanup;
 							}
-
 						}
-						free(read_contents); read_contents = NULL;
-						usleep(1000 * msec_sleeping);
-						token = strtok_r(NULL, ",", &saveptr);
-						
+						free(read_files_contents[k]); read_files_contents[k] = NULL;
 					}
+					free(read_files_contents); read_files_contents = NULL;
+					free(read_files_sizes); read_files_sizes = NULL;
+					free(listed_files); listed_files = NULL;
+					usleep(1000 * msec_sleeping);
 				}
 				break;
 			
@@ -498,16 +528,18 @@ main(int argc, char* argv[])
 				}
 				else // multiple files
 				{
-					token = strtok_r(tmp, ",", &saveptr);
-					while (1)
+					// each operation is run on every file at once
+					files_no = split_files(tmp, &listed_files);
+					if (files_no == 0)
 					{
-						if (!token) break;
-						openFile(token, open_flags);
-						lockFile(token);
-						closeFile(token);
-						usleep(1000 * msec_sleeping);
-						token = strtok_r(NULL, ",", &saveptr);
+						perror("split_files");
+						goto cleanup;
 					}
+					openFiles(listed_files, files_no, open_flags, NULL);
+					lockFiles(listed_files, files_no);
+					closeFiles(listed_files, files_no);
+					usleep(1000 * msec_sleeping);
+					free(listed_files); listed_files = NULL;
 				}
 				break;
 
@@ -524,16 +556,18 @@ main(int argc, char* argv[])
 				}
 				else // multiple files
 				{
-					token = strtok_r(tmp, ",", &saveptr);
-					while (1)
+					// each operation is run on every file at once
+					files_no = split_files(tmp, &listed_files);
+					if (files_no == 0)
 					{
-						if (!token) break;
-						openFile(token, open_flags);
-						unlockFile(token);
-						closeFile(token);
-						token = strtok_r(NULL, ",", &saveptr);
-						usleep(1000 * msec_sleeping);
+						perror("split_files");
+						goto cleanup;
 					}
+					openFiles(listed_files, files_no, open_flags, NULL);
+					unlockFiles(listed_files, files_no);
+					closeFiles(listed_files, files_no);
+					usleep(1000 * msec_sleeping);
+					free(listed_files); listed_files = NULL;
 				}
 				break;
 			case 'c':
@@ -579,6 +613,14 @@ main(int argc, char* argv[])
 		free(commands);
 		free(arguments);
 		LinkedList_Free(R_files);
+		free(listed_files);
+		if (read_files_contents)
+		{
+			for (size_t k = 0; k < files_no; k++)
+				free(read_files_contents[k]);
+		}
+		free(read_files_contents);
+		free(read_files_sizes);
 		cleaned_up = true;
 		return 0;
 
@@ -903,5 +945,45 @@ cleanup_func()
 	LinkedList_Free(R_files);
 	free(filename);
 	free(read_contents);
+	free(listed_files);
+	if (read_files_contents)
+	{
+		for (size_t k = 0; k < files_no; k++)
+			free(read_files_contents[k]);
+	}
+	free(read_files_contents);
+	free(read_files_sizes);
 	return;
-}
\ No newline at end of file
+}
+
+static size_t
+split_files(char* list, const char*** files)
+{
+	if (!list || !files)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	char* token;
+	char* saveptr;
+	size_t files_no = 1;
+
+	// there cannot be more files than commas plus one
+	for (char* c = list; *c != '\0'; c++)
+		if (*c == ',') files_no++;
+	*files = (const char**) malloc(sizeof(char*) * files_no);
+	if (!*files) return 0;
+	files_no = 0;
+	token = strtok_r(list, ",", &saveptr);
+	while (token)
+	{
+		(*files)[files_no++] = token;
+		token = strtok_r(NULL, ",", &saveptr);
+	}
+	if (files_no == 0)
+	{
+		free(*files); *files = NULL;
+		errno = EINVAL;
+	}
+	return files_no;
+}
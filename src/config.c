@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <sys/socket.h>
 
 #include <server_defines.h>
 
@@ -22,16 +23,53 @@
 #define SOCKETPATH "SOCKET FILE PATH = "
 #define LOGPATH "LOG FILE PATH = "
 #define CHOSENPOLICY "REPLACEMENT POLICY = "
+#define PENDINGNO "MAXIMUM PENDING CONNECTIONS = " // optional
+#define REACTORSNO "NUMBER OF REACTORS = " // optional
+#define IOBACKEND "I/O BACKEND = " // optional
+#define COPYTHRESHOLD "REPLY COPY THRESHOLD = " // optional
+#define MINWORKERSNO "MINIMUM NUMBER OF THREAD WORKERS = " // optional
+#define MAXWORKERSNO "MAXIMUM NUMBER OF THREAD WORKERS = " // optional
+#define SCALEUPWAIT "WORKERS SCALE UP WAIT = " // optional
+#define SCALEUPDEPTH "WORKERS SCALE UP DEPTH = " // optional
+#define IDLECOOLDOWN "WORKERS IDLE COOLDOWN = " // optional
+#define METADATAWORKERSNO "NUMBER OF METADATA WORKERS = " // optional
+#define METADATATHRESHOLD "METADATA PAYLOAD THRESHOLD = " // optional
+#define CLIENTQUANTUM "CLIENT QUANTUM = " // optional
+#define CLIENTINFLIGHT "CLIENT REQUESTS IN FLIGHT = " // optional
+#define REACTORSCPUS "REACTORS CPUS = " // optional
+#define WORKERSCPUS "WORKERS CPUS = " // optional
+#define LOGOVERFLOW "LOG OVERFLOW POLICY = " // optional
+#define LOGSAMPLING "LOG SAMPLING RATE = " // optional
+#define LOGFORMAT "LOG FORMAT = " // optional
+#define MAXCPUS 1024 // CPU ids must be lower than this, as for "cpu_set_t"
 
 struct _server_config
 {
 	unsigned long
 		workers_no, // number of thread workers
 		max_files_no, // maximum number of storable files
-		storage_size; // maximum storage size
+		storage_size, // maximum storage size
+		pending_no, // maximum length of the queue of pending connections
+		reactors_no, // number of threads monitoring clients
+		copy_threshold, // largest payload copied into a reply rather than sent from its own buffer
+		min_workers_no, // minimum number of thread workers, 0 if it has not been specified
+		max_workers_no, // maximum number of thread workers, 0 if it has not been specified
+		scale_up_wait, // average time tasks wait for a worker, in microseconds, more workers are spawned above
+		scale_up_depth, // number of queued tasks more workers are spawned above
+		idle_cooldown, // time a worker is to be idle for, in milliseconds, before it gets retired
+		metadata_workers_no, // number of workers serving metadata requests only
+		metadata_threshold, // largest payload a request may move to be served by metadata workers
+		client_quantum, // bytes a client may move every time it is served
+		client_in_flight, // requests of a client served before its replies are sent and it yields
+		log_sampling; // one request in log_sampling is logged
 	char socket_path[MAXPATH]; // absolute path to socket file
 	char log_path[MAXPATH]; // absolute path to log file
+	char reactors_cpus[BUFFERLEN]; // list of CPUs reactors are pinned to, empty if it has not been specified
+	char workers_cpus[BUFFERLEN]; // list of CPUs workers are pinned to, empty if it has not been specified
 	replacement_policy_t policy;
+	io_backend_t backend; // used to receive requests
+	log_overflow_t log_overflow; // what threads do when their log buffer is full
+	log_format_t log_format; // format log is written in
 };
 
 server_config_t* ServerConfig_Init()
@@ -45,11 +83,64 @@ server_config_t* ServerConfig_Init()
 	config->workers_no = 0;
 	config->max_files_no = 0;
 	config->storage_size = 0;
+	config->pending_no = SOMAXCONN;
+	config->reactors_no = 1;
+	config->backend = EPOLL;
+	config->copy_threshold = 16384;
+	config->min_workers_no = 0;
+	config->max_workers_no = 0;
+	config->scale_up_wait = 1000;
+	config->scale_up_depth = 16;
+	config->idle_cooldown = 5000;
+	config->metadata_workers_no = 0;
+	config->metadata_threshold = 65536;
+	config->client_quantum = 1048576;
+	config->client_in_flight = 64;
+	config->log_overflow = LOG_BLOCK;
+	config->log_sampling = 1;
+	config->log_format = LOG_TEXT;
 	memset(config->socket_path, 0, MAXPATH);
 	memset(config->log_path, 0, MAXPATH);
+	memset(config->reactors_cpus, 0, BUFFERLEN);
+	memset(config->workers_cpus, 0, BUFFERLEN);
 	return config;
 }
 
+/**
+ * @brief Parses a list of CPU ids and ranges, such as "0-3,8", into given buffer, in the order they have been specified.
+ * @returns Number of CPUs on success, 0 if list is malformed or holds more than given capacity.
+*/
+static size_t
+parse_cpus(const char* list, int* cpus, size_t capacity)
+{
+	size_t cpus_no = 0;
+	unsigned long first, last;
+	char* end = NULL;
+
+	while (1)
+	{
+		if (*list < '0' || *list > '9') return 0;
+		first = strtoul(list, &end, 10);
+		last = first;
+		if (*end == '-')
+		{
+			list = end + 1;
+			if (*list < '0' || *list > '9') return 0;
+			last = strtoul(list, &end, 10);
+		}
+		if (last < first || last >= MAXCPUS) return 0;
+		for (; first <= last; first++)
+		{
+			if (cpus_no == capacity) return 0;
+			if (cpus) cpus[cpus_no] = (int) first;
+			cpus_no++;
+		}
+		if (*end == '\0') return cpus_no;
+		if (*end != ',') return 0;
+		list = end + 1;
+	}
+}
+
 int
 ServerConfig_Set(server_config_t* config, const char* config_file_path)
 {
@@ -63,12 +154,22 @@ ServerConfig_Set(server_config_t* config, const char* config_file_path)
 	char* dummy;
 	bool
 		flag_workers = false, flag_max = false, flag_storage = false,
-		flag_socket = false, flag_log = false, flag_policy = false;
+		flag_socket = false, flag_log = false, flag_policy = false, flag_pending = false,
+		flag_reactors = false, flag_backend = false, flag_threshold = false,
+		flag_min_workers = false, flag_max_workers = false, flag_wait = false, flag_depth = false, flag_cooldown = false,
+		flag_metadata_workers = false, flag_metadata_threshold = false, flag_quantum = false, flag_in_flight = false,
+		flag_reactors_cpus = false, flag_workers_cpus = false, flag_log_overflow = false, flag_log_sampling = false,
+		flag_log_format = false;
 	unsigned long tmp;
-	while (i < PARAMS)
+	// optional params may appear anywhere: the whole file is to be read
+	while (1)
 	{
 		dummy = fgets(buffer, BUFFERLEN, config_file);
-		if (!dummy && !feof(config_file)) return -1;
+		if (!dummy)
+		{
+			if (!feof(config_file)) { fclose(config_file); return -1; }
+			break;
+		}
 		if (strncmp(buffer, WORKERSNO, strlen(WORKERSNO)) == 0)
 		{
 			if (!flag_workers) flag_workers = true;
@@ -151,7 +252,231 @@ ServerConfig_Set(server_config_t* config, const char* config_file_path)
 			}
 			else goto invalid_config;
 		}
+		if (strncmp(buffer, PENDINGNO, strlen(PENDINGNO)) == 0)
+		{
+			if (!flag_pending) flag_pending = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(PENDINGNO), NULL, 10);
+			if (tmp != 0 && tmp <= INT_MAX)
+			{
+				config->pending_no = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, REACTORSNO, strlen(REACTORSNO)) == 0)
+		{
+			if (!flag_reactors) flag_reactors = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(REACTORSNO), NULL, 10);
+			if (tmp != 0 && tmp <= INT_MAX)
+			{
+				config->reactors_no = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, IOBACKEND, strlen(IOBACKEND)) == 0)
+		{
+			if (!flag_backend) flag_backend = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(IOBACKEND), NULL, 10);
+			if (tmp <= 1)
+			{
+				config->backend = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, COPYTHRESHOLD, strlen(COPYTHRESHOLD)) == 0)
+		{
+			if (!flag_threshold) flag_threshold = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(COPYTHRESHOLD), NULL, 10);
+			if (errno != ERANGE)
+			{
+				config->copy_threshold = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, MINWORKERSNO, strlen(MINWORKERSNO)) == 0)
+		{
+			if (!flag_min_workers) flag_min_workers = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(MINWORKERSNO), NULL, 10);
+			if (tmp != 0 && tmp <= INT_MAX)
+			{
+				config->min_workers_no = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, MAXWORKERSNO, strlen(MAXWORKERSNO)) == 0)
+		{
+			if (!flag_max_workers) flag_max_workers = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(MAXWORKERSNO), NULL, 10);
+			if (tmp != 0 && tmp <= INT_MAX)
+			{
+				config->max_workers_no = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, SCALEUPWAIT, strlen(SCALEUPWAIT)) == 0)
+		{
+			if (!flag_wait) flag_wait = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(SCALEUPWAIT), NULL, 10);
+			if (errno != ERANGE)
+			{
+				config->scale_up_wait = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, SCALEUPDEPTH, strlen(SCALEUPDEPTH)) == 0)
+		{
+			if (!flag_depth) flag_depth = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(SCALEUPDEPTH), NULL, 10);
+			if (errno != ERANGE)
+			{
+				config->scale_up_depth = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, IDLECOOLDOWN, strlen(IDLECOOLDOWN)) == 0)
+		{
+			if (!flag_cooldown) flag_cooldown = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(IDLECOOLDOWN), NULL, 10);
+			if (errno != ERANGE)
+			{
+				config->idle_cooldown = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, METADATAWORKERSNO, strlen(METADATAWORKERSNO)) == 0)
+		{
+			if (!flag_metadata_workers) flag_metadata_workers = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(METADATAWORKERSNO), NULL, 10);
+			if (errno != ERANGE && tmp <= INT_MAX)
+			{
+				config->metadata_workers_no = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, METADATATHRESHOLD, strlen(METADATATHRESHOLD)) == 0)
+		{
+			if (!flag_metadata_threshold) flag_metadata_threshold = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(METADATATHRESHOLD), NULL, 10);
+			if (errno != ERANGE)
+			{
+				config->metadata_threshold = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, CLIENTQUANTUM, strlen(CLIENTQUANTUM)) == 0)
+		{
+			if (!flag_quantum) flag_quantum = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(CLIENTQUANTUM), NULL, 10);
+			if (tmp != 0 && tmp <= INT64_MAX)
+			{
+				config->client_quantum = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, CLIENTINFLIGHT, strlen(CLIENTINFLIGHT)) == 0)
+		{
+			if (!flag_in_flight) flag_in_flight = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(CLIENTINFLIGHT), NULL, 10);
+			if (tmp != 0 && errno != ERANGE)
+			{
+				config->client_in_flight = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, REACTORSCPUS, strlen(REACTORSCPUS)) == 0)
+		{
+			if (!flag_reactors_cpus) flag_reactors_cpus = true;
+			else goto invalid_config;
+			strncpy(config->reactors_cpus, buffer + strlen(REACTORSCPUS), BUFFERLEN - 1);
+			config->reactors_cpus[strcspn(config->reactors_cpus, "\n")] = '\0';
+			if (parse_cpus(config->reactors_cpus, NULL, MAXCPUS) != 0) continue;
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, WORKERSCPUS, strlen(WORKERSCPUS)) == 0)
+		{
+			if (!flag_workers_cpus) flag_workers_cpus = true;
+			else goto invalid_config;
+			strncpy(config->workers_cpus, buffer + strlen(WORKERSCPUS), BUFFERLEN - 1);
+			config->workers_cpus[strcspn(config->workers_cpus, "\n")] = '\0';
+			if (parse_cpus(config->workers_cpus, NULL, MAXCPUS) != 0) continue;
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, LOGOVERFLOW, strlen(LOGOVERFLOW)) == 0)
+		{
+			if (!flag_log_overflow) flag_log_overflow = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(LOGOVERFLOW), NULL, 10);
+			if (tmp <= 1)
+			{
+				config->log_overflow = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, LOGSAMPLING, strlen(LOGSAMPLING)) == 0)
+		{
+			if (!flag_log_sampling) flag_log_sampling = true;
+			else goto invalid_config;
+			errno = 0;
+			tmp = strtoul(buffer + strlen(LOGSAMPLING), NULL, 10);
+			if (tmp != 0 && errno != ERANGE)
+			{
+				config->log_sampling = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
+		if (strncmp(buffer, LOGFORMAT, strlen(LOGFORMAT)) == 0)
+		{
+			if (!flag_log_format) flag_log_format = true;
+			else goto invalid_config;
+			tmp = strtoul(buffer + strlen(LOGFORMAT), NULL, 10);
+			if (tmp <= 1)
+			{
+				config->log_format = tmp;
+				continue;
+			}
+			else goto invalid_config;
+		}
 	}
+	// every mandatory param must have been specified
+	if (i != PARAMS) goto invalid_config;
+	// pool starts with the given number of workers: it has to lie within its bounds
+	if (config->min_workers_no > config->workers_no) goto invalid_config;
+	if (config->max_workers_no != 0 && config->max_workers_no < config->workers_no) goto invalid_config;
 	if (fclose(config_file) != 0) return -1;
 	return 0;
 
@@ -159,8 +484,26 @@ ServerConfig_Set(server_config_t* config, const char* config_file_path)
 		config->workers_no = 0;
 		config->max_files_no = 0;
 		config->storage_size = 0;
+		config->pending_no = SOMAXCONN;
+		config->reactors_no = 1;
+		config->backend = EPOLL;
+		config->copy_threshold = 16384;
+		config->min_workers_no = 0;
+		config->max_workers_no = 0;
+		config->scale_up_wait = 1000;
+		config->scale_up_depth = 16;
+		config->idle_cooldown = 5000;
+		config->metadata_workers_no = 0;
+		config->metadata_threshold = 65536;
+		config->client_quantum = 1048576;
+		config->client_in_flight = 64;
+		config->log_overflow = LOG_BLOCK;
+		config->log_sampling = 1;
+		config->log_format = LOG_TEXT;
 		memset(config->socket_path, 0, MAXPATH);
 		memset(config->log_path, 0, MAXPATH);
+		memset(config->reactors_cpus, 0, BUFFERLEN);
+		memset(config->workers_cpus, 0, BUFFERLEN);
 		fclose(config_file);
 		errno = EINVAL;
 		return -1;
@@ -199,6 +542,224 @@ ServerConfig_GetStorageSize(const server_config_t* config)
 	return config->storage_size;
 }
 
+unsigned long
+ServerConfig_GetMaxPendingConnections(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 1;
+	}
+	return config->pending_no;
+}
+
+unsigned long
+ServerConfig_GetReactorsNo(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 1;
+	}
+	return config->reactors_no;
+}
+
+io_backend_t
+ServerConfig_GetIOBackend(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->backend;
+}
+
+unsigned long
+ServerConfig_GetCopyThreshold(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->copy_threshold;
+}
+
+unsigned long
+ServerConfig_GetMinWorkersNo(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return (config->min_workers_no != 0) ? config->min_workers_no : config->workers_no;
+}
+
+unsigned long
+ServerConfig_GetMaxWorkersNo(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return (config->max_workers_no != 0) ? config->max_workers_no : config->workers_no;
+}
+
+unsigned long
+ServerConfig_GetScaleUpWait(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->scale_up_wait;
+}
+
+unsigned long
+ServerConfig_GetScaleUpDepth(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->scale_up_depth;
+}
+
+unsigned long
+ServerConfig_GetIdleCooldown(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->idle_cooldown;
+}
+
+unsigned long
+ServerConfig_GetMetadataWorkersNo(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->metadata_workers_no;
+}
+
+unsigned long
+ServerConfig_GetMetadataThreshold(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->metadata_threshold;
+}
+
+unsigned long
+ServerConfig_GetClientQuantum(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->client_quantum;
+}
+
+unsigned long
+ServerConfig_GetClientInFlight(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->client_in_flight;
+}
+
+log_overflow_t
+ServerConfig_GetLogOverflow(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->log_overflow;
+}
+
+unsigned long
+ServerConfig_GetLogSampling(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->log_sampling;
+}
+
+log_format_t
+ServerConfig_GetLogFormat(const server_config_t* config)
+{
+	if (!config)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	return config->log_format;
+}
+
+unsigned long
+ServerConfig_GetReactorsCPUs(const server_config_t* config, int** cpus_ptr)
+{
+	if (!config || !cpus_ptr)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	size_t cpus_no = parse_cpus(config->reactors_cpus, NULL, MAXCPUS);
+	if (cpus_no == 0) return 0;
+	int* tmp = (int*) malloc(sizeof(int) * cpus_no);
+	if (!tmp)
+	{
+		errno = ENOMEM;
+		return 0;
+	}
+	parse_cpus(config->reactors_cpus, tmp, cpus_no);
+	*cpus_ptr = tmp;
+	return cpus_no;
+}
+
+unsigned long
+ServerConfig_GetWorkersCPUs(const server_config_t* config, int** cpus_ptr)
+{
+	if (!config || !cpus_ptr)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	size_t cpus_no = parse_cpus(config->workers_cpus, NULL, MAXCPUS);
+	if (cpus_no == 0) return 0;
+	int* tmp = (int*) malloc(sizeof(int) * cpus_no);
+	if (!tmp)
+	{
+		errno = ENOMEM;
+		return 0;
+	}
+	parse_cpus(config->workers_cpus, tmp, cpus_no);
+	*cpus_ptr = tmp;
+	return cpus_no;
+}
+
 unsigned long
 ServerConfig_GetLogFilePath(const server_config_t* config, char** log_path_ptr)
 {
@@ -0,0 +1,429 @@
+/**
+ * @brief Source file for radix_tree header.
+ * @author Giacomo Trapani.
+*/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linked_list.h>
+#include <radix_tree.h>
+
+// Node of the tree: shared prefixes are compressed into a single label.
+typedef struct _radix_node
+{
+	char* label; // part of the key this node adds to its parent's one
+	size_t label_len; // length of label
+	bool is_key; // toggled on if the path from the root to this node is a key
+	struct _radix_node** children; // children sorted by their label's first character
+	size_t children_no; // number of children
+	size_t children_size; // allocated size of children
+} radix_node_t;
+
+struct _radix_tree
+{
+	radix_node_t* root; // its label is always empty
+	size_t keys_no; // number of keys in tree
+};
+
+// Used to keep track of the key being built while visiting the tree.
+typedef struct _radix_walk
+{
+	char* path; // key of currently visited node
+	size_t path_len; // length of path
+	size_t path_size; // allocated size of path
+	linked_list_t* keys; // list of visited keys
+	size_t left; // number of keys yet to be copied; if it is 0, there is no limit
+	bool limited; // toggled on if the number of keys to be copied is limited
+} radix_walk_t;
+
+/**
+ * @brief Allocates memory for a new node with given label.
+ * @returns Initialized node on success, NULL on failure.
+ * @exception It sets "errno" for any of the errors specified for the routine "malloc".
+*/
+static radix_node_t*
+RadixNode_Create(const char* label, size_t label_len, bool is_key)
+{
+	radix_node_t* tmp = (radix_node_t*) malloc(sizeof(radix_node_t));
+	if (!tmp) return NULL;
+	tmp->label = (char*) malloc(sizeof(char) * (label_len + 1));
+	if (!tmp->label)
+	{
+		free(tmp);
+		return NULL;
+	}
+	memcpy(tmp->label, label, label_len);
+	tmp->label[label_len] = '\0';
+	tmp->label_len = label_len;
+	tmp->is_key = is_key;
+	tmp->children = NULL;
+	tmp->children_no = 0;
+	tmp->children_size = 0;
+	return tmp;
+}
+
+/**
+ * Frees node and its subtree.
+*/
+static void
+RadixNode_Free(radix_node_t* node)
+{
+	if (!node) return;
+	for (size_t i = 0; i < node->children_no; i++)
+		RadixNode_Free(node->children[i]);
+	free(node->children);
+	free(node->label);
+	free(node);
+}
+
+/**
+ * @brief Binary searches node's children for the one whose label starts with given character.
+ * @returns Index of such child if found is set to true, index it should be inserted at otherwise.
+*/
+static size_t
+RadixNode_FindChild(const radix_node_t* node, unsigned char c, bool* found)
+{
+	size_t low = 0, high = node->children_no;
+	*found = false;
+	while (low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		unsigned char curr = (unsigned char) node->children[mid]->label[0];
+		if (curr == c)
+		{
+			*found = true;
+			return mid;
+		}
+		if (curr < c) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+
+/**
+ * @brief Inserts child at given index of node's children.
+ * @returns 0 on success, -1 on failure.
+ * @exception It sets "errno" for any of the errors specified for the routine "realloc".
+*/
+static int
+RadixNode_InsertChild(radix_node_t* node, radix_node_t* child, size_t index)
+{
+	if (node->children_no == node->children_size)
+	{
+		size_t new_size = (node->children_size == 0) ? 2 : node->children_size * 2;
+		radix_node_t** tmp = (radix_node_t**) realloc(node->children, sizeof(radix_node_t*) * new_size);
+		if (!tmp) return -1;
+		node->children = tmp;
+		node->children_size = new_size;
+	}
+	memmove(node->children + index + 1, node->children + index,
+				sizeof(radix_node_t*) * (node->children_no - index));
+	node->children[index] = child;
+	node->children_no++;
+	return 0;
+}
+
+/**
+ * Removes child at given index from node's children without freeing it.
+*/
+static void
+RadixNode_RemoveChild(radix_node_t* node, size_t index)
+{
+	memmove(node->children + index, node->children + index + 1,
+				sizeof(radix_node_t*) * (node->children_no - index - 1));
+	node->children_no--;
+}
+
+/**
+ * Merges node with its only child. If there is not enough memory, the tree is left uncompressed
+ * (which is still valid).
+*/
+static void
+RadixNode_MergeWithChild(radix_node_t* node)
+{
+	radix_node_t* child = node->children[0];
+	char* label = (char*) malloc(sizeof(char) * (node->label_len + child->label_len + 1));
+	if (!label) return;
+	memcpy(label, node->label, node->label_len);
+	memcpy(label + node->label_len, child->label, child->label_len + 1);
+	free(node->label);
+	free(node->children);
+	node->label = label;
+	node->label_len += child->label_len;
+	node->is_key = child->is_key;
+	node->children = child->children;
+	node->children_no = child->children_no;
+	node->children_size = child->children_size;
+	free(child->label);
+	free(child);
+}
+
+/**
+ * @returns Length of the longest common prefix between given label and key.
+*/
+static size_t
+common_prefix_len(const char* label, size_t label_len, const char* key)
+{
+	size_t i = 0;
+	while (i < label_len && key[i] != '\0' && label[i] == key[i]) i++;
+	return i;
+}
+
+radix_tree_t*
+RadixTree_Init()
+{
+	radix_tree_t* tmp = (radix_tree_t*) malloc(sizeof(radix_tree_t));
+	if (!tmp) return NULL;
+	tmp->root = RadixNode_Create("", 0, false);
+	if (!tmp->root)
+	{
+		free(tmp);
+		return NULL;
+	}
+	tmp->keys_no = 0;
+	return tmp;
+}
+
+int
+RadixTree_Insert(radix_tree_t* tree, const char* key)
+{
+	if (!tree || !key || *key == '\0')
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	radix_node_t* node = tree->root;
+	const char* rest = key; // part of the key yet to be matched
+	bool found;
+	size_t index, len;
+	while (1)
+	{
+		if (*rest == '\0') // node denotes key
+		{
+			if (node->is_key) return 0;
+			node->is_key = true;
+			tree->keys_no++;
+			return 1;
+		}
+		index = RadixNode_FindChild(node, (unsigned char) *rest, &found);
+		if (!found) // no child shares a prefix with key: a new leaf is added
+		{
+			radix_node_t* leaf = RadixNode_Create(rest, strlen(rest), true);
+			if (!leaf) return -1;
+			if (RadixNode_InsertChild(node, leaf, index) != 0)
+			{
+				RadixNode_Free(leaf);
+				return -1;
+			}
+			tree->keys_no++;
+			return 1;
+		}
+		radix_node_t* child = node->children[index];
+		len = common_prefix_len(child->label, child->label_len, rest);
+		if (len < child->label_len) // child's label has to be split
+		{
+			radix_node_t* middle = RadixNode_Create(child->label, len, false);
+			if (!middle) return -1;
+			char* suffix = (char*) malloc(sizeof(char) * (child->label_len - len + 1));
+			if (!suffix || RadixNode_InsertChild(middle, child, 0) != 0)
+			{
+				free(suffix);
+				RadixNode_Free(middle);
+				return -1;
+			}
+			memcpy(suffix, child->label + len, child->label_len - len + 1);
+			free(child->label);
+			child->label = suffix;
+			child->label_len -= len;
+			// both labels start with the same character, hence children are still sorted
+			node->children[index] = middle;
+			child = middle;
+		}
+		node = child;
+		rest += len;
+	}
+}
+
+int
+RadixTree_Remove(radix_tree_t* tree, const char* key)
+{
+	if (!tree || !key)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	radix_node_t* parent = NULL;
+	radix_node_t* node = tree->root;
+	const char* rest = key;
+	size_t index = 0, len;
+	bool found;
+	while (*rest != '\0')
+	{
+		size_t child_index = RadixNode_FindChild(node, (unsigned char) *rest, &found);
+		if (!found) return 0;
+		radix_node_t* child = node->children[child_index];
+		len = common_prefix_len(child->label, child->label_len, rest);
+		if (len < child->label_len) return 0;
+		parent = node;
+		index = child_index;
+		node = child;
+		rest += len;
+	}
+	if (!node->is_key) return 0;
+	node->is_key = false;
+	tree->keys_no--;
+
+	if (node == tree->root) return 1;
+	// keep the tree compressed
+	if (node->children_no == 0)
+	{
+		RadixNode_RemoveChild(parent, index);
+		RadixNode_Free(node);
+		if (parent != tree->root && !parent->is_key && parent->children_no == 1)
+			RadixNode_MergeWithChild(parent);
+	}
+	else if (node->children_no == 1) RadixNode_MergeWithChild(node);
+	return 1;
+}
+
+int
+RadixTree_Contains(const radix_tree_t* tree, const char* key)
+{
+	if (!tree || !key)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	const radix_node_t* node = tree->root;
+	const char* rest = key;
+	size_t len;
+	bool found;
+	while (*rest != '\0')
+	{
+		size_t index = RadixNode_FindChild(node, (unsigned char) *rest, &found);
+		if (!found) return 0;
+		node = node->children[index];
+		len = common_prefix_len(node->label, node->label_len, rest);
+		if (len < node->label_len) return 0;
+		rest += len;
+	}
+	return node->is_key ? 1 : 0;
+}
+
+/**
+ * @brief Appends given label to walk's path.
+ * @returns 0 on success, -1 on failure.
+ * @exception It sets "errno" for any of the errors specified for the routine "realloc".
+*/
+static int
+RadixWalk_Push(radix_walk_t* walk, const char* label, size_t label_len)
+{
+	if (walk->path_len + label_len + 1 > walk->path_size)
+	{
+		size_t new_size = (walk->path_len + label_len + 1) * 2;
+		char* tmp = (char*) realloc(walk->path, sizeof(char) * new_size);
+		if (!tmp) return -1;
+		walk->path = tmp;
+		walk->path_size = new_size;
+	}
+	memcpy(walk->path + walk->path_len, label, label_len);
+	walk->path_len += label_len;
+	walk->path[walk->path_len] = '\0';
+	return 0;
+}
+
+/**
+ * @brief Visits node's subtree in lexicographical order copying every key into walk's list.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "RadixWalk_Push",
+ * "LinkedList_PushBack".
+*/
+static int
+RadixWalk_Visit(radix_walk_t* walk, const radix_node_t* node)
+{
+	if (walk->limited && walk->left == 0) return 0;
+	size_t path_len = walk->path_len;
+	if (RadixWalk_Push(walk, node->label, node->label_len) != 0) return -1;
+	if (node->is_key)
+	{
+		if (LinkedList_PushBack(walk->keys, walk->path, walk->path_len + 1, NULL, 0) != 0) return -1;
+		if (walk->limited) walk->left--;
+	}
+	for (size_t i = 0; i < node->children_no; i++)
+		if (RadixWalk_Visit(walk, node->children[i]) != 0) return -1;
+	walk->path_len = path_len;
+	walk->path[path_len] = '\0';
+	return 0;
+}
+
+linked_list_t*
+RadixTree_CopyKeysWithPrefix(const radix_tree_t* tree, const char* prefix, size_t max)
+{
+	if (!tree)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	int errnocopy;
+	radix_walk_t walk;
+	walk.path = NULL;
+	walk.path_len = 0;
+	walk.path_size = 0;
+	walk.left = max;
+	walk.limited = (max != 0);
+	walk.keys = LinkedList_Init(free);
+	if (!walk.keys) return NULL;
+	if (RadixWalk_Push(&walk, "", 0) != 0) goto failure;
+
+	// descend to the node whose subtree contains every key matching prefix;
+	// labels are pushed when leaving a node as visiting a node pushes its own one
+	const radix_node_t* node = tree->root;
+	const char* rest = prefix ? prefix : "";
+	size_t index, len;
+	bool found;
+	while (*rest != '\0')
+	{
+		index = RadixNode_FindChild(node, (unsigned char) *rest, &found);
+		if (!found) goto done; // no key matches prefix
+		const radix_node_t* child = node->children[index];
+		len = common_prefix_len(child->label, child->label_len, rest);
+		if (rest[len] != '\0' && len < child->label_len) goto done; // prefix diverges from child's label
+		if (RadixWalk_Push(&walk, node->label, node->label_len) != 0) goto failure;
+		node = child;
+		rest += len;
+	}
+	if (RadixWalk_Visit(&walk, node) != 0) goto failure;
+
+	done:
+		free(walk.path);
+		return walk.keys;
+
+	failure:
+		errnocopy = errno;
+		free(walk.path);
+		LinkedList_Free(walk.keys);
+		errno = errnocopy;
+		return NULL;
+}
+
+size_t
+RadixTree_GetNumberOfKeys(const radix_tree_t* tree)
+{
+	if (!tree) return 0;
+	return tree->keys_no;
+}
+
+void
+RadixTree_Free(radix_tree_t* tree)
+{
+	if (!tree) return;
+	RadixNode_Free(tree->root);
+	free(tree);
+}
@@ -0,0 +1,285 @@
+/**
+ * @brief Source file for task_queue header.
+ * @author Giacomo Trapani.
+*/
+#define _GNU_SOURCE // syscall
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <task_queue.h>
+
+#define CACHELINE 64 // fields written by different threads are kept on different lines to avoid false sharing
+
+// Slot of the ring: its sequence number tells whether it is ready to be written or read at a given position.
+struct cell
+{
+	size_t sequence;
+	int value;
+} __attribute__((aligned(CACHELINE)));
+
+// Side of the ring: producers own the enqueue one, consumers the dequeue one.
+struct side
+{
+	size_t pos; // next position to be claimed
+	uint32_t ops; // futex word, bumped every time an operation completes on this side
+	uint32_t waiting; // number of threads of the other side sleeping on ops
+} __attribute__((aligned(CACHELINE)));
+
+struct _task_queue
+{
+	struct cell* cells; // ring itself
+	size_t mask; // capacity - 1
+	struct side enqueue; // consumers sleep on it while the ring is empty
+	struct side dequeue; // producers sleep on it while the ring is full
+};
+
+/**
+ * @brief Puts callee to sleep as long as given word holds given value.
+ * @returns 0 on success, -1 on failure.
+*/
+static int
+futex_wait(uint32_t* word, uint32_t value)
+{
+	if (syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0) == -1
+			&& errno != EAGAIN && errno != EINTR)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief Wakes up a thread sleeping on given word, if any.
+ * @returns 0 on success, -1 on failure.
+*/
+static int
+futex_wake(uint32_t* word)
+{
+	return syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0) == -1 ? -1 : 0;
+}
+
+/**
+ * @brief Tries to enqueue value without waiting.
+ * @returns true on success, false if the ring is full.
+*/
+static bool
+try_enqueue(task_queue_t* queue, int value)
+{
+	struct cell* cell;
+	size_t pos = __atomic_load_n(&(queue->enqueue.pos), __ATOMIC_RELAXED);
+	size_t sequence;
+	intptr_t diff;
+
+	while (1)
+	{
+		cell = &(queue->cells[pos & queue->mask]);
+		sequence = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+		diff = (intptr_t) sequence - (intptr_t) pos;
+		// slot is free: it is claimed by moving the position forward
+		if (diff == 0)
+		{
+			if (__atomic_compare_exchange_n(&(queue->enqueue.pos), &pos, pos + 1, true,
+						__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		// slot has yet to be read since the previous lap
+		else if (diff < 0) return false;
+		// another producer claimed the slot first
+		else pos = __atomic_load_n(&(queue->enqueue.pos), __ATOMIC_RELAXED);
+	}
+	cell->value = value;
+	// value must be visible before the slot is handed to consumers
+	__atomic_store_n(&(cell->sequence), pos + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief Tries to dequeue a value without waiting.
+ * @returns true on success, false if the ring is empty.
+*/
+static bool
+try_dequeue(task_queue_t* queue, int* valueptr)
+{
+	struct cell* cell;
+	size_t pos = __atomic_load_n(&(queue->dequeue.pos), __ATOMIC_RELAXED);
+	size_t sequence;
+	intptr_t diff;
+
+	while (1)
+	{
+		cell = &(queue->cells[pos & queue->mask]);
+		sequence = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+		diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+		// slot has been written: it is claimed by moving the position forward
+		if (diff == 0)
+		{
+			if (__atomic_compare_exchange_n(&(queue->dequeue.pos), &pos, pos + 1, true,
+						__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		// slot has yet to be written
+		else if (diff < 0) return false;
+		// another consumer claimed the slot first
+		else pos = __atomic_load_n(&(queue->dequeue.pos), __ATOMIC_RELAXED);
+	}
+	*valueptr = cell->value;
+	// slot is handed back to producers for the next lap
+	__atomic_store_n(&(cell->sequence), pos + queue->mask + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief Signals an operation has completed on given side, waking up a thread of the other side if any is sleeping.
+ * @returns 0 on success, -1 on failure.
+*/
+static int
+side_done(struct side* side)
+{
+	// sequentially consistent operations order the update of the slot before the check on sleeping threads
+	__atomic_add_fetch(&(side->ops), 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&(side->waiting), __ATOMIC_SEQ_CST) == 0) return 0;
+	return futex_wake(&(side->ops));
+}
+
+task_queue_t*
+TaskQueue_Init(size_t capacity)
+{
+	if (capacity == 0 || capacity > (SIZE_MAX >> 1))
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+	int errnocopy;
+	size_t rounded = 1;
+	task_queue_t* tmp = NULL;
+	void* cells = NULL;
+
+	while (rounded < capacity) rounded <<= 1;
+	errno = posix_memalign(&cells, CACHELINE, sizeof(struct cell) * rounded);
+	if (errno != 0) return NULL;
+	errno = posix_memalign((void**) &tmp, CACHELINE, sizeof(task_queue_t));
+	if (errno != 0)
+	{
+		errnocopy = errno;
+		free(cells);
+		errno = errnocopy;
+		return NULL;
+	}
+	memset(tmp, 0, sizeof(task_queue_t));
+	tmp->cells = (struct cell*) cells;
+	tmp->mask = rounded - 1;
+	for (size_t i = 0; i < rounded; i++)
+	{
+		tmp->cells[i].sequence = i;
+		tmp->cells[i].value = 0;
+	}
+
+	return tmp;
+}
+
+int
+TaskQueue_Enqueue(task_queue_t* queue, int value)
+{
+	if (!queue)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	uint32_t ops;
+
+	while (!try_enqueue(queue, value))
+	{
+		// ring is full: callee sleeps until a consumer frees a slot
+		ops = __atomic_load_n(&(queue->dequeue.ops), __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&(queue->dequeue.waiting), 1, __ATOMIC_SEQ_CST);
+		// a slot may have been freed before callee was accounted for
+		if (try_enqueue(queue, value))
+		{
+			__atomic_sub_fetch(&(queue->dequeue.waiting), 1, __ATOMIC_SEQ_CST);
+			break;
+		}
+		if (futex_wait(&(queue->dequeue.ops), ops) == -1) return -1;
+		__atomic_sub_fetch(&(queue->dequeue.waiting), 1, __ATOMIC_SEQ_CST);
+	}
+	return side_done(&(queue->enqueue));
+}
+
+int
+TaskQueue_TryEnqueue(task_queue_t* queue, int value)
+{
+	if (!queue)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!try_enqueue(queue, value)) return 0;
+	return side_done(&(queue->enqueue)) == -1 ? -1 : 1;
+}
+
+int
+TaskQueue_Dequeue(task_queue_t* queue, int* valueptr)
+{
+	if (!queue || !valueptr)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	uint32_t ops;
+
+	while (!try_dequeue(queue, valueptr))
+	{
+		// ring is empty: callee sleeps until a producer fills a slot
+		ops = __atomic_load_n(&(queue->enqueue.ops), __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&(queue->enqueue.waiting), 1, __ATOMIC_SEQ_CST);
+		// a slot may have been filled before callee was accounted for
+		if (try_dequeue(queue, valueptr))
+		{
+			__atomic_sub_fetch(&(queue->enqueue.waiting), 1, __ATOMIC_SEQ_CST);
+			break;
+		}
+		if (futex_wait(&(queue->enqueue.ops), ops) == -1) return -1;
+		__atomic_sub_fetch(&(queue->enqueue.waiting), 1, __ATOMIC_SEQ_CST);
+	}
+	return side_done(&(queue->dequeue));
+}
+
+int
+TaskQueue_TryDequeue(task_queue_t* queue, int* valueptr)
+{
+	if (!queue || !valueptr)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!try_dequeue(queue, valueptr)) return 0;
+	return side_done(&(queue->dequeue)) == -1 ? -1 : 1;
+}
+
+size_t
+TaskQueue_GetNumberOfElements(const task_queue_t* queue)
+{
+	if (!queue)
+	{
+		errno = EINVAL;
+		return 0;
+	}
+	size_t dequeued = __atomic_load_n(&(queue->dequeue.pos), __ATOMIC_RELAXED);
+	size_t enqueued = __atomic_load_n(&(queue->enqueue.pos), __ATOMIC_RELAXED);
+
+	// positions are read one after the other: consumers may have moved past the read producers' one
+	return (enqueued > dequeued) ? enqueued - dequeued : 0;
+}
+
+void
+TaskQueue_Free(task_queue_t* queue)
+{
+	if (!queue) return;
+	free(queue->cells);
+	free(queue);
+}
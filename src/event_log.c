@@ -0,0 +1,535 @@
+/**
+ * @brief Source file for event_log header.
+ * @author Giacomo Trapani.
+*/
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <event_log.h>
+#include <wrappers.h>
+
+#define CACHELINE 64 // fields written by different threads are kept on different lines to avoid false sharing
+#define RING_RECORDS 4096 // records each thread's ring holds, a power of two
+#define RING_PATHS 262144 // bytes of paths each thread's ring holds, a power of two
+#define WAKE_EVERY (RING_RECORDS / 2) // records a thread appends before it wakes the flusher up
+#define FLUSH_PERIOD 5 // milliseconds the flusher sleeps for when there is nothing to flush
+#define BATCH_LEN 65536 // bytes written to log file at once
+#define LINE_LEN (REQUESTLEN + 256) // longest line a record is rendered as, it is longer than any binary entry
+
+// Ring of a single thread: it is the only one appending to it, the flusher is the only one taking from it.
+struct log_ring
+{
+	log_record_t* records;
+	char* paths; // paths records refer to, one after the other
+	struct log_ring* next; // next ring of the log
+	int owned; // toggled on while a thread appends to ring
+	int32_t thread; // thread appending to ring
+	// written by the thread only
+	uint64_t head __attribute__((aligned(CACHELINE))); // records appended so far
+	uint64_t paths_head; // bytes of paths appended so far
+	uint64_t appended; // requests appended or sampled out so far
+	uint64_t dropped; // records dropped because ring was full
+	// written by the flusher only
+	uint64_t tail __attribute__((aligned(CACHELINE))); // records flushed so far
+	uint64_t paths_tail; // bytes of paths flushed so far
+};
+
+struct _event_log
+{
+	FILE* file;
+	log_format_t format;
+	log_overflow_t overflow;
+	unsigned long sampling;
+	struct log_ring* rings; // every ring allocated so far, rings are freed along with the log
+	pthread_t flusher; // thread rendering and writing records
+	pthread_mutex_t mutex; // used to guarantee mutual exclusion over rings' list and to sleep on the conditions
+	pthread_cond_t wake; // signaled to wake the flusher up
+	pthread_cond_t flushed; // broadcast by the flusher whenever threads wait for their ring to be flushed
+	int blocked; // number of threads waiting for their ring to be flushed
+	bool woken; // toggled on by threads which found their ring full, so that flusher does not go to sleep
+	int stop; // toggled on when flusher is to exit as soon as every ring is empty
+	char* batch; // text or block yet to be written to log file (USED ONLY BY the flusher)
+	size_t batch_len; // length of batch, block header included
+	uint32_t batch_records; // number of entries block holds
+};
+
+// Ring of the calling thread, NULL if it has yet to append any record.
+static __thread struct log_ring* own_ring = NULL;
+
+/**
+ * @brief Gets a ring for callee: one handed over by a thread which exited is taken if any, a new one is allocated
+ * otherwise.
+ * @returns Ring on success, NULL on failure.
+*/
+static struct log_ring*
+take_ring(event_log_t* log)
+{
+	int owned = 0; // expected value of a ring no thread appends to
+	struct log_ring* ring;
+	int errnocopy;
+
+	for (ring = __atomic_load_n(&(log->rings), __ATOMIC_ACQUIRE); ring; ring = ring->next)
+	{
+		if (__atomic_compare_exchange_n(&(ring->owned), &owned, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			ring->thread = (int32_t) pthread_self();
+			return ring;
+		}
+		owned = 0;
+	}
+	if ((errno = posix_memalign((void**) &ring, CACHELINE, sizeof(struct log_ring))) != 0) return NULL;
+	memset(ring, 0, sizeof(struct log_ring));
+	ring->records = (log_record_t*) malloc(sizeof(log_record_t) * RING_RECORDS);
+	ring->paths = (char*) malloc(RING_PATHS);
+	if (!ring->records || !ring->paths)
+	{
+		errnocopy = errno;
+		free(ring->records);
+		free(ring->paths);
+		free(ring);
+		errno = errnocopy;
+		return NULL;
+	}
+	ring->owned = 1;
+	ring->thread = (int32_t) pthread_self();
+	// flusher walks the list without taking the mutex: ring is published once it has been initialized
+	pthread_mutex_lock(&(log->mutex));
+	ring->next = log->rings;
+	__atomic_store_n(&(log->rings), ring, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&(log->mutex));
+	return ring;
+}
+
+/**
+ * @brief Tells whether given ring has room for a record referring to a path of given length.
+*/
+static inline bool
+has_room(const struct log_ring* ring, size_t path_len)
+{
+	return ring->head - __atomic_load_n(&(ring->tail), __ATOMIC_ACQUIRE) < RING_RECORDS
+			&& ring->paths_head + path_len - __atomic_load_n(&(ring->paths_tail), __ATOMIC_ACQUIRE) <= RING_PATHS;
+}
+
+/**
+ * @brief Writes text or block gathered so far to log file.
+*/
+static void
+batch_write(event_log_t* log)
+{
+	size_t empty = (log->format == LOG_BINARY) ? sizeof(log_block_t) : 0; // length of a batch holding nothing
+	log_block_t* block = (log_block_t*) log->batch;
+
+	if (log->batch_len == empty) return;
+	if (log->format == LOG_BINARY)
+	{
+		block->magic = LOG_BLOCK_MAGIC;
+		block->records = log->batch_records;
+		block->length = log->batch_len - empty;
+	}
+	if (fwrite(log->batch, 1, log->batch_len, log->file) != log->batch_len) perror("fwrite");
+	log->batch_len = empty;
+	log->batch_records = 0;
+}
+
+/**
+ * @brief Copies given record, along with the path it refers to, into the block being gathered.
+ * @returns Size of the entry.
+*/
+static size_t
+batch_entry(event_log_t* log, const log_record_t* record, const char* path)
+{
+	char* entry = log->batch + log->batch_len;
+	size_t size = LOG_ENTRY_SIZE(record->path_len);
+
+	memcpy(entry, record, sizeof(log_record_t));
+	// position in the ring of paths means nothing once record has left it
+	((log_record_t*) entry)->path_pos = 0;
+	memset(entry + sizeof(log_record_t), 0, size - sizeof(log_record_t));
+	if (record->path_len != 0) memcpy(entry + sizeof(log_record_t), path, record->path_len);
+	log->batch_records++;
+	return size;
+}
+
+/**
+ * @brief Renders or copies every record given ring holds and hands the room they took back to its thread.
+ * @returns Number of records drained.
+*/
+static size_t
+drain_ring(event_log_t* log, struct log_ring* ring)
+{
+	uint64_t head = __atomic_load_n(&(ring->head), __ATOMIC_ACQUIRE);
+	uint64_t tail = ring->tail;
+	uint64_t paths_tail = ring->paths_tail;
+	size_t drained = (size_t) (head - tail);
+	const log_record_t* record;
+	char path[REQUESTLEN]; // path record refers to, as a string
+	size_t first; // bytes of path lying before the end of the ring of paths
+
+	for (; tail != head; tail++)
+	{
+		record = &(ring->records[tail & (RING_RECORDS - 1)]);
+		// paths wrap around the end of their ring
+		first = RING_PATHS - record->path_pos;
+		if (first > record->path_len) first = record->path_len;
+		memcpy(path, ring->paths + record->path_pos, first);
+		memcpy(path + first, ring->paths, record->path_len - first);
+		path[record->path_len] = '\0';
+		paths_tail += record->path_len;
+		if (BATCH_LEN - log->batch_len < LINE_LEN) batch_write(log);
+		if (log->format == LOG_BINARY) log->batch_len += batch_entry(log, record, path);
+		else log->batch_len += MIN(LogRecord_Format(record, path, log->batch + log->batch_len, LINE_LEN), LINE_LEN - 1);
+	}
+	if (drained == 0) return 0;
+	// records have been drained: the thread may take their room back
+	__atomic_store_n(&(ring->paths_tail), paths_tail, __ATOMIC_RELEASE);
+	__atomic_store_n(&(ring->tail), tail, __ATOMIC_RELEASE);
+	return drained;
+}
+
+/**
+ * @brief Flusher keeps draining the records appended by every thread and writing them to log file in batches:
+ * whenever there is none left, it flushes log file and sleeps until it is woken up or a period has elapsed.
+ * @returns NULL.
+*/
+static void*
+flusher_routine(void* arg)
+{
+	event_log_t* log = (event_log_t*) arg;
+	struct log_ring* ring;
+	size_t drained; // records drained by the last pass over the rings
+	int stop;
+	struct timespec deadline;
+
+	while (1)
+	{
+		// records appended before stop was toggled on are rendered by the following pass
+		stop = __atomic_load_n(&(log->stop), __ATOMIC_ACQUIRE);
+		drained = 0;
+		for (ring = __atomic_load_n(&(log->rings), __ATOMIC_ACQUIRE); ring; ring = ring->next)
+			drained += drain_ring(log, ring);
+		// threads waiting for room are told to look at their ring again
+		if (__atomic_load_n(&(log->blocked), __ATOMIC_ACQUIRE) != 0)
+		{
+			pthread_mutex_lock(&(log->mutex));
+			pthread_cond_broadcast(&(log->flushed));
+			pthread_mutex_unlock(&(log->mutex));
+		}
+		if (drained != 0) continue;
+		batch_write(log);
+		fflush(log->file);
+		if (stop) return NULL;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += FLUSH_PERIOD * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+		pthread_mutex_lock(&(log->mutex));
+		// threads which have found their ring full in the meantime are not left waiting for a whole period
+		if (!__atomic_load_n(&(log->stop), __ATOMIC_ACQUIRE) && !log->woken)
+			pthread_cond_timedwait(&(log->wake), &(log->mutex), &deadline);
+		log->woken = false;
+		pthread_mutex_unlock(&(log->mutex));
+	}
+}
+
+event_log_t*
+EventLog_Init(FILE* file, log_format_t format, log_overflow_t overflow, unsigned long sampling)
+{
+	if (!file || sampling == 0 || (format != LOG_TEXT && format != LOG_BINARY)
+			|| (overflow != LOG_BLOCK && overflow != LOG_DROP))
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+	int err;
+	log_file_header_t header;
+	event_log_t* tmp = (event_log_t*) malloc(sizeof(event_log_t));
+	if (!tmp) return NULL;
+	memset(tmp, 0, sizeof(event_log_t));
+	tmp->file = file;
+	tmp->format = format;
+	tmp->overflow = overflow;
+	tmp->sampling = sampling;
+	tmp->batch = (char*) malloc(BATCH_LEN);
+	if (!tmp->batch) goto failure;
+	if (format == LOG_BINARY)
+	{
+		memset(&header, 0, sizeof(log_file_header_t));
+		memcpy(header.magic, LOG_FILE_MAGIC, sizeof(header.magic));
+		header.record_size = sizeof(log_record_t);
+		header.sampling = (uint32_t) MIN(sampling, UINT32_MAX);
+		if (fwrite(&header, sizeof(log_file_header_t), 1, file) != 1) goto failure;
+		// room for the header of the first block
+		tmp->batch_len = sizeof(log_block_t);
+	}
+	if ((err = pthread_mutex_init(&(tmp->mutex), NULL)) != 0) goto failure;
+	if ((err = pthread_cond_init(&(tmp->wake), NULL)) != 0) goto failure_mutex;
+	if ((err = pthread_cond_init(&(tmp->flushed), NULL)) != 0) goto failure_wake;
+	if ((err = pthread_create(&(tmp->flusher), NULL, flusher_routine, (void*) tmp)) != 0) goto failure_flushed;
+	return tmp;
+
+	failure_flushed:
+		pthread_cond_destroy(&(tmp->flushed));
+	failure_wake:
+		pthread_cond_destroy(&(tmp->wake));
+	failure_mutex:
+		pthread_mutex_destroy(&(tmp->mutex));
+		errno = err;
+	failure:
+		err = errno;
+		free(tmp->batch);
+		free(tmp);
+		errno = err;
+		return NULL;
+}
+
+int
+EventLog_Append(event_log_t* log, log_record_t* record, const char* path)
+{
+	if (!log || !record || record->event > LOG_DROPPED)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	struct log_ring* ring = own_ring;
+	struct timespec now;
+	size_t path_len = 0;
+	size_t first; // bytes of path lying before the end of the ring of paths
+
+	if (!ring && !(ring = own_ring = take_ring(log))) return -1;
+	// requests are sampled, whereas every other event is logged
+	if (record->event < LOG_VICTIM && log->sampling != 1 && ring->appended++ % log->sampling != 0) return 0;
+	if (path) path_len = strnlen(path, REQUESTLEN - 1);
+	if (!has_room(ring, path_len))
+	{
+		// flusher is woken up without waiting for the mutex: it is bound to wake up by itself anyway
+		pthread_cond_signal(&(log->wake));
+		if (log->overflow == LOG_DROP)
+		{
+			ring->dropped++;
+			return 0;
+		}
+		pthread_mutex_lock(&(log->mutex));
+		__atomic_add_fetch(&(log->blocked), 1, __ATOMIC_RELEASE);
+		while (!has_room(ring, path_len))
+		{
+			log->woken = true;
+			pthread_cond_signal(&(log->wake));
+			pthread_cond_wait(&(log->flushed), &(log->mutex));
+		}
+		__atomic_sub_fetch(&(log->blocked), 1, __ATOMIC_RELEASE);
+		pthread_mutex_unlock(&(log->mutex));
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	record->timestamp = (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+	record->thread = ring->thread;
+	record->path_len = (uint16_t) path_len;
+	record->path_pos = (uint32_t) (ring->paths_head & (RING_PATHS - 1));
+	// path wraps around the end of its ring
+	first = MIN(path_len, RING_PATHS - record->path_pos);
+	memcpy(ring->paths + record->path_pos, path, first);
+	memcpy(ring->paths, path + first, path_len - first);
+	ring->paths_head += path_len;
+	ring->records[ring->head & (RING_RECORDS - 1)] = *record;
+	// record and its path must be visible before the flusher gets to them
+	__atomic_store_n(&(ring->head), ring->head + 1, __ATOMIC_RELEASE);
+	if ((ring->head & (WAKE_EVERY - 1)) == 0) pthread_cond_signal(&(log->wake));
+	return 0;
+}
+
+void
+EventLog_Detach(event_log_t* log)
+{
+	if (!log || !own_ring) return;
+	__atomic_store_n(&(own_ring->owned), 0, __ATOMIC_RELEASE);
+	own_ring = NULL;
+}
+
+size_t
+LogRecord_Format(const log_record_t* record, const char* path, char* buf, size_t size)
+{
+	int len = 0;
+
+	switch ((log_event_t) record->event)
+	{
+		case LOG_OPEN:
+			len = snprintf(buf, size, "[%d] openFile %s %d : %d.\n", record->thread, path, record->flags,
+						record->status);
+			break;
+
+		case LOG_OPEN_CREATE:
+			len = snprintf(buf, size, "[%d] openFile %s %d : %d.\n\tVictims : %lu.\n", record->thread, path,
+						record->flags, record->status, record->count);
+			break;
+
+		case LOG_CLOSE:
+			len = snprintf(buf, size, "[%d] closeFile %s : %d.\n", record->thread, path, record->status);
+			break;
+
+		case LOG_READ:
+			len = snprintf(buf, size, "[%d] readFile %s%s: %d -> %lu.\n", record->thread, path,
+						(record->flags == READ_CONTENTS) ? " " : " NULL", record->status, record->bytes);
+			break;
+
+		case LOG_READ_RANGE:
+			len = snprintf(buf, size, "[%d] readFileRange %s %lu %lu : %d -> %lu.\n", record->thread, path,
+						record->args[0], record->args[1], record->status, record->bytes);
+			break;
+
+		case LOG_STAT:
+			len = snprintf(buf, size, "[%d] statFile %s : %d -> %lu.\n", record->thread, path, record->status,
+						record->bytes);
+			break;
+
+		case LOG_RESERVE:
+			len = snprintf(buf, size, "[%d] reserveFile %s : %d -> %lu.\n\tVictims : %lu.\n", record->thread, path,
+						record->status, record->bytes, record->count);
+			break;
+
+		case LOG_WRITE:
+			len = snprintf(buf, size, "[%d] writeFile %s : %d -> %lu.\n\tVictims : %lu.\n", record->thread, path,
+						record->status, record->bytes, record->count);
+			break;
+
+		case LOG_APPEND:
+			len = snprintf(buf, size, "[%d] appendToFile %s : %d -> %lu.\n\tVictims : %lu.\n", record->thread, path,
+						record->status, record->bytes, record->count);
+			break;
+
+		case LOG_READ_N:
+			len = snprintf(buf, size, "[%d] readNFiles %lu %s : %d -> %lu.\n", record->thread, record->args[0], path,
+						record->status, record->bytes);
+			break;
+
+		case LOG_LIST:
+			len = snprintf(buf, size, "[%d] listFiles %s : %d -> %lu.\n", record->thread, path, record->status,
+						record->bytes);
+			break;
+
+		case LOG_LOCK_WAIT:
+			// not a request of its own: the lockFile line is written once the lock is granted
+			len = snprintf(buf, size, "Client %d waiting for lock on %s.\n", record->fd, path);
+			break;
+
+		case LOG_LOCK:
+			len = snprintf(buf, size, "[%d] lockFile %s %d : %d.\n", record->thread, path, record->flags,
+						record->status);
+			break;
+
+		case LOG_UNLOCK:
+			len = snprintf(buf, size, "[%d] unlockFile %s %d : %d.\n", record->thread, path, record->flags,
+						record->status);
+			break;
+
+		case LOG_REMOVE:
+			len = snprintf(buf, size, "[%d] removeFile %s : %d.\n", record->thread, path, record->status);
+			break;
+
+		case LOG_BATCH:
+			len = snprintf(buf, size, "Batch received from %d : %lu requests.\n", record->fd, record->args[0]);
+			break;
+
+		case LOG_UPLOAD_LEFT:
+			len = snprintf(buf, size, "[%d] Client %d left while sending %s.\n", record->thread, record->fd, path);
+			break;
+
+		case LOG_PAYLOAD_LEFT:
+			len = snprintf(buf, size, "[%d] Client %d left while sending a file.\n", record->thread, record->fd);
+			break;
+
+		case LOG_VICTIM:
+			len = snprintf(buf, size, "\tVictim name: %s.\n", path);
+			break;
+
+		case LOG_CLIENT_ACCEPTED:
+			len = snprintf(buf, size, "New client accepted : %d.\n", record->fd);
+			break;
+
+		case LOG_ONLINE_CLIENTS:
+			len = snprintf(buf, size, "Current online clients : %lu.\n", record->count);
+			break;
+
+		case LOG_CLIENT_LEFT:
+			len = snprintf(buf, size, "Client left %d.\n", record->fd);
+			break;
+
+		case LOG_WORKER_REPLIES:
+			len = snprintf(buf, size, "Worker replies : %lu, writes : %lu.\n", record->args[0], record->args[1]);
+			break;
+
+		case LOG_RESIZE_FAILED:
+			len = snprintf(buf, size, "Workers of reactor %d not resized : pthread_create failed with %d.\n",
+						record->fd, record->status);
+			break;
+
+		case LOG_SCALE_UP:
+			len = snprintf(buf, size, "Workers of reactor %d resized : %lu -> %lu, average wait : %lu us, "
+						"queued clients : %lu.\n", record->fd, record->args[0], record->args[1], record->bytes,
+						record->count);
+			break;
+
+		case LOG_SCALE_DOWN:
+			len = snprintf(buf, size, "Workers of reactor %d resized : %lu -> %lu, idle for : %lu ms.\n",
+						record->fd, record->args[0], record->args[1], record->bytes);
+			break;
+
+		case LOG_MAX_SIZE:
+			len = snprintf(buf, size, "Maximum size reached : %5f.\n", record->bytes * MBYTE);
+			break;
+
+		case LOG_MAX_FILES:
+			len = snprintf(buf, size, "Maximum file number : %lu.\n", record->count);
+			break;
+
+		case LOG_DROPPED:
+			len = snprintf(buf, size, "Log records dropped : %lu.\n", record->count);
+			break;
+	}
+	return (len < 0) ? 0 : (size_t) len;
+}
+
+void
+EventLog_Free(event_log_t* log)
+{
+	if (!log) return;
+	struct log_ring* ring;
+	struct log_ring* next;
+	log_record_t dropped;
+
+	pthread_mutex_lock(&(log->mutex));
+	__atomic_store_n(&(log->stop), 1, __ATOMIC_RELEASE);
+	pthread_cond_signal(&(log->wake));
+	pthread_mutex_unlock(&(log->mutex));
+	pthread_join(log->flusher, NULL);
+
+	memset(&dropped, 0, sizeof(log_record_t));
+	dropped.event = LOG_DROPPED;
+	for (ring = log->rings; ring; ring = ring->next)
+		dropped.count += ring->dropped;
+	if (dropped.count != 0)
+	{
+		if (log->format == LOG_BINARY) log->batch_len += batch_entry(log, &dropped, NULL);
+		else log->batch_len = LogRecord_Format(&dropped, NULL, log->batch, LINE_LEN);
+		batch_write(log);
+	}
+	fflush(log->file);
+	for (ring = log->rings; ring; ring = next)
+	{
+		next = ring->next;
+		free(ring->records);
+		free(ring->paths);
+		free(ring);
+	}
+	own_ring = NULL;
+	pthread_cond_destroy(&(log->flushed));
+	pthread_cond_destroy(&(log->wake));
+	pthread_mutex_destroy(&(log->mutex));
+	free(log->batch);
+	free(log);
+}
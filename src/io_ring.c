@@ -0,0 +1,293 @@
+/**
+ * @brief Source file for io_ring header.
+ * @author Giacomo Trapani.
+*/
+#define _GNU_SOURCE // syscall
+#include <errno.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include <io_ring.h>
+
+struct _io_ring
+{
+	int fd; // ring's file descriptor
+
+	// submission queue
+	unsigned* sq_head; // first entry yet to be consumed by the kernel
+	unsigned* sq_tail; // first free entry
+	unsigned* sq_mask;
+	unsigned* sq_array; // indexes of submitted entries
+	struct io_uring_sqe* sqes; // actual entries
+	unsigned sq_entries; // number of entries
+	unsigned prepared; // number of entries prepared since last submission
+	pthread_mutex_t mutex; // used to guarantee mutual exclusion over submission queue
+
+	// completion queue
+	unsigned* cq_head; // first entry yet to be consumed
+	unsigned* cq_tail; // first entry yet to be filled by the kernel
+	unsigned* cq_mask;
+	struct io_uring_cqe* cqes; // actual entries
+
+	// mapped areas
+	void* sq_ptr; size_t sq_len;
+	void* cq_ptr; size_t cq_len;
+	size_t sqes_len;
+};
+
+/**
+ * @brief Submits given number of entries, optionally waiting for completions.
+ * @returns Number of submitted entries on success, -1 on failure.
+*/
+static int
+ring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	int res;
+	do
+		res = (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+	while (res == -1 && errno == EINTR);
+	return res;
+}
+
+/**
+ * @brief Gets a free submission entry. Ring's mutex is to be held by callee.
+ * @returns Pointer to cleared entry on success, NULL on failure.
+*/
+static struct io_uring_sqe*
+get_sqe(io_ring_t* ring)
+{
+	unsigned tail = *(ring->sq_tail);
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	// queue is full: prepared entries are flushed first
+	if (tail - head == ring->sq_entries)
+	{
+		int submitted = ring_enter(ring->fd, ring->prepared, 0, 0);
+		if (submitted == -1) return NULL;
+		ring->prepared -= (unsigned) submitted;
+		if (submitted == 0)
+		{
+			errno = EBUSY;
+			return NULL;
+		}
+	}
+	struct io_uring_sqe* sqe = &(ring->sqes[tail & *(ring->sq_mask)]);
+	memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+/**
+ * @brief Publishes last entry gotten from "get_sqe". Ring's mutex is to be held by callee.
+*/
+static void
+push_sqe(io_ring_t* ring)
+{
+	unsigned tail = *(ring->sq_tail);
+	ring->sq_array[tail & *(ring->sq_mask)] = tail & *(ring->sq_mask);
+	// entry must be visible before the tail is moved
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->prepared++;
+}
+
+io_ring_t*
+IoRing_Init(unsigned entries)
+{
+	if (entries == 0)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	int errnocopy;
+	struct io_uring_params params;
+	io_ring_t* tmp = (io_ring_t*) malloc(sizeof(io_ring_t));
+	if (!tmp) return NULL;
+	memset(tmp, 0, sizeof(io_ring_t));
+	tmp->sq_ptr = MAP_FAILED; tmp->cq_ptr = MAP_FAILED; tmp->sqes = MAP_FAILED;
+
+	memset(&params, 0, sizeof(params));
+	tmp->fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+	if (tmp->fd == -1) goto failure;
+
+	tmp->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	tmp->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	// recent kernels map both queues at once
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (tmp->cq_len > tmp->sq_len) tmp->sq_len = tmp->cq_len;
+		tmp->cq_len = tmp->sq_len;
+	}
+	tmp->sq_ptr = mmap(NULL, tmp->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, tmp->fd, IORING_OFF_SQ_RING);
+	if (tmp->sq_ptr == MAP_FAILED) goto failure;
+	if (params.features & IORING_FEAT_SINGLE_MMAP) tmp->cq_ptr = tmp->sq_ptr;
+	else
+	{
+		tmp->cq_ptr = mmap(NULL, tmp->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, tmp->fd, IORING_OFF_CQ_RING);
+		if (tmp->cq_ptr == MAP_FAILED) goto failure;
+	}
+	tmp->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+	tmp->sqes = (struct io_uring_sqe*) mmap(NULL, tmp->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				tmp->fd, IORING_OFF_SQES);
+	if (tmp->sqes == MAP_FAILED) goto failure;
+
+	tmp->sq_head = (unsigned*) ((char*) tmp->sq_ptr + params.sq_off.head);
+	tmp->sq_tail = (unsigned*) ((char*) tmp->sq_ptr + params.sq_off.tail);
+	tmp->sq_mask = (unsigned*) ((char*) tmp->sq_ptr + params.sq_off.ring_mask);
+	tmp->sq_array = (unsigned*) ((char*) tmp->sq_ptr + params.sq_off.array);
+	tmp->sq_entries = params.sq_entries;
+	tmp->cq_head = (unsigned*) ((char*) tmp->cq_ptr + params.cq_off.head);
+	tmp->cq_tail = (unsigned*) ((char*) tmp->cq_ptr + params.cq_off.tail);
+	tmp->cq_mask = (unsigned*) ((char*) tmp->cq_ptr + params.cq_off.ring_mask);
+	tmp->cqes = (struct io_uring_cqe*) ((char*) tmp->cq_ptr + params.cq_off.cqes);
+	tmp->prepared = 0;
+
+	errno = pthread_mutex_init(&(tmp->mutex), NULL);
+	if (errno != 0) goto failure;
+
+	return tmp;
+
+	failure:
+		errnocopy = errno;
+		if (tmp->sqes != MAP_FAILED) munmap(tmp->sqes, tmp->sqes_len);
+		if (tmp->cq_ptr != MAP_FAILED && tmp->cq_ptr != tmp->sq_ptr) munmap(tmp->cq_ptr, tmp->cq_len);
+		if (tmp->sq_ptr != MAP_FAILED) munmap(tmp->sq_ptr, tmp->sq_len);
+		if (tmp->fd != -1) close(tmp->fd);
+		free(tmp);
+		errno = errnocopy;
+		return NULL;
+}
+
+int
+IoRing_PrepareRecv(io_ring_t* ring, int fd, void* buf, size_t size, uint64_t user_data)
+{
+	if (!ring || !buf)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	struct io_uring_sqe* sqe;
+	int errnocopy;
+
+	if ((errno = pthread_mutex_lock(&(ring->mutex))) != 0) return -1;
+	sqe = get_sqe(ring);
+	if (!sqe)
+	{
+		errnocopy = errno;
+		pthread_mutex_unlock(&(ring->mutex));
+		errno = errnocopy;
+		return -1;
+	}
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t) (uintptr_t) buf;
+	sqe->len = (uint32_t) size;
+	sqe->user_data = user_data;
+	push_sqe(ring);
+	if ((errno = pthread_mutex_unlock(&(ring->mutex))) != 0) return -1;
+	return 0;
+}
+
+int
+IoRing_PreparePoll(io_ring_t* ring, int fd, short events, uint64_t user_data)
+{
+	if (!ring)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	struct io_uring_sqe* sqe;
+	int errnocopy;
+
+	if ((errno = pthread_mutex_lock(&(ring->mutex))) != 0) return -1;
+	sqe = get_sqe(ring);
+	if (!sqe)
+	{
+		errnocopy = errno;
+		pthread_mutex_unlock(&(ring->mutex));
+		errno = errnocopy;
+		return -1;
+	}
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = (uint32_t) (unsigned short) events;
+	sqe->user_data = user_data;
+	push_sqe(ring);
+	if ((errno = pthread_mutex_unlock(&(ring->mutex))) != 0) return -1;
+	return 0;
+}
+
+int
+IoRing_Submit(io_ring_t* ring)
+{
+	if (!ring)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	int err = 0, errnocopy = 0;
+
+	if ((errno = pthread_mutex_lock(&(ring->mutex))) != 0) return -1;
+	if (ring->prepared != 0)
+	{
+		err = ring_enter(ring->fd, ring->prepared, 0, 0);
+		errnocopy = errno;
+		// entries which have not been consumed yet are submitted along with the next ones
+		if (err != -1) ring->prepared -= (unsigned) err;
+	}
+	if ((errno = pthread_mutex_unlock(&(ring->mutex))) != 0) return -1;
+	if (err == -1)
+	{
+		errno = errnocopy;
+		return -1;
+	}
+	return 0;
+}
+
+int
+IoRing_WaitCompletions(io_ring_t* ring, io_ring_completion_t* completions, unsigned max)
+{
+	if (!ring || !completions || max == 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	unsigned head = *(ring->cq_head);
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	unsigned i = 0;
+
+	// nothing has completed yet
+	while (head == tail)
+	{
+		if (ring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) == -1) return -1;
+		tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	}
+	while (head != tail && i < max)
+	{
+		completions[i].user_data = ring->cqes[head & *(ring->cq_mask)].user_data;
+		completions[i].res = ring->cqes[head & *(ring->cq_mask)].res;
+		head++; i++;
+	}
+	// entries may be reused by the kernel as soon as the head is moved
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	return (int) i;
+}
+
+void
+IoRing_Free(io_ring_t* ring)
+{
+	if (!ring) return;
+	pthread_mutex_destroy(&(ring->mutex));
+	munmap(ring->sqes, ring->sqes_len);
+	if (ring->cq_ptr != ring->sq_ptr) munmap(ring->cq_ptr, ring->cq_len);
+	munmap(ring->sq_ptr, ring->sq_len);
+	close(ring->fd);
+	free(ring);
+}
@@ -0,0 +1,569 @@
+/**
+ * @brief Reads a binary log written by the server and either sums it up or renders it as text.
+ * Log is memory-mapped and split among threads along its blocks: each thread goes through its share once,
+ * their stats are merged at last.
+ * @author Giacomo Trapani.
+*/
+
+#define _POSIX_C_SOURCE 200809L // getopt, posix_madvise
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <event_log.h>
+#include <wrappers.h>
+
+#define REQUEST_EVENTS LOG_VICTIM // events lower than this one are requests
+#define EVENTS (LOG_DROPPED + 1)
+#define SUB_BUCKETS_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKETS_BITS) // buckets each power of two is split into: latencies are off by 6.25% at most
+#define BUCKETS (64 * SUB_BUCKETS)
+#define THREADS_CAPACITY 64 // initial capacity of the table of threads, a power of two
+#define TEXT_LEN (1 << 20) // bytes of text written to stdout at once
+#define LINE_LEN (REQUESTLEN + 256) // longest line a record is rendered as
+
+// Log-linear histogram of latencies, in nanoseconds.
+struct histogram
+{
+	uint64_t counts[BUCKETS];
+	uint64_t max;
+};
+
+// Requests logged by a single thread of the server.
+struct thread_stats
+{
+	int32_t thread;
+	bool used; // toggled on when slot holds a thread
+	uint64_t requests;
+	uint64_t busy; // sum of the latencies of its requests
+};
+
+// Stats of a share of the log: those of every share are merged into the first one.
+struct stats
+{
+	uint64_t events[EVENTS]; // records logged for each event
+	uint64_t failed[REQUEST_EVENTS]; // requests whose outcome has been negative
+	uint64_t bytes[REQUEST_EVENTS]; // bytes moved by requests
+	struct histogram latency[REQUEST_EVENTS];
+	uint64_t evictions; // requests which have evicted at least one file
+	uint64_t victims; // files evicted
+	uint64_t max_clients; // maximum number of clients online at once
+	uint64_t max_size; // maximum storage size reached, in bytes
+	uint64_t max_files; // maximum number of files stored at once
+	uint64_t replies; // replies sent by workers
+	uint64_t writes; // writes replies have been sent with
+	uint64_t dropped; // records dropped because their thread's ring was full
+	uint64_t first; // earliest time found in the log
+	uint64_t last; // latest time found in the log
+	uint64_t corrupted; // blocks which have been skipped
+	struct thread_stats* threads; // open addressing table of threads
+	size_t threads_capacity;
+	size_t threads_no;
+};
+
+// Share of the log a thread goes through.
+struct share
+{
+	const char* log; // mapped log
+	const size_t* blocks; // offsets of the blocks of the log
+	size_t first; // first block of the share
+	size_t last; // block following the last one of the share
+	struct stats stats;
+};
+
+static const char* event_names[REQUEST_EVENTS] =
+{
+	[LOG_OPEN] = "openFile",
+	[LOG_OPEN_CREATE] = "openFile (create)",
+	[LOG_CLOSE] = "closeFile",
+	[LOG_READ] = "readFile",
+	[LOG_READ_RANGE] = "readFileRange",
+	[LOG_STAT] = "statFile",
+	[LOG_RESERVE] = "reserveFile",
+	[LOG_WRITE] = "writeFile",
+	[LOG_APPEND] = "appendToFile",
+	[LOG_READ_N] = "readNFiles",
+	[LOG_LIST] = "listFiles",
+	[LOG_LOCK_WAIT] = "lockFile (waiting)",
+	[LOG_LOCK] = "lockFile",
+	[LOG_UNLOCK] = "unlockFile",
+	[LOG_REMOVE] = "removeFile",
+	[LOG_BATCH] = "batch",
+	[LOG_UPLOAD_LEFT] = "left uploading",
+	[LOG_PAYLOAD_LEFT] = "left sending",
+};
+
+/**
+ * @brief Gets bucket given latency is counted in: values lower than SUB_BUCKETS have their own,
+ * every power of two above is split into SUB_BUCKETS buckets.
+*/
+static inline size_t
+bucket_of(uint64_t value)
+{
+	int shift;
+
+	if (value < SUB_BUCKETS) return (size_t) value;
+	shift = 63 - __builtin_clzll(value) - SUB_BUCKETS_BITS;
+	return (size_t) (shift + 1) * SUB_BUCKETS + (size_t) ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Gets highest latency counted in given bucket.
+*/
+static inline uint64_t
+bucket_top(size_t bucket)
+{
+	int shift;
+
+	if (bucket < SUB_BUCKETS) return (uint64_t) bucket;
+	shift = (int) (bucket / SUB_BUCKETS) - 1;
+	return (((uint64_t) SUB_BUCKETS + bucket % SUB_BUCKETS + 1) << shift) - 1;
+}
+
+/**
+ * @brief Gets latency given fraction of the counted ones does not exceed.
+*/
+static uint64_t
+percentile(const struct histogram* histogram, uint64_t total, double fraction)
+{
+	uint64_t rank = (uint64_t) (fraction * (double) total + 0.999999);
+	uint64_t seen = 0;
+
+	if (rank == 0) rank = 1;
+	for (size_t i = 0; i < BUCKETS; i++)
+	{
+		seen += histogram->counts[i];
+		// bucket's top may lie above the highest latency itself
+		if (seen >= rank) return MIN(bucket_top(i), histogram->max);
+	}
+	return histogram->max;
+}
+
+/**
+ * @brief Gets the slot of given thread in the table, taking a free one if it has yet to be met.
+ * @returns Slot on success, NULL on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routine "calloc".
+*/
+static struct thread_stats*
+thread_slot(struct stats* stats, int32_t thread)
+{
+	struct thread_stats* old = stats->threads;
+	size_t old_capacity = stats->threads_capacity;
+	size_t i;
+
+	// table is kept at most half full
+	if (2 * (stats->threads_no + 1) > stats->threads_capacity)
+	{
+		stats->threads_capacity = (old_capacity == 0) ? THREADS_CAPACITY : 2 * old_capacity;
+		stats->threads = (struct thread_stats*) calloc(stats->threads_capacity, sizeof(struct thread_stats));
+		if (!stats->threads)
+		{
+			stats->threads = old;
+			stats->threads_capacity = old_capacity;
+			return NULL;
+		}
+		stats->threads_no = 0;
+		for (i = 0; i < old_capacity; i++)
+		{
+			if (!old[i].used) continue;
+			*thread_slot(stats, old[i].thread) = old[i];
+		}
+		free(old);
+	}
+	for (i = (uint32_t) thread * 2654435761u & (stats->threads_capacity - 1); stats->threads[i].used;
+			i = (i + 1) & (stats->threads_capacity - 1))
+		if (stats->threads[i].thread == thread) return &(stats->threads[i]);
+	stats->threads[i].used = true;
+	stats->threads[i].thread = thread;
+	stats->threads_no++;
+	return &(stats->threads[i]);
+}
+
+/**
+ * @brief Accounts for given record.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routine "calloc".
+*/
+static int
+account(struct stats* stats, const log_record_t* record)
+{
+	struct thread_stats* thread;
+	uint64_t latency;
+
+	stats->events[record->event]++;
+	if (record->timestamp > stats->last) stats->last = record->timestamp;
+	if (record->event < REQUEST_EVENTS)
+	{
+		latency = (record->started != 0 && record->started <= record->timestamp)
+				? record->timestamp - record->started : 0;
+		if (record->started != 0 && record->started < stats->first) stats->first = record->started;
+		if (record->status < 0) stats->failed[record->event]++;
+		stats->bytes[record->event] += record->bytes;
+		stats->latency[record->event].counts[bucket_of(latency)]++;
+		if (latency > stats->latency[record->event].max) stats->latency[record->event].max = latency;
+		if (record->count != 0)
+		{
+			stats->evictions++;
+			stats->victims += record->count;
+		}
+		if (!(thread = thread_slot(stats, record->thread))) return -1;
+		thread->requests++;
+		thread->busy += latency;
+		return 0;
+	}
+	if (record->timestamp < stats->first) stats->first = record->timestamp;
+	switch ((log_event_t) record->event)
+	{
+		case LOG_ONLINE_CLIENTS:
+			stats->max_clients = MAX(stats->max_clients, record->count);
+			break;
+
+		case LOG_WORKER_REPLIES:
+			stats->replies += record->args[0];
+			stats->writes += record->args[1];
+			break;
+
+		case LOG_MAX_SIZE:
+			stats->max_size = MAX(stats->max_size, record->bytes);
+			break;
+
+		case LOG_MAX_FILES:
+			stats->max_files = MAX(stats->max_files, record->count);
+			break;
+
+		case LOG_DROPPED:
+			stats->dropped += record->count;
+			break;
+
+		default:
+			break;
+	}
+	return 0;
+}
+
+/**
+ * @brief Tells whether given entry lies within given bounds and holds a valid record.
+*/
+static inline bool
+valid_entry(const char* entry, const char* end)
+{
+	const log_record_t* record = (const log_record_t*) entry;
+
+	return (size_t) (end - entry) >= sizeof(log_record_t) && record->event <= LOG_DROPPED
+			&& record->path_len < REQUESTLEN && (size_t) (end - entry) >= LOG_ENTRY_SIZE(record->path_len);
+}
+
+/**
+ * @brief Thread goes through every entry of its share of the log.
+ * @returns NULL on success, its share on failure.
+*/
+static void*
+share_routine(void* arg)
+{
+	struct share* share = (struct share*) arg;
+	const log_block_t* block;
+	const char* entry;
+	const char* end;
+
+	for (size_t i = share->first; i < share->last; i++)
+	{
+		block = (const log_block_t*) (share->log + share->blocks[i]);
+		entry = (const char*) (block + 1);
+		end = entry + block->length;
+		for (uint32_t j = 0; j < block->records; j++)
+		{
+			// the rest of a corrupted block is skipped
+			if (!valid_entry(entry, end))
+			{
+				share->stats.corrupted++;
+				break;
+			}
+			if (account(&(share->stats), (const log_record_t*) entry) == -1) return share;
+			entry += LOG_ENTRY_SIZE(((const log_record_t*) entry)->path_len);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Merges the stats of a share into given ones.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routine "calloc".
+*/
+static int
+merge(struct stats* into, const struct stats* from)
+{
+	struct thread_stats* thread;
+
+	for (size_t i = 0; i < EVENTS; i++)
+		into->events[i] += from->events[i];
+	for (size_t i = 0; i < REQUEST_EVENTS; i++)
+	{
+		into->failed[i] += from->failed[i];
+		into->bytes[i] += from->bytes[i];
+		for (size_t j = 0; j < BUCKETS; j++)
+			into->latency[i].counts[j] += from->latency[i].counts[j];
+		into->latency[i].max = MAX(into->latency[i].max, from->latency[i].max);
+	}
+	into->evictions += from->evictions;
+	into->victims += from->victims;
+	into->max_clients = MAX(into->max_clients, from->max_clients);
+	into->max_size = MAX(into->max_size, from->max_size);
+	into->max_files = MAX(into->max_files, from->max_files);
+	into->replies += from->replies;
+	into->writes += from->writes;
+	into->dropped += from->dropped;
+	into->first = MIN(into->first, from->first);
+	into->last = MAX(into->last, from->last);
+	into->corrupted += from->corrupted;
+	for (size_t i = 0; i < from->threads_capacity; i++)
+	{
+		if (!from->threads[i].used) continue;
+		if (!(thread = thread_slot(into, from->threads[i].thread))) return -1;
+		thread->requests += from->threads[i].requests;
+		thread->busy += from->threads[i].busy;
+	}
+	return 0;
+}
+
+/**
+ * @brief Prints given stats.
+ * @param sampling is the rate requests have been sampled at.
+*/
+static void
+print_stats(const struct stats* stats, uint32_t sampling)
+{
+	uint64_t requests = 0;
+	double seconds = (stats->last > stats->first) ? (double) (stats->last - stats->first) / 1e9 : 0;
+	const struct histogram* histogram;
+	uint64_t count;
+
+	for (size_t i = 0; i < REQUEST_EVENTS; i++)
+		requests += stats->events[i];
+	printf("REQUESTS\n");
+	printf("\tLogged requests : %lu over %.3f s", requests, seconds);
+	if (seconds > 0) printf(" (%.1f requests/s)", (double) requests / seconds);
+	printf(".\n");
+	if (sampling > 1) printf("\tEach thread has logged one request in %u : figures are to be scaled by it.\n", sampling);
+	if (stats->dropped != 0) printf("\tRecords dropped : %lu.\n", stats->dropped);
+	if (stats->corrupted != 0) printf("\tCorrupted blocks skipped : %lu.\n", stats->corrupted);
+	printf("\t%-20s %10s %8s %14s %12s %10s %10s %10s %10s %10s\n", "Operation", "Count", "Failed", "Bytes",
+			"Mean bytes", "p50 (us)", "p90 (us)", "p99 (us)", "p99.9 (us)", "max (us)");
+	for (size_t i = 0; i < REQUEST_EVENTS; i++)
+	{
+		if ((count = stats->events[i]) == 0) continue;
+		histogram = &(stats->latency[i]);
+		printf("\t%-20s %10lu %8lu %14lu %12.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", event_names[i], count,
+				stats->failed[i], stats->bytes[i], (double) stats->bytes[i] / (double) count,
+				percentile(histogram, count, 0.5) / 1e3, percentile(histogram, count, 0.9) / 1e3,
+				percentile(histogram, count, 0.99) / 1e3, percentile(histogram, count, 0.999) / 1e3,
+				histogram->max / 1e3);
+	}
+
+	printf("REQUESTS HANDLED PER WORKER ID\n");
+	for (size_t i = 0; i < stats->threads_capacity; i++)
+	{
+		if (!stats->threads[i].used) continue;
+		printf("\tID %d - %lu [REQUESTS], busy for %.3f ms.\n", stats->threads[i].thread,
+				stats->threads[i].requests, stats->threads[i].busy / 1e6);
+	}
+
+	printf("STORAGE DATA\n");
+	printf("\tMaximum online clients : %lu.\n", stats->max_clients);
+	printf("\tReplacement algorithm got triggered : %lu time(s), evicting %lu file(s).\n", stats->evictions,
+			stats->victims);
+	printf("\tMaximum reached size : %.3f [MB].\n", stats->max_size * MBYTE);
+	printf("\tMaximum files stored : %lu.\n", stats->max_files);
+
+	printf("REPLIES SENT\n");
+	printf("\tReplies : %lu.\n", stats->replies);
+	printf("\tWrites : %lu.\n", stats->writes);
+	if (stats->replies != 0) printf("\tMean writes per reply : %.3f.\n", (double) stats->writes / stats->replies);
+}
+
+/**
+ * @brief Renders every entry of given blocks as the server would have written it in a text log.
+ * @returns 0 on success, -1 on failure.
+*/
+static int
+render_text(const char* log, const size_t* blocks, size_t blocks_no)
+{
+	char* text = (char*) malloc(TEXT_LEN);
+	size_t text_len = 0;
+	char path[REQUESTLEN];
+	const log_block_t* block;
+	const log_record_t* record;
+	const char* entry;
+	const char* end;
+
+	if (!text) return -1;
+	for (size_t i = 0; i < blocks_no; i++)
+	{
+		block = (const log_block_t*) (log + blocks[i]);
+		entry = (const char*) (block + 1);
+		end = entry + block->length;
+		for (uint32_t j = 0; j < block->records && valid_entry(entry, end); j++)
+		{
+			record = (const log_record_t*) entry;
+			memcpy(path, entry + sizeof(log_record_t), record->path_len);
+			path[record->path_len] = '\0';
+			if (TEXT_LEN - text_len < LINE_LEN)
+			{
+				if (fwrite(text, 1, text_len, stdout) != text_len) goto failure;
+				text_len = 0;
+			}
+			text_len += MIN(LogRecord_Format(record, path, text + text_len, LINE_LEN), LINE_LEN - 1);
+			entry += LOG_ENTRY_SIZE(record->path_len);
+		}
+	}
+	if (fwrite(text, 1, text_len, stdout) != text_len) goto failure;
+	free(text);
+	return 0;
+
+	failure:
+		free(text);
+		return -1;
+}
+
+int
+main(int argc, char* argv[])
+{
+	long threads_no = sysconf(_SC_NPROCESSORS_ONLN); // threads going through the log
+	bool text = false; // toggled on when log is to be rendered as text
+	int opt;
+	int fd;
+	int err;
+	struct stat st;
+	char* log;
+	const log_file_header_t* header;
+	const log_block_t* block;
+	size_t offset;
+	size_t* blocks = NULL; // offsets of the blocks of the log
+	size_t blocks_no = 0;
+	size_t blocks_capacity = 0;
+	struct share* shares;
+	pthread_t* threads;
+	size_t target; // bytes each share should take
+	size_t next; // first block of the following share
+	void* failed_share;
+
+	while ((opt = getopt(argc, argv, "j:t")) != -1)
+	{
+		switch (opt)
+		{
+			case 'j':
+				threads_no = strtol(optarg, NULL, 10);
+				break;
+
+			case 't':
+				text = true;
+				break;
+
+			default:
+				threads_no = 0;
+				break;
+		}
+	}
+	if (optind != argc - 1 || threads_no <= 0)
+	{
+		fprintf(stderr, "Usage: %s [-j threads] [-t] log\n"
+				"\t-j : number of threads going through the log, it defaults to the number of online CPUs.\n"
+				"\t-t : log is rendered as text, as the server would have written it, instead of being summed up.\n",
+				argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	EXIT_IF_EQ(fd, -1, open(argv[optind], O_RDONLY), open);
+	EXIT_IF_EQ(err, -1, fstat(fd, &st), fstat);
+	if ((size_t) st.st_size < sizeof(log_file_header_t))
+	{
+		fprintf(stderr, "%s is not a binary log: text logs are read by scripts/statistiche.sh.\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+	EXIT_IF_EQ(log, MAP_FAILED, (char*) mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0), mmap);
+	close(fd);
+	posix_madvise(log, (size_t) st.st_size, POSIX_MADV_SEQUENTIAL);
+	header = (const log_file_header_t*) log;
+	if (memcmp(header->magic, LOG_FILE_MAGIC, sizeof(header->magic)) != 0)
+	{
+		fprintf(stderr, "%s is not a binary log: text logs are read by scripts/statistiche.sh.\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+	if (header->record_size != sizeof(log_record_t))
+	{
+		fprintf(stderr, "%s has been written by a different version of the server.\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	// blocks are found by hopping from a header to the following one: records are not gone through
+	for (offset = sizeof(log_file_header_t); offset + sizeof(log_block_t) <= (size_t) st.st_size;
+			offset += sizeof(log_block_t) + block->length)
+	{
+		block = (const log_block_t*) (log + offset);
+		if (block->magic != LOG_BLOCK_MAGIC || block->length > (size_t) st.st_size - offset - sizeof(log_block_t))
+			break;
+		if (blocks_no == blocks_capacity)
+		{
+			blocks_capacity = (blocks_capacity == 0) ? 1024 : 2 * blocks_capacity;
+			EXIT_IF_EQ(blocks, NULL, (size_t*) realloc(blocks, sizeof(size_t) * blocks_capacity), realloc);
+		}
+		blocks[blocks_no++] = offset;
+	}
+	// server may have been killed while writing its last block
+	if (offset != (size_t) st.st_size)
+		fprintf(stderr, "%s is truncated or corrupted : %lu bytes out of %lu are read.\n", argv[optind],
+				offset, (size_t) st.st_size);
+
+	if (text)
+	{
+		EXIT_IF_EQ(err, -1, render_text(log, blocks, blocks_no), fwrite);
+		free(blocks);
+		munmap(log, (size_t) st.st_size);
+		return 0;
+	}
+
+	// each thread takes about as many bytes as the others
+	if ((size_t) threads_no > blocks_no) threads_no = (blocks_no == 0) ? 1 : (long) blocks_no;
+	EXIT_IF_EQ(shares, NULL, (struct share*) calloc((size_t) threads_no, sizeof(struct share)), calloc);
+	EXIT_IF_EQ(threads, NULL, (pthread_t*) malloc(sizeof(pthread_t) * (size_t) threads_no), malloc);
+	target = (offset - sizeof(log_file_header_t)) / (size_t) threads_no;
+	next = 0;
+	for (long i = 0; i < threads_no; i++)
+	{
+		shares[i].log = log;
+		shares[i].blocks = blocks;
+		shares[i].first = next;
+		if (i == threads_no - 1) next = blocks_no;
+		else
+			while (next < blocks_no && blocks[next] - sizeof(log_file_header_t) < target * (size_t) (i + 1))
+				next++;
+		shares[i].last = next;
+		shares[i].stats.first = UINT64_MAX;
+		EXIT_IF_NEQ(err, 0, pthread_create(&(threads[i]), NULL, share_routine, (void*) &(shares[i])),
+				pthread_create);
+	}
+	for (long i = 0; i < threads_no; i++)
+	{
+		EXIT_IF_NEQ(err, 0, pthread_join(threads[i], &failed_share), pthread_join);
+		EXIT_IF_NEQ(failed_share, NULL, failed_share, calloc);
+		if (i != 0) EXIT_IF_EQ(err, -1, merge(&(shares[0].stats), &(shares[i].stats)), calloc);
+	}
+	print_stats(&(shares[0].stats), header->sampling);
+
+	for (long i = 0; i < threads_no; i++)
+		free(shares[i].stats.threads);
+	free(shares);
+	free(threads);
+	free(blocks);
+	munmap(log, (size_t) st.st_size);
+	return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @brief Microbenchmark of the tasks' queue: throughput and enqueue-to-dequeue latency
+ * for a varying number of producers and consumers.
+ * @author Giacomo Trapani.
+*/
+
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <task_queue.h>
+
+#define CAPACITY 4096 // same capacity as the server's queues
+#define DEFAULT_OPS (1 << 20) // values moved through the queue in each run
+#define STOP -1 // used to stop a consumer
+
+struct bench
+{
+	task_queue_t* queue;
+	uint64_t* stamps; // enqueue time of each value, overwritten with its latency as soon as it is dequeued
+};
+
+struct producer_args
+{
+	struct bench* bench;
+	int first; // first value to be enqueued
+	int last; // value following the last one to be enqueued
+};
+
+static uint64_t
+now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int
+compare_u64(const void* a, const void* b)
+{
+	uint64_t x = *((const uint64_t*) a), y = *((const uint64_t*) b);
+	return (x > y) - (x < y);
+}
+
+static void*
+producer_routine(void* arg)
+{
+	struct producer_args* args = (struct producer_args*) arg;
+	struct bench* bench = args->bench;
+
+	for (int i = args->first; i < args->last; i++)
+	{
+		bench->stamps[i] = now_ns();
+		if (TaskQueue_Enqueue(bench->queue, i) != 0)
+		{
+			perror("TaskQueue_Enqueue");
+			exit(EXIT_FAILURE);
+		}
+	}
+	return NULL;
+}
+
+static void*
+consumer_routine(void* arg)
+{
+	struct bench* bench = (struct bench*) arg;
+	int value;
+
+	while (1)
+	{
+		if (TaskQueue_Dequeue(bench->queue, &value) != 0)
+		{
+			perror("TaskQueue_Dequeue");
+			exit(EXIT_FAILURE);
+		}
+		if (value == STOP) break;
+		bench->stamps[value] = now_ns() - bench->stamps[value];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Moves given number of values through a fresh queue, then prints throughput and latency percentiles.
+*/
+static void
+run(int producers_no, int consumers_no, int ops)
+{
+	struct bench bench;
+	pthread_t* producers = (pthread_t*) malloc(sizeof(pthread_t) * producers_no);
+	pthread_t* consumers = (pthread_t*) malloc(sizeof(pthread_t) * consumers_no);
+	struct producer_args* args = (struct producer_args*) malloc(sizeof(struct producer_args) * producers_no);
+	uint64_t start, elapsed;
+
+	if (!producers || !consumers || !args)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	bench.queue = TaskQueue_Init(CAPACITY);
+	bench.stamps = (uint64_t*) calloc((size_t) ops, sizeof(uint64_t));
+	if (!bench.queue || !bench.stamps)
+	{
+		perror("TaskQueue_Init");
+		exit(EXIT_FAILURE);
+	}
+
+	start = now_ns();
+	for (int i = 0; i < consumers_no; i++)
+		pthread_create(&(consumers[i]), NULL, consumer_routine, (void*) &bench);
+	for (int i = 0; i < producers_no; i++)
+	{
+		args[i].bench = &bench;
+		args[i].first = (int) ((long) ops * i / producers_no);
+		args[i].last = (int) ((long) ops * (i + 1) / producers_no);
+		pthread_create(&(producers[i]), NULL, producer_routine, (void*) &(args[i]));
+	}
+	for (int i = 0; i < producers_no; i++)
+		pthread_join(producers[i], NULL);
+	for (int i = 0; i < consumers_no; i++)
+		TaskQueue_Enqueue(bench.queue, STOP);
+	for (int i = 0; i < consumers_no; i++)
+		pthread_join(consumers[i], NULL);
+	elapsed = now_ns() - start;
+
+	qsort(bench.stamps, (size_t) ops, sizeof(uint64_t), compare_u64);
+	printf("%9d %9d %14.0f %10lu %10lu %10lu\n", producers_no, consumers_no,
+			(double) ops * 1e9 / (double) elapsed,
+			bench.stamps[ops / 2], bench.stamps[(size_t) ((double) ops * 0.99)], bench.stamps[ops - 1]);
+
+	TaskQueue_Free(bench.queue);
+	free(bench.stamps);
+	free(args);
+	free(producers);
+	free(consumers);
+}
+
+int
+main(int argc, char* argv[])
+{
+	int ops = DEFAULT_OPS;
+	if (argc > 1) ops = atoi(argv[1]);
+	if (ops <= 0)
+	{
+		fprintf(stderr, "Usage: %s [values moved in each run]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	printf("%9s %9s %14s %10s %10s %10s\n", "producers", "consumers", "ops/sec", "p50 (ns)", "p99 (ns)", "max (ns)");
+	// as many producers as consumers
+	for (int threads = 1; threads <= 32; threads *= 2)
+		run(threads, threads, ops);
+	// a single producer, as a reactor feeding its workers
+	for (int threads = 2; threads <= 32; threads *= 2)
+		run(1, threads, ops);
+	return 0;
+}
@@ -2,68 +2,114 @@
  * @brief Server file.
  * @author Giacomo Trapani.
 */
-#define _POSIX_C_SOURCE 200112L
+#define _GNU_SOURCE // accept4, pthread_setaffinity_np
+#include <dirent.h>
+#include <limits.h>
+#include <poll.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <sys/un.h>
 #include <sys/socket.h>
-#include <sys/select.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <linux/mempolicy.h>
 #include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 
-#include <bounded_buffer.h>
 #include <config.h>
+#include <event_log.h>
+#include <io_ring.h>
 #include <server_defines.h>
 #include <storage.h>
+#include <task_queue.h>
 #include <utilities.h>
 #include <wrappers.h>
 
-#define MAXCONNECTIONS 10
-#define PIPEBUFFERLEN 10
-#define TASKLEN 32
+#define MAXEVENTS 64 // maximum number of events returned by a single epoll_wait
 #define MAXTASKS 4096
+#define REPLY_IOVECS 64 // maximum number of buffers gathered into a single write
+#define REPLY_BUFLEN 65536 // size of the buffer small parts of replies are copied into
+#define CONTROLLER_PERIOD 100 // milliseconds between two checks on workers' load
 
 #define TERMINATE_WORKER 0 // used to send a termination message
-#define CLIENT_LEFT "0"
+#define NUDGE_WORKER -1 // used to wake an idle worker up so that it steals tasks from its siblings
+#define SOCKET_WRITABLE (1ULL << 32) // flags the waits for a client's socket to be writable (USED BY io_uring backend)
+#define LOCK_STRIPES 64 // number of lists clients waiting for a file's lock are spread over
+#define BIND_THRESHOLD 131072 // smallest payload bound to a NUMA node: malloc maps payloads this large on their own
 
 /**
- * Used in worker routine to proceed to next iteration.
-*/
-#define NEXT_ITERATION \
-{ \
-	free(fd_ready_string); \
-	continue; \
-}
-
-/**
- * Used in worker routine to send a completion message as soon as a worker is done with a task.
+ * Used in worker routine as soon as a worker is done with a task: if client's next request has already been
+ * fully received, it is served right away, otherwise client is monitored again.
+ * Request is charged to client's credit: clients which have used it up, have had too many requests served
+ * since their replies were last sent or have replies the socket has not taken yet, yield to the others.
+ * Metadata workers hand clients whose next request is not a metadata one to the other workers, and workers hand
+ * clients whose next request is to be served on another NUMA node to that node's workers.
 */
 #define REQUEST_DONE \
 { \
-	memset(pipe_buffer, 0, PIPEBUFFERLEN); \
-	snprintf(pipe_buffer, PIPEBUFFERLEN, "%d", fd_ready); \
-	EXIT_IF_EQ(err, -1, writen((long) pipe_output_channel, (void*) pipe_buffer, PIPEBUFFERLEN), writen); \
+	pipelined = next_request_received(connection); \
+	if (connection->batched != 0) connection->batched--; \
+	connection->deficit -= (int64_t) (REQUESTLEN + req.size + reply.bytes_no - gathered); \
+	gathered = reply.bytes_no; \
+	served++; \
+	if (pipelined && (connection->deficit <= 0 || served >= workers_args->client_in_flight \
+				|| connection->output_no != 0 || (self->metadata && !is_metadata_request(workers_args, fd_ready)) \
+				|| home_reactor(workers_args, fd_ready) != workers_args)) \
+	{ \
+		reply_flush(&reply); \
+		if (connection->output_no == 0) schedule_client(workers_args, fd_ready); \
+		else monitor_client(connection->reactor_args, fd_ready, false); \
+		pipelined = false; \
+	} \
+	else if (!pipelined) \
+	{ \
+		reply_flush(&reply); \
+		connection->deficit = 0; \
+		monitor_client(connection->reactor_args, fd_ready, false); \
+	} \
 	break; \
 }
 
 /**
- * Used to write to log in mutual exclusion.
+ * Used to append a record to the log without waiting for any other thread: fields which are not given are left to 0,
+ * path is NULL if record refers to none.
 */
-#define LOG_EVENT(...) \
+#define LOG_EVENT(path, ...) \
 do \
 { \
-	if (pthread_mutex_lock(&log_mutex) != 0) { perror("pthread_mutex_lock"); exit(1); } \
-	fprintf(log_file, __VA_ARGS__); \
-	if (pthread_mutex_unlock(&log_mutex) != 0) { perror("pthread_mutex_unlock"); exit(1); } \
+	log_record_t log_record = { __VA_ARGS__ }; \
+	if (EventLog_Append(event_log, &log_record, path) != 0) { perror("EventLog_Append"); exit(1); } \
 } while(0);
 
+/**
+ * Used by workers to log the request being served: the time it started being served at is logged along with it,
+ * so that its latency may be told.
+*/
+#define LOG_REQUEST(path, ...) LOG_EVENT(path, .started = started, __VA_ARGS__)
+
 volatile sig_atomic_t terminate = 0; // toggled on when server should terminate as soon as possible
 volatile sig_atomic_t no_more_clients = 0; // toggled on when server must not accept any other client
 
-pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER; // mutex for log file
+/**
+ * @brief Gets current time, as given by a monotonic clock, in nanoseconds.
+*/
+static inline uint64_t
+now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
 
 /**
  * @brief All worker threads work following the very same logic. At first, it is checked whether the descriptor
@@ -74,6 +120,23 @@ pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER; // mutex for log file
 static void*
 worker_routine(void*);
 
+/**
+ * @brief Each reactor thread monitors its own slice of clients and hands ready ones to its own group of workers:
+ * it receives whatever they send without waiting, so that workers only get fully received requests,
+ * and sends the replies workers could not send without waiting.
+ * @returns NULL.
+*/
+static void*
+reactor_routine(void*);
+
+/**
+ * @brief Works as "reactor_routine" but requests are received through an io_uring instance: each reactor keeps
+ * a receipt pending for every client it monitors and hands the received request to its workers.
+ * @returns NULL.
+*/
+static void*
+uring_reactor_routine(void*);
+
 /**
  * @brief Used to handle signals according to requirements.
  * @returns NULL.
@@ -81,6 +144,149 @@ worker_routine(void*);
 static void*
 signal_handler_routine(void*);
 
+/**
+ * Used to give signal handler thread the signals to be waited for and the descriptor
+ * to be used to wake main thread up.
+*/
+struct signal_handler_args
+{
+	sigset_t* set;
+	int fd_signal;
+};
+
+/**
+ * Used to denote a part of a reply the socket has not taken yet: it is sent by the reactor as soon as
+ * the socket is writable again.
+*/
+struct chunk
+{
+	char* base; // first byte yet to be sent
+	size_t len; // number of bytes yet to be sent
+	void* owned; // buffer to be freed once sent
+};
+
+/**
+ * Used to denote the requests being received from a client: as clients may send requests back to back,
+ * whatever follows the request being served is kept for the next ones. Reactors receive whatever clients send
+ * without waiting and hand them to workers only once a request has been fully received, payload included.
+ * Replies the socket does not take right away are left to the reactor as well.
+*/
+struct connection
+{
+	char* request; // buffer requests are received into
+	size_t received; // number of bytes received so far
+	size_t consumed; // number of bytes taken by the request being served, payload included
+	char* payload; // buffer the payload of the request is received into when it does not fit in request
+	size_t payload_len; // length of the payload received into payload
+	size_t payload_received; // number of bytes of the payload received so far
+	size_t dropped; // bytes of the payload of a failed request yet to be dropped as they are received
+	int payload_error; // errno value the request being received is to fail with, as its payload cannot be kept
+	bool reserved; // toggled on while the contents of a file space has been reserved for are being received
+	struct chunk* output; // parts of replies yet to be sent, in order
+	size_t output_head; // first part yet to be sent
+	size_t output_no; // number of parts in output, 0 if every reply has been sent
+	size_t output_capacity; // number of parts output may hold
+	bool left; // toggled on when client has closed its connection
+	int worker; // worker which served client last, -1 if none has yet
+	int metadata_worker; // metadata worker which served client last, -1 if none has yet
+	uint64_t queued_at; // time client has been placed on a worker's queue at, in nanoseconds
+	size_t batched; // number of requests of the batch being served yet to be served
+	int64_t deficit; // bytes client may still move before it yields to the others, negative if it is in debt
+	struct workers_args* reactor_args; // arguments of the reactor client has been assigned to
+	int next_waiting; // client waiting for a lock of the same stripe after this one, 0 if there is none
+};
+
+/**
+ * Used to denote the replies being sent to a client: they are gathered and written with as few system calls
+ * as possible. Small parts of a reply are copied back to back into a single buffer, whereas larger payloads
+ * are written from their own buffer, which is freed as soon as it has been sent.
+*/
+struct reply
+{
+	int fd; // client replies are sent to
+	struct connection* connection; // parts the socket does not take are left to it
+	struct iovec iov[REPLY_IOVECS]; // buffers to be written, in order
+	int iovcnt; // number of buffers to be written
+	void* owned[REPLY_IOVECS]; // buffer each one of iov is to be freed with once written, NULL if it lies in buf
+	char* buf; // buffer small parts of replies are copied into
+	size_t buf_len; // number of bytes copied into buf
+	size_t copy_threshold; // largest payload copied into buf
+	size_t replies_no; // number of replies sent so far
+	size_t bytes_no; // number of bytes gathered so far
+	size_t writes_no; // number of system calls used to send them
+};
+
+/**
+ * Used to denote the clients waiting for the lock of a file whose name falls into a given stripe, in arrival order:
+ * they are neither monitored nor served until a lock of the stripe is released.
+*/
+struct lock_waits
+{
+	pthread_mutex_t mutex;
+	int first; // first waiting client, 0 if there is none
+	int last; // last waiting client, 0 if there is none
+};
+
+/**
+ * Used by io_uring backend to denote clients which are to be monitored again: as reactor is the only thread
+ * submitting operations to its ring, other threads hand clients to it and wake it up.
+*/
+struct pending_clients
+{
+	pthread_mutex_t mutex; // used to guarantee mutual exclusion over fds
+	int* fds; // clients whose receipt is yet to be prepared
+	size_t fds_no; // number of clients whose receipt is yet to be prepared
+	int fd_wakeup; // eventfd used to wake reactor up
+};
+
+/**
+ * Used to hold the clients placed on a worker whose queue was full: threads placing clients never wait for a free
+ * slot, since workers place clients as well and would wait for themselves. Worker moves them to its own queue,
+ * oldest first, as soon as there is room.
+*/
+struct overflow
+{
+	pthread_mutex_t mutex; // used to guarantee mutual exclusion over fds
+	int* fds; // clients yet to be moved, starting from index head
+	size_t head; // index of the oldest client
+	size_t len; // index following the newest client
+	size_t capacity; // allocated size of fds
+	size_t pending; // number of clients yet to be moved, read without taking the mutex
+};
+
+/**
+ * Used to denote the workers of a reactor: each one of them has its own queue of tasks. A client is placed on
+ * the queue of the worker which served it last, so that it keeps being served by the same worker while it is
+ * active, whereas idle workers steal tasks from their siblings' queues.
+*/
+struct scheduler
+{
+	task_queue_t** queues; // tasks of each worker
+	struct overflow* overflows; // tasks of each worker which have found its queue full
+	int* idle; // toggled on by a worker which is about to sleep, toggled off as soon as it is woken up
+	uint64_t* idle_since; // time each worker has last gone to sleep at, in nanoseconds
+	size_t workers_no; // maximum number of workers
+	size_t min_workers_no; // minimum number of workers
+	size_t active; // number of workers currently serving clients: they take the lowest indexes
+	size_t next; // worker next new client is placed on
+	int stop; // toggled on when workers are to exit as soon as no task is left
+	uint64_t wait_total; // time clients have waited for on queues since it was last reset, in nanoseconds
+	uint64_t waited_no; // number of clients taken from queues since it was last reset
+};
+
+/**
+ * Used to denote the NUMA nodes reactors and their workers run on: when they are spread over more than one,
+ * files are assigned to nodes by name and every request on a file is served by the workers of its node,
+ * so that its contents are allocated and read there.
+*/
+struct placement
+{
+	size_t nodes_no; // number of nodes reactors are spread over, 1 if placement is not NUMA-aware
+	int* nodes; // id of each one of those nodes
+	struct workers_args** reactors; // reactors' arguments, grouped by node
+	size_t* first; // index in reactors of the first reactor of each node, followed by the number of reactors
+};
+
 /**
  * Used to give each worker thread the needed arguments in order to communicate with the
  * implemented filesystem and the server. It also allows them to log events.
@@ -88,11 +294,442 @@ signal_handler_routine(void*);
 struct workers_args
 {
 	storage_t* storage;
-	bounded_buffer_t* tasks;
-	int pipe_output_channel;
-	FILE* log_file;
+	struct scheduler* scheduler; // tasks of the reactor's workers
+	struct scheduler* metadata_scheduler; // tasks of the reactor's metadata workers, NULL if it has none
+	size_t metadata_threshold; // largest payload a request may move to be served by metadata workers
+	int64_t client_quantum; // bytes credited to a client every time it is served
+	size_t client_in_flight; // requests of a client served before its replies are sent and it yields
+	int fd_epoll; // used to have clients monitored again
+	io_ring_t* ring; // used instead of fd_epoll by io_uring backend
+	struct pending_clients* pending; // clients to be monitored again by io_uring backend
+	struct connection* connections; // requests received from each client, indexed by client
+	int fd_clients_left; // used to notify main thread whenever a client leaves
+	size_t copy_threshold; // largest payload copied into a reply rather than sent from its own buffer
+	size_t max_payload; // largest payload a request may carry, i.e. storage size: larger ones are never received
+	struct lock_waits* lock_waits; // clients waiting for files' locks, LOCK_STRIPES lists shared by every reactor
+	const struct placement* placement; // NUMA nodes every reactor runs on
+	size_t node; // index in placement of the node reactor runs on
+	bool pinned; // toggled on when workers are pinned to workers_cpus
+	cpu_set_t workers_cpus; // CPUs workers may run on
+	event_log_t* event_log;
+};
+
+/**
+ * @brief Initializes an empty set of clients pending to be monitored again given its capacity.
+ * @returns Initialized data structure on success, NULL on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "malloc",
+ * "eventfd", "pthread_mutex_init".
+*/
+static struct pending_clients*
+PendingClients_Init(size_t capacity);
+
+/**
+ * Frees allocated resources.
+*/
+static void
+PendingClients_Free(struct pending_clients* pending);
+
+/**
+ * @brief Initializes a scheduler given its minimum, initial and maximum number of workers: each worker
+ * which may be spawned gets its own queue of tasks.
+ * @returns Initialized data structure on success, NULL on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "malloc",
+ * "calloc", "pthread_mutex_init", "TaskQueue_Init".
+*/
+static struct scheduler*
+Scheduler_Init(size_t min_workers_no, size_t workers_no, size_t max_workers_no);
+
+/**
+ * Frees allocated resources.
+*/
+static void
+Scheduler_Free(struct scheduler* scheduler);
+
+/**
+ * @brief Tells whether the request given client is to be served for next is a metadata one, i.e. it has been
+ * fully received and it either moves no file contents or moves no more than the metadata threshold.
+ * @returns true if it is a metadata request, false otherwise.
+*/
+static bool
+is_metadata_request(const struct workers_args* reactor_args, int fd);
+
+/**
+ * @brief Hashes given file name (FNV-1a).
+ * @returns Hash of the name.
+*/
+static uint32_t
+path_hash(const char* pathname);
+
+/**
+ * @brief Copies the name of the file given frame's request is run on into given buffer.
+ * @returns true on success, false if request is not run on a single file or frame is malformed.
+ * @param pathname must be at least REQUESTLEN bytes long.
+*/
+static bool
+frame_path(const char* frame, char* pathname);
+
+/**
+ * @brief Gets the reactor whose workers are to serve the request given client is to be served for next: when
+ * reactors are spread over more than one NUMA node, requests on a file are served by the workers of the node
+ * it has been assigned to, so that its contents are allocated and read there.
+ * @returns Arguments of the reactor client is to be served by, those of its own reactor if it does not matter.
+*/
+static struct workers_args*
+home_reactor(const struct workers_args* reactor_args, int fd);
+
+/**
+ * @brief Has given ready client served by a worker of the reactor given workers' arguments belong to: it is placed
+ * on the queue of the worker which served it last, an idle worker is woken up to steal it if that one is busy.
+ * Metadata requests are served by metadata workers, if reactor has any, so that they never wait behind bulk transfers.
+ * @note Server exits on failure. It may be called by workers as well.
+*/
+static void
+schedule_client(struct workers_args* reactor_args, int fd);
+
+/**
+ * @brief Places given task on the queue of given worker without waiting: if it is full, task is listed among
+ * those the worker moves to its queue as soon as there is room.
+ * @note Server exits on failure.
+*/
+static void
+enqueue_task(struct scheduler* scheduler, size_t worker, int task);
+
+/**
+ * @brief Wakes given worker up, if it is sleeping, without waiting: a full queue keeps its worker awake anyway.
+ * @note Server exits on failure.
+*/
+static void
+nudge_worker(struct scheduler* scheduler, size_t worker);
+
+/**
+ * @brief Moves as many tasks as there is room for from the overflow of given worker to its queue.
+ * @note Server exits on failure. It is only called by the worker itself.
+*/
+static void
+refill_queue(struct scheduler* scheduler, size_t worker);
+
+/**
+ * @brief Gets the next client to be served by given worker: its own queue is looked at first, then its siblings' ones.
+ * If there is none, worker sleeps until it is handed a client or nudged.
+ * @returns Client to be served, TERMINATE_WORKER if worker is to exit, either because server is shutting down
+ * or because it has been retired.
+ * @note Server exits on failure.
+*/
+static int
+next_task(struct scheduler* scheduler, size_t worker);
+
+/**
+ * @brief Has given client monitored by the reactor given workers' arguments belong to.
+ * @param first_time toggled on when client has just been accepted.
+ * @note Server exits on failure.
+*/
+static void
+monitor_client(struct workers_args* reactor_args, int fd, bool first_time);
+
+/**
+ * Used to denote a request as parsed by a worker, whichever protocol it has been sent with.
+*/
+struct request
+{
+	bool binary; // toggled on when request has been sent as a binary frame: it is replied to the same way
+	uint64_t id; // id echoed back when replying to binary requests
+	opcodes_t opcode; // operation to be run
+	int flags; // operation's flags
+	char pathname[REQUESTLEN]; // file operation is run on, prefix of the files to be read or listed for READ_N and LIST
+	size_t size; // size of the contents following the request (USED TO HANDLE writeFile, appendToFile)
+	size_t args[2]; // N (USED TO HANDLE readNFiles), offset and length of the slice (USED TO HANDLE readFileRange)
+};
+
+/**
+ * @brief Gets the length of a request given its first "sizeof(request_header_t)" bytes: text requests always take
+ * REQUESTLEN bytes, binary ones are as long as their header and path.
+ * @returns Frame length on success, 0 if frame is not a valid one.
+*/
+static size_t
+frame_length(const char* buf);
+
+/**
+ * @brief Parses given text request, formatted as "OPCODE [ARGS]", into given request.
+ * @returns 1 on success, -1 if request is empty.
+ * @note Server exits on failure.
+*/
+static int
+parse_text_request(char* buf, struct request* req);
+
+/**
+ * @brief Gets the length of the payload following given frame which is to be received before the request is served:
+ * contents of written files, numerical arguments, count of a batch.
+ * @returns Length of the payload, 0 if there is none or if it is larger than max_payload: such a request is served
+ * right away, it fails with "EFBIG" and its payload is dropped as it is received.
+*/
+static size_t
+payload_length(const char* buf, size_t max_payload);
+
+/**
+ * @brief Tells where the next bytes sent by given client are to be received into for its next request to be
+ * fully received: a payload too large to fit in the request buffer is moved to a buffer of its own.
+ * @returns Number of bytes which may be received into *bufptr, 0 if request has been fully received or is malformed.
+ * @note Server exits on failure.
+*/
+static size_t
+next_receipt(struct connection* connection, char** bufptr);
+
+/**
+ * @brief Accounts for given number of bytes received where "next_receipt" has told.
+*/
+static void
+receipt_done(struct connection* connection, size_t size);
+
+/**
+ * @brief Moves the payload following the request at given offset to a buffer of its own, large enough
+ * for given size: the rest of the payload is to be received into it.
+ * @returns true on success, false if buffer could not be allocated: request is to fail with "ENOMEM".
+*/
+static bool
+expect_payload(struct connection* connection, size_t offset, size_t size);
+
+/**
+ * @brief Has the payload of the request being served, which has failed, dropped: the bytes received along with it
+ * are consumed, the rest are dropped by the reactor as they are received.
+*/
+static void
+drop_payload(struct connection* connection, size_t size);
+
+/**
+ * @brief Binds the pages of the payload of given client's request to the NUMA node its file is served on,
+ * provided reactors are spread over more than one and payload is large enough to have pages of its own.
+ * @note It is only a hint: payload is left where it is if binding fails.
+*/
+static void
+bind_payload(const struct connection* connection);
+
+/**
+ * @brief Receives whatever given client has sent without waiting, until its next request has been fully received.
+ * @returns true if request has been fully received or client has left, false if more bytes are to be waited for.
+ * @note Server exits on failure.
+*/
+static bool
+receive_available(struct connection* connection, int fd);
+
+/**
+ * @brief Parses the request given client is to be served for next: it has already been fully received,
+ * bytes following it are either its payload or the next requests.
+ * @returns 1 on success, 0 if client has left or has sent a malformed frame, -1 if request is empty.
+ * @param buf must be at least REQUESTLEN bytes long.
+ * @note Server exits on failure.
+*/
+static int
+receive_request(struct workers_args* workers_args, int fd, char* buf, struct request* req);
+
+/**
+ * @brief Copies given size of the payload following the request being served, as received along with it.
+ * @returns 1 on success, 0 if request is malformed.
+*/
+static int
+receive_payload(struct connection* connection, void* buf, size_t size);
+
+/**
+ * @brief Takes the contents of a file following the request being served: they are either copied from the bytes
+ * received along with the request or handed over as they have been received into a buffer of their own.
+ * @returns NUL-terminated contents to be freed by callee on success, NULL if request is malformed.
+ * @note Server exits on failure.
+*/
+static void*
+take_payload(struct connection* connection, size_t size);
+
+/**
+ * @brief Drops the request which has just been served from given connection.
+ * @returns true if the next request has already been fully received, false otherwise.
+*/
+static bool
+next_request_received(struct connection* connection);
+
+/**
+ * @brief Copies given bytes into given reply, writing what has been gathered so far if there is no room left.
+ * @param size cannot be greater than REPLY_BUFLEN.
+ * @note Server exits on failure.
+*/
+static void
+reply_append(struct reply* reply, const void* buf, size_t size);
+
+/**
+ * @brief Hands given buffer to given reply, which frees it once it has been sent: buffers up to reply's
+ * threshold are copied right away, larger ones are written from where they lie.
+ * @param buf may be NULL only if size is 0.
+ * @note Server exits on failure.
+*/
+static void
+reply_give(struct reply* reply, void* buf, size_t size);
+
+/**
+ * @brief Writes whatever has been gathered into given reply with a single system call as long as the socket takes
+ * it whole, then frees the buffers it owns. Whatever the socket does not take without waiting is left to client's
+ * connection, so that reactor sends it. If client has left, gathered replies are dropped.
+ * @note Server exits on failure.
+*/
+static void
+reply_flush(struct reply* reply);
+
+/**
+ * @brief Appends given part of a reply to the ones given client's reactor is to send: it is copied
+ * unless it is owned by a buffer of its own.
+ * @note Server exits on failure.
+*/
+static void
+output_push(struct connection* connection, const struct iovec* iov, void* owned);
+
+/**
+ * @brief Sends as many of the parts of replies left to given client as its socket takes without waiting.
+ * @returns 1 if every part has been sent, 0 if some are yet to be sent, -1 if client has left.
+ * @note Server exits on failure.
+*/
+static int
+send_output(struct connection* connection, int fd);
+
+/**
+ * @brief Drops the parts of replies left to given client.
+*/
+static void
+output_drop(struct connection* connection);
+
+/**
+ * @brief Adds to given reply the outcome of its request along with errno value if it has failed.
+ * @note Server exits on failure.
+*/
+static void
+send_status(struct reply* reply, const struct request* req, int status, int error);
+
+/**
+ * @brief Adds to given reply a size or a count.
+ * @note Server exits on failure.
+*/
+static void
+send_size(struct reply* reply, const struct request* req, size_t size);
+
+/**
+ * @brief Adds to given reply a file's name. An empty name is used to mark the end of a stream of files.
+ * @note Server exits on failure.
+*/
+static void
+send_name(struct reply* reply, const struct request* req, const char* name);
+
+/**
+ * @brief Adds to given reply a file's size, version, lock owner and open count.
+ * @note Server exits on failure.
+*/
+static void
+send_stat(struct reply* reply, const struct request* req, const file_stat_t* file_stat);
+
+/**
+ * @brief Adds to given reply the number of evicted files followed by each file's name, size and contents.
+ * Given list is freed.
+ * @note Server exits on failure.
+*/
+static void
+send_victims(struct reply* reply, const struct request* req, linked_list_t* evicted, struct workers_args* reactor_args);
+
+/**
+ * @brief Acquires the lock of given file on behalf of given client. If another client owns it, client waits for it
+ * without holding a worker: replies gathered so far are sent, then its request is served again as soon as
+ * a lock of the same stripe is released.
+ * @returns Outcome of "Storage_lockFile", -1 if client waits for the lock.
+ * @note Server exits on failure. Value of "errno" is the one set by "Storage_lockFile".
+*/
+static int
+lock_or_wait(struct workers_args* reactor_args, struct reply* reply, int fd, const char* pathname);
+
+/**
+ * @brief Hands the clients waiting for a lock of the stripe given file falls into back to their reactors' workers,
+ * so that they try to acquire it again. If pathname is NULL, clients waiting on every stripe are woken up.
+ * @note Server exits on failure.
+*/
+static void
+wake_lock_waiters(struct workers_args* reactor_args, const char* pathname);
+
+/**
+ * Used to denote a reactor thread: clients are assigned round-robin to reactors as they get accepted and
+ * every request sent by a client is served by the workers of the reactor it has been assigned to.
+*/
+struct reactor
+{
+	pthread_t thread; // reactor thread id
+	int fd_stop; // eventfd used by main thread to stop reactor
+	size_t connections_no; // maximum number of clients
+	bool pinned; // toggled on when reactor is pinned to cpus
+	cpu_set_t cpus; // CPUs reactor may run on
+	struct workers_args workers_args; // reactor's epoll instance and scheduler, shared by its workers
+};
+
+/**
+ * @brief Prepares what given client is to be waited for by io_uring backend: its socket to be writable if replies
+ * are yet to be sent to it, the receipt of the rest of its request otherwise. Clients whose request has already
+ * been fully received, or which have left, are handed to workers right away.
+ * @returns true if an operation has been prepared, false otherwise.
+ * @note Server exits on failure.
+*/
+static bool
+uring_monitor_client(struct reactor* reactor, int fd);
+
+/**
+ * @brief Pins reactors and their workers to given CPUs: reactor i runs on the i-th reactors' CPU, round-robin,
+ * its workers on the workers' CPUs lying on its NUMA node, or on all of them if there is none.
+ * If reactors are pinned to CPUs spread over more than one node, given placement is filled in.
+ * @returns 0 on success, -1 on failure.
+ * @exception It sets "errno" to "EINVAL" if any CPU is not one server may run on. The function may also fail
+ * and set "errno" for any of the errors specified for the routines "sched_getaffinity", "malloc".
+*/
+static int
+place_reactors(struct placement* placement, struct reactor* reactors, size_t reactors_no,
+			const int* reactors_cpus, size_t reactors_cpus_no, const int* workers_cpus, size_t workers_cpus_no);
+
+/**
+ * Frees allocated resources.
+*/
+static void
+Placement_Free(struct placement* placement);
+
+/**
+ * @brief Pins callee to given CPUs.
+ * @note Server exits on failure.
+*/
+static void
+pin_thread(const cpu_set_t* cpus);
+
+/**
+ * Used to denote a worker thread: its id is the index of its own queue in its scheduler.
+*/
+struct worker
+{
+	pthread_t thread; // worker thread id
+	size_t id; // index among its reactor's workers
+	struct workers_args* workers_args; // arguments shared by its reactor's workers
+	struct scheduler* scheduler; // scheduler worker takes tasks from
+	bool metadata; // toggled on when worker only serves metadata requests
+	bool started; // toggled on once thread has been created, off once it has been joined (USED ONLY BY main thread)
+	int exited; // toggled on by worker right before it exits
+};
+
+/**
+ * Used by main thread to resize workers' pools according to their load: workers are spawned as soon as
+ * ready clients wait for too long or there are too many of them, idle ones are retired after a cooldown.
+*/
+struct controller
+{
+	int fd_timer; // timerfd waking main thread up every CONTROLLER_PERIOD milliseconds
+	uint64_t wait_threshold; // average wait, in microseconds, more workers are spawned above
+	size_t depth_threshold; // number of queued clients more workers are spawned above
+	uint64_t cooldown; // time, in milliseconds, a worker is to be idle for before it gets retired
 };
 
+/**
+ * @brief Spawns or retires a worker of each reactor according to the load it has been under since last call.
+ * Worker i of reactor r is workers[i * reactors_no + r]. Every decision is logged along with what triggered it.
+ * @note Server exits on failure.
+*/
+static void
+control_workers(const struct controller* controller, struct reactor* reactors, size_t reactors_no,
+			struct worker* workers, event_log_t* event_log);
+
 int
 main(int argc, char* argv[])
 {
@@ -108,30 +745,54 @@ main(int argc, char* argv[])
 	int err; // placeholder for functions' output values
 	int fd_socket = -1; // socket's file descriptor
 	int fd_new_client = -1; // new client's fd
-	int pipe_worker2manager[2]; // pipe used for worker-manager communications
-	bool pipe_init = false; // toggled on if pipe has been initialized
+	int fd_clients_left = -1; // eventfd counting clients which left since main thread last checked
+	int fd_signal = -1; // eventfd used by signal handler thread to wake main thread up
 	server_config_t* config = NULL; // server config
 	storage_t* storage = NULL; // server storage
 	struct sockaddr_un saddr; // socket address
 	struct sigaction sig_action; sigset_t sigset; // signal mask
 	char* sockname = NULL; // socket's name
-	pthread_t* workers = NULL; // worker threads pool
+	struct worker* workers = NULL; // worker threads pool
+	struct worker* metadata_workers = NULL; // metadata worker threads pool
+	unsigned long metadata_workers_no = 0; // metadata worker threads pool size
+	size_t workers_created = 0; // number of worker threads created
+	size_t metadata_workers_created = 0; // number of metadata worker threads created
+	size_t reactor_metadata_no = 0; // number of metadata workers of a reactor
+	struct reactor* reactors = NULL; // reactor threads pool
+	unsigned long reactors_no = 0; // reactor threads pool size
+	size_t reactors_created = 0; // number of reactor threads created
+	size_t next_reactor = 0; // reactor next client is to be assigned to
+	int fd_stop = -1; // eventfd used to stop reactors
 	pthread_t signal_handler_thread; // signal handler's thread id
 	bool signal_handler_created = false; // toggled on when signal handler thread has been created
 	unsigned long workers_pool_size = 0; // worker threads pool size
-	fd_set master_read_set; // read set
-	fd_set read_set; // copy of the original set
-	int fd_num = 0; // number of fds in set
-	struct timeval timeout_master = { 0, 100000 }; // 100ms timeout used to check whether select has gotten stuck
-	struct timeval timeout_copy; // used to preserve timeout value
-	bounded_buffer_t* tasks = NULL; // used to store tasks to be done
-	struct workers_args* workers_args = NULL; // worker threads' arguments
+	unsigned long min_workers_no = 0; // minimum worker threads pool size
+	unsigned long max_workers_no = 0; // maximum worker threads pool size
+	struct controller controller = { .fd_timer = -1 }; // used to resize workers' pools
+	struct itimerspec period; // controller's period
+	struct signal_handler_args signal_handler_args; // signal handler thread's arguments
+	int fd_epoll = -1; // epoll instance monitoring listening socket and eventfds
+	struct epoll_event event; // used to register descriptors to epoll instance
+	struct epoll_event ready_events[MAXEVENTS]; // events returned by epoll_wait
+	int ready_no = 0; // number of ready descriptors
+	int fd_ready = -1; // currently visited ready descriptor
+	struct rlimit fd_limit; // limit on number of open descriptors
+	io_backend_t backend = EPOLL; // I/O backend used to receive requests
+	struct connection* connections = NULL; // requests received from each client, indexed by client
+	size_t connections_no = 0; // maximum number of descriptors
+	struct lock_waits* lock_waits = NULL; // clients waiting for files' locks
+	struct placement placement = { .nodes_no = 1 }; // NUMA nodes reactors run on
+	int* reactors_cpus = NULL; // CPUs reactors are pinned to
+	size_t reactors_cpus_no = 0; // number of CPUs reactors are pinned to
+	int* workers_cpus = NULL; // CPUs workers are pinned to
+	size_t workers_cpus_no = 0; // number of CPUs workers are pinned to
 	size_t online_clients = 0; // number of clients currently online
-	char pipe_buffer[PIPEBUFFERLEN]; // buffer used by pipe
-	int pipe_msg; // message read from pipe
-	char new_task[TASKLEN]; // used to denote task to be added as a string
+	bool accepting = true; // false while the socket is left out of epoll instance for lack of descriptors
+	uint64_t clients_left = 0; // number of clients which left as read from eventfd
+	uint64_t stop = 1; // value written to eventfd to stop reactors
 	char* log_name = NULL; // name of log file
 	FILE* log_file = NULL; // log as a FILE*
+	event_log_t* event_log = NULL; // log records are appended to
 	size_t i = 0; // index in loops
 
 	// ----------------
@@ -149,15 +810,22 @@ main(int argc, char* argv[])
 
 	// per requirements: SIGPIPE is to be ignored
 	EXIT_IF_NEQ(err, 0, sigaction(SIGPIPE, &sig_action, NULL), sigaction);
-	// use dedicated thread to handle signals
+	// use dedicated thread to handle signals: it is created as soon as its eventfd gets initialized
 	EXIT_IF_NEQ(err, 0, pthread_sigmask(SIG_BLOCK, &sigset, NULL), pthread_sigmask);
-	EXIT_IF_NEQ(err, 0, pthread_create(&signal_handler_thread, NULL, &signal_handler_routine, (void*) &sigset), pthread_create);
-	signal_handler_created = true;
 
 	// ---------------------------------
 	// SERVER INTERNALS' INITIALIZATION
 	// ---------------------------------
 
+	// every client needs its own descriptor: soft limit is raised as much as allowed
+	if (getrlimit(RLIMIT_NOFILE, &fd_limit) == 0 && fd_limit.rlim_cur < fd_limit.rlim_max)
+	{
+		fd_limit.rlim_cur = fd_limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &fd_limit); // on failure, current limit is kept
+	}
+	EXIT_IF_NEQ(err, 0, getrlimit(RLIMIT_NOFILE, &fd_limit), getrlimit);
+	connections_no = (size_t) fd_limit.rlim_cur;
+
 	// initialize config file
 	config = ServerConfig_Init();
 	if (!config)
@@ -183,14 +851,6 @@ main(int argc, char* argv[])
 		goto failure;
 	}
 	
-	// initialize tasks' bounded buffer
-	tasks = BoundedBuffer_Init(MAXTASKS);
-	if (!tasks)
-	{
-		perror("BoundedBuffer_Init");
-		goto failure;
-	}
-	
 	// initialize socket
 	err = ServerConfig_GetSocketFilePath(config, &sockname);
 	if (err == 0)
@@ -201,7 +861,8 @@ main(int argc, char* argv[])
 	strncpy(saddr.sun_path, sockname, MAXPATH);
 	saddr.sun_family = AF_UNIX;
 	//fprintf(stdout, "sockname: %s\n", sockname);
-	fd_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	// listening socket is non-blocking so that every pending connection can be accepted at once
+	fd_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
 	if (fd_socket == -1)
 	{
 		perror("socket");
@@ -213,75 +874,327 @@ main(int argc, char* argv[])
 		perror("bind");
 		goto failure;
 	}
-	err = listen(fd_socket, MAXCONNECTIONS);
+	err = listen(fd_socket, (int) ServerConfig_GetMaxPendingConnections(config));
 	if (err == -1)
 	{
 		perror("listen");
 		goto failure;
 	}
 
-	// initialize pipe
-	err = pipe(pipe_worker2manager);
-	if (err == -1)
+	// initialize eventfds
+	fd_clients_left = eventfd(0, EFD_CLOEXEC);
+	if (fd_clients_left == -1)
 	{
-		perror("pipe");
+		perror("eventfd");
 		goto failure;
 	}
-	pipe_init = true;
-
-	// initialize fd set
-	fd_num = MAX(fd_num, fd_socket);
-	FD_ZERO(&master_read_set);
-	FD_SET(fd_socket, &master_read_set);
-	FD_SET(pipe_worker2manager[0], &master_read_set);
-
-	// initialize log file
-	err = (int) ServerConfig_GetLogFilePath(config, &log_name);
-	if (err == 0)
+	fd_signal = eventfd(0, EFD_CLOEXEC);
+	if (fd_signal == -1)
 	{
-		perror("ServerConfig_GetLogFilePath");
+		perror("eventfd");
 		goto failure;
 	}
-	mode_t oldmask = umask(033);
-	log_file = fopen(log_name, "w+");
-	if (!log_file)
+	fd_stop = eventfd(0, EFD_CLOEXEC);
+	if (fd_stop == -1)
 	{
-		perror("fopen");
+		perror("eventfd");
 		goto failure;
 	}
-	umask(oldmask);
 
-	// initialize workers' arguments
-	workers_args = (struct workers_args*) malloc(sizeof(struct workers_args));
-	if (!workers_args)
+	// initialize signal handler thread
+	signal_handler_args.set = &sigset;
+	signal_handler_args.fd_signal = fd_signal;
+	err = pthread_create(&signal_handler_thread, NULL, &signal_handler_routine, (void*) &signal_handler_args);
+	if (err != 0)
 	{
-		perror("malloc");
+		errno = err;
+		perror("pthread_create");
 		goto failure;
 	}
-	workers_args->storage = storage;
-	workers_args->tasks = tasks;
-	workers_args->pipe_output_channel = pipe_worker2manager[1];
-	workers_args->log_file = log_file;
+	signal_handler_created = true;
 
-	// initialize workers pool
-	workers_pool_size = ServerConfig_GetWorkersNo(config); // cannot fail
-	workers = (pthread_t*) malloc(sizeof(pthread_t) * workers_pool_size);
-	if (!workers)
+	// initialize epoll instance
+	fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (fd_epoll == -1)
 	{
-		perror("malloc");
+		perror("epoll_create1");
 		goto failure;
 	}
-	for (i = 0; i < (size_t) workers_pool_size; i++)
-		{
-			err = pthread_create(&(workers[i]), NULL, &worker_routine, (void*) workers_args);
-			if (err != 0)
-			{
-				perror("pthread_create");
-				goto failure;
-			}
-		}
-
-	/**
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = fd_socket;
+	err = epoll_ctl(fd_epoll, EPOLL_CTL_ADD, fd_socket, &event);
+	if (err == -1)
+	{
+		perror("epoll_ctl");
+		goto failure;
+	}
+	event.data.fd = fd_clients_left;
+	err = epoll_ctl(fd_epoll, EPOLL_CTL_ADD, fd_clients_left, &event);
+	if (err == -1)
+	{
+		perror("epoll_ctl");
+		goto failure;
+	}
+	event.data.fd = fd_signal;
+	err = epoll_ctl(fd_epoll, EPOLL_CTL_ADD, fd_signal, &event);
+	if (err == -1)
+	{
+		perror("epoll_ctl");
+		goto failure;
+	}
+
+	// initialize log file
+	err = (int) ServerConfig_GetLogFilePath(config, &log_name);
+	if (err == 0)
+	{
+		perror("ServerConfig_GetLogFilePath");
+		goto failure;
+	}
+	mode_t oldmask = umask(033);
+	log_file = fopen(log_name, "w+");
+	if (!log_file)
+	{
+		perror("fopen");
+		goto failure;
+	}
+	umask(oldmask);
+	event_log = EventLog_Init(log_file, ServerConfig_GetLogFormat(config), ServerConfig_GetLogOverflow(config),
+			ServerConfig_GetLogSampling(config));
+	if (!event_log)
+	{
+		perror("EventLog_Init");
+		goto failure;
+	}
+
+	// initialize reactors: each one of them needs at least a worker
+	workers_pool_size = ServerConfig_GetWorkersNo(config); // cannot fail
+	min_workers_no = ServerConfig_GetMinWorkersNo(config); // cannot fail
+	max_workers_no = ServerConfig_GetMaxWorkersNo(config); // cannot fail
+	reactors_no = MIN(ServerConfig_GetReactorsNo(config), min_workers_no); // cannot fail
+	metadata_workers_no = ServerConfig_GetMetadataWorkersNo(config); // cannot fail
+	backend = ServerConfig_GetIOBackend(config); // cannot fail
+	errno = 0;
+	reactors_cpus_no = (size_t) ServerConfig_GetReactorsCPUs(config, &reactors_cpus);
+	if (reactors_cpus_no == 0 && errno != 0)
+	{
+		perror("ServerConfig_GetReactorsCPUs");
+		goto failure;
+	}
+	workers_cpus_no = (size_t) ServerConfig_GetWorkersCPUs(config, &workers_cpus);
+	if (workers_cpus_no == 0 && errno != 0)
+	{
+		perror("ServerConfig_GetWorkersCPUs");
+		goto failure;
+	}
+	connections = (struct connection*) calloc(connections_no, sizeof(struct connection));
+	if (!connections)
+	{
+		perror("calloc");
+		goto failure;
+	}
+	lock_waits = (struct lock_waits*) calloc(LOCK_STRIPES, sizeof(struct lock_waits));
+	if (!lock_waits)
+	{
+		perror("calloc");
+		goto failure;
+	}
+	for (i = 0; i < LOCK_STRIPES; i++)
+	{
+		err = pthread_mutex_init(&(lock_waits[i].mutex), NULL);
+		if (err != 0)
+		{
+			errno = err;
+			perror("pthread_mutex_init");
+			goto failure;
+		}
+	}
+	reactors = (struct reactor*) malloc(sizeof(struct reactor) * reactors_no);
+	if (!reactors)
+	{
+		perror("malloc");
+		goto failure;
+	}
+	for (i = 0; i < (size_t) reactors_no; i++)
+	{
+		reactors[i].fd_stop = fd_stop;
+		reactors[i].connections_no = connections_no;
+		reactors[i].pinned = false;
+		reactors[i].workers_args.placement = &placement;
+		reactors[i].workers_args.node = 0;
+		reactors[i].workers_args.pinned = false;
+		reactors[i].workers_args.storage = storage;
+		reactors[i].workers_args.fd_clients_left = fd_clients_left;
+		reactors[i].workers_args.event_log = event_log;
+		reactors[i].workers_args.copy_threshold = (size_t) ServerConfig_GetCopyThreshold(config);
+		reactors[i].workers_args.max_payload = (size_t) ServerConfig_GetStorageSize(config);
+		reactors[i].workers_args.fd_epoll = -1;
+		reactors[i].workers_args.ring = NULL;
+		reactors[i].workers_args.pending = NULL;
+		reactors[i].workers_args.connections = connections;
+		reactors[i].workers_args.lock_waits = lock_waits;
+		reactors[i].workers_args.scheduler = NULL;
+		reactors[i].workers_args.metadata_scheduler = NULL;
+		reactors[i].workers_args.metadata_threshold = (size_t) ServerConfig_GetMetadataThreshold(config);
+		reactors[i].workers_args.client_quantum = (int64_t) ServerConfig_GetClientQuantum(config);
+		reactors[i].workers_args.client_in_flight = (size_t) ServerConfig_GetClientInFlight(config);
+	}
+	// threads are pinned as soon as they start: whatever they allocate lies on their own node
+	err = place_reactors(&placement, reactors, (size_t) reactors_no, reactors_cpus, reactors_cpus_no,
+				workers_cpus, workers_cpus_no);
+	if (err == -1)
+	{
+		perror("place_reactors");
+		goto failure;
+	}
+	for (i = 0; i < (size_t) reactors_no; i++)
+	{
+		// workers are split among reactors as evenly as possible
+		reactors[i].workers_args.scheduler = Scheduler_Init(
+					min_workers_no / reactors_no + ((i < min_workers_no % reactors_no) ? 1 : 0),
+					workers_pool_size / reactors_no + ((i < workers_pool_size % reactors_no) ? 1 : 0),
+					max_workers_no / reactors_no + ((i < max_workers_no % reactors_no) ? 1 : 0));
+		if (!reactors[i].workers_args.scheduler)
+		{
+			perror("Scheduler_Init");
+			goto failure;
+		}
+		// metadata workers are split the same way: their pools are never resized
+		reactor_metadata_no = metadata_workers_no / reactors_no + ((i < metadata_workers_no % reactors_no) ? 1 : 0);
+		if (reactor_metadata_no != 0)
+		{
+			reactors[i].workers_args.metadata_scheduler = Scheduler_Init(reactor_metadata_no, reactor_metadata_no,
+						reactor_metadata_no);
+			if (!reactors[i].workers_args.metadata_scheduler)
+			{
+				perror("Scheduler_Init");
+				goto failure;
+			}
+		}
+		if (backend == IO_URING)
+		{
+			reactors[i].workers_args.ring = IoRing_Init(MAXTASKS);
+			if (!reactors[i].workers_args.ring)
+			{
+				perror("IoRing_Init");
+				goto failure;
+			}
+			reactors[i].workers_args.pending = PendingClients_Init(connections_no);
+			if (!reactors[i].workers_args.pending)
+			{
+				perror("PendingClients_Init");
+				goto failure;
+			}
+			continue;
+		}
+		reactors[i].workers_args.fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (reactors[i].workers_args.fd_epoll == -1)
+		{
+			perror("epoll_create1");
+			goto failure;
+		}
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = fd_stop;
+		err = epoll_ctl(reactors[i].workers_args.fd_epoll, EPOLL_CTL_ADD, fd_stop, &event);
+		if (err == -1)
+		{
+			perror("epoll_ctl");
+			goto failure;
+		}
+	}
+	for (reactors_created = 0; reactors_created < (size_t) reactors_no; reactors_created++)
+	{
+		err = pthread_create(&(reactors[reactors_created].thread), NULL,
+					(backend == IO_URING) ? &uring_reactor_routine : &reactor_routine, (void*) &(reactors[reactors_created]));
+		if (err != 0)
+		{
+			errno = err;
+			perror("pthread_create");
+			goto failure;
+		}
+	}
+
+	// initialize workers pool: workers are evenly split among reactors, room is made for as many as may be spawned
+	workers = (struct worker*) calloc(max_workers_no, sizeof(struct worker));
+	if (!workers)
+	{
+		perror("calloc");
+		goto failure;
+	}
+	for (workers_created = 0; workers_created < (size_t) workers_pool_size; workers_created++)
+	{
+		workers[workers_created].id = workers_created / reactors_no;
+		workers[workers_created].workers_args = &(reactors[workers_created % reactors_no].workers_args);
+		workers[workers_created].scheduler = workers[workers_created].workers_args->scheduler;
+		err = pthread_create(&(workers[workers_created].thread), NULL, &worker_routine, (void*) &(workers[workers_created]));
+		if (err != 0)
+		{
+			errno = err;
+			perror("pthread_create");
+			goto failure;
+		}
+		workers[workers_created].started = true;
+	}
+	if (metadata_workers_no != 0)
+	{
+		metadata_workers = (struct worker*) calloc(metadata_workers_no, sizeof(struct worker));
+		if (!metadata_workers)
+		{
+			perror("calloc");
+			goto failure;
+		}
+	}
+	for (metadata_workers_created = 0; metadata_workers_created < (size_t) metadata_workers_no; metadata_workers_created++)
+	{
+		struct worker* worker = &(metadata_workers[metadata_workers_created]);
+		worker->id = metadata_workers_created / reactors_no;
+		worker->workers_args = &(reactors[metadata_workers_created % reactors_no].workers_args);
+		worker->scheduler = worker->workers_args->metadata_scheduler;
+		worker->metadata = true;
+		err = pthread_create(&(worker->thread), NULL, &worker_routine, (void*) worker);
+		if (err != 0)
+		{
+			errno = err;
+			perror("pthread_create");
+			goto failure;
+		}
+		worker->started = true;
+	}
+
+	// initialize controller: it is only needed when pools may be resized
+	controller.wait_threshold = ServerConfig_GetScaleUpWait(config); // cannot fail
+	controller.depth_threshold = ServerConfig_GetScaleUpDepth(config); // cannot fail
+	controller.cooldown = ServerConfig_GetIdleCooldown(config); // cannot fail
+	if (min_workers_no != max_workers_no)
+	{
+		controller.fd_timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if (controller.fd_timer == -1)
+		{
+			perror("timerfd_create");
+			goto failure;
+		}
+		memset(&period, 0, sizeof(period));
+		period.it_interval.tv_nsec = CONTROLLER_PERIOD * 1000000L;
+		period.it_value = period.it_interval;
+		err = timerfd_settime(controller.fd_timer, 0, &period, NULL);
+		if (err == -1)
+		{
+			perror("timerfd_settime");
+			goto failure;
+		}
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = controller.fd_timer;
+		err = epoll_ctl(fd_epoll, EPOLL_CTL_ADD, controller.fd_timer, &event);
+		if (err == -1)
+		{
+			perror("epoll_ctl");
+			goto failure;
+		}
+	}
+
+	/**
 	 * From this point, exceptions will be handled by exiting.
 	*/
 
@@ -295,15 +1208,13 @@ main(int argc, char* argv[])
 
 		if (online_clients == 0 && no_more_clients) goto cleanup;
 
-		// fd set is to be reset as select does not preserve it
-		read_set = master_read_set;
-		timeout_copy = timeout_master; // select does not preserve timeout value
-		// A timeout is used not to be undefinitely locked on select
-		if ((select(fd_num + 1, &read_set, NULL, NULL, &timeout_copy)) == -1)
+		// there is no need for a timeout: signal handler thread wakes main thread up through its eventfd
+		ready_no = epoll_wait(fd_epoll, ready_events, MAXEVENTS, -1);
+		if (ready_no == -1)
 		{
 			if (errno != EINTR)
 			{
-				perror("select");
+				perror("epoll_wait");
 				exit(EXIT_FAILURE);
 			}
 			else
@@ -314,666 +1225,2081 @@ main(int argc, char* argv[])
 			}
 		}
 
-		// loop through the fd set to find out which fd is now ready
-		for (int j = 0; j < fd_num + 1; j++)
+		// only ready descriptors are visited
+		for (int j = 0; j < ready_no; j++)
 		{
-			if (FD_ISSET(j, &read_set)) // i is ready
+			fd_ready = ready_events[j].data.fd;
+			// workers re-arm clients by themselves: they only notify main thread when clients leave
+			if (fd_ready == fd_clients_left)
 			{
-				// reading from pipe means worker is done with a request
-				if (j == pipe_worker2manager[0])
+				EXIT_IF_EQ(err, -1, readn((long) fd_ready, (void*) &clients_left, sizeof(clients_left)), readn);
+				online_clients = (clients_left < online_clients) ? online_clients - clients_left : 0;
+				// a descriptor has been freed: pending clients can be accepted again
+				if (!accepting)
 				{
-					EXIT_IF_EQ(err, -1, readn((long) j, (void*) pipe_buffer, PIPEBUFFERLEN), readn);
-					EXIT_IF_NEQ(err, 1, sscanf(pipe_buffer, "%d", &pipe_msg), sscanf);
-					if (pipe_msg) // msg != 0 means no client left
-					{
-						FD_SET(pipe_msg, &master_read_set);
-						fd_num = MAX(pipe_msg, fd_num);
-					}
-					else // client left
-					{
-						if (online_clients) online_clients--;
-						if (online_clients == 0 && no_more_clients) break;
-					}
+					event.events = EPOLLIN;
+					event.data.fd = fd_socket;
+					EXIT_IF_EQ(err, -1, epoll_ctl(fd_epoll, EPOLL_CTL_ADD, fd_socket, &event), epoll_ctl);
+					accepting = true;
 				}
-				else if (j == fd_socket) // new client
+				if (online_clients == 0 && no_more_clients) break;
+			}
+			// a signal has been received: flags are checked at the beginning of the loop, once the others have been handled
+			else if (fd_ready == fd_signal) continue;
+			else if (fd_ready == controller.fd_timer)
+			{
+				EXIT_IF_EQ(err, -1, readn((long) fd_ready, (void*) &clients_left, sizeof(clients_left)), readn);
+				control_workers(&controller, reactors, (size_t) reactors_no, workers, event_log);
+			}
+			else if (fd_ready == fd_socket) // new clients
+			{
+				while ((fd_new_client = accept4(fd_socket, NULL, 0, SOCK_CLOEXEC)) != -1)
 				{
-					EXIT_IF_EQ(fd_new_client, -1, accept(fd_socket, NULL, 0), accept);
-					if (no_more_clients) close(fd_new_client);
-					else
+					if (no_more_clients)
 					{
-						LOG_EVENT("New client accepted : %d.\n", fd_new_client);
-						FD_SET(fd_new_client, &master_read_set);
-						online_clients++;
-						LOG_EVENT("Current online clients : %lu.\n", online_clients);
-						fd_num = MAX(fd_new_client, fd_num);
+						close(fd_new_client);
+						continue;
 					}
+					LOG_EVENT(NULL, .event = LOG_CLIENT_ACCEPTED, .fd = fd_new_client);
+					monitor_client(&(reactors[next_reactor].workers_args), fd_new_client, true);
+					next_reactor = (next_reactor + 1) % reactors_no;
+					online_clients++;
+					LOG_EVENT(NULL, .event = LOG_ONLINE_CLIENTS, .count = online_clients);
+				}
+				// running out of descriptors is not fatal: pending clients are accepted once others leave,
+				// socket is left out until then since it would be reported as ready over and over
+				if (errno == EMFILE || errno == ENFILE)
+				{
+					EXIT_IF_EQ(err, -1, epoll_ctl(fd_epoll, EPOLL_CTL_DEL, fd_socket, NULL), epoll_ctl);
+					accepting = false;
 				}
-				else // new task from client
+				else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED)
 				{
-					memset(new_task, 0, TASKLEN);
-					snprintf(new_task, TASKLEN, "%d", j);
-					FD_CLR(j, &master_read_set);
-					if (j == fd_num) fd_num--;
-					// push ready file descriptor to task queue for workers
-					EXIT_IF_EQ(err, -1, BoundedBuffer_Enqueue(tasks, new_task), BoundedBuffer_Enqueue);
+					perror("accept4");
+					exit(EXIT_FAILURE);
 				}
 			}
 		}
 	}
 
-	return 0;
-
 
 	cleanup:
-		snprintf(new_task, TASKLEN, "%d", TERMINATE_WORKER);
-		for (size_t j = 0; j < (size_t) workers_pool_size; j++)
-			EXIT_IF_NEQ(err, 0, BoundedBuffer_Enqueue(tasks, new_task), BoundedBuffer_Enqueue);
-		for (size_t j = 0; j < (size_t) workers_pool_size; j++)
-			pthread_join(workers[j], NULL);
+		// eventfd is never read: every reactor sees it as ready
+		EXIT_IF_EQ(err, -1, writen((long) fd_stop, (void*) &stop, sizeof(stop)), writen);
+		for (size_t j = 0; j < (size_t) reactors_no; j++)
+			pthread_join(reactors[j].thread, NULL);
+		// workers exit as soon as there are no tasks left: sleeping ones are nudged
+		for (size_t j = 0; j < (size_t) reactors_no; j++)
+		{
+			__atomic_store_n(&(reactors[j].workers_args.scheduler->stop), 1, __ATOMIC_SEQ_CST);
+			for (size_t k = 0; k < reactors[j].workers_args.scheduler->workers_no; k++)
+				nudge_worker(reactors[j].workers_args.scheduler, k);
+			if (!reactors[j].workers_args.metadata_scheduler) continue;
+			__atomic_store_n(&(reactors[j].workers_args.metadata_scheduler->stop), 1, __ATOMIC_SEQ_CST);
+			for (size_t k = 0; k < reactors[j].workers_args.metadata_scheduler->workers_no; k++)
+				nudge_worker(reactors[j].workers_args.metadata_scheduler, k);
+		}
+		// metadata workers hand clients to the others: they are joined first, so that no client is handed
+		// to workers which have already exited
+		for (size_t j = 0; j < (size_t) metadata_workers_no; j++)
+			pthread_join(metadata_workers[j].thread, NULL);
+		for (size_t j = 0; j < (size_t) max_workers_no; j++)
+			if (workers[j].started) pthread_join(workers[j].thread, NULL);
 		pthread_join(signal_handler_thread, NULL);
 		ServerConfig_Free(config);
 		Storage_Print(storage);
-		if (log_file)
+		if (event_log)
 		{
-			LOG_EVENT("Maximum size reached : %5f.\n", Storage_GetReachedSize(storage) * MBYTE);
-			LOG_EVENT("Maximum file number : %lu.\n", Storage_GetReachedFiles(storage));
+			LOG_EVENT(NULL, .event = LOG_MAX_SIZE, .bytes = Storage_GetReachedSize(storage));
+			LOG_EVENT(NULL, .event = LOG_MAX_FILES, .count = Storage_GetReachedFiles(storage));
 		}
+		// every thread appending records has been joined
+		EventLog_Free(event_log);
 		Storage_Free(storage);
-		BoundedBuffer_Free(tasks);
+		for (size_t j = 0; j < (size_t) reactors_no; j++)
+		{
+			Scheduler_Free(reactors[j].workers_args.scheduler);
+			Scheduler_Free(reactors[j].workers_args.metadata_scheduler);
+			if (reactors[j].workers_args.fd_epoll != -1) close(reactors[j].workers_args.fd_epoll);
+			IoRing_Free(reactors[j].workers_args.ring);
+			PendingClients_Free(reactors[j].workers_args.pending);
+		}
+		if (connections)
+		{
+			for (size_t j = 0; j < connections_no; j++)
+			{
+				free(connections[j].request);
+				free(connections[j].payload);
+				output_drop(&(connections[j]));
+				free(connections[j].output);
+			}
+			free(connections);
+		}
+		free(lock_waits);
+		Placement_Free(&placement);
+		free(reactors_cpus);
+		free(workers_cpus);
 		if (sockname) { unlink(sockname); free(sockname); }
 		free(log_name);
-		free(workers_args);
+		free(reactors);
 		free(workers);
-		if (pipe_init) { close(pipe_worker2manager[0]); close(pipe_worker2manager[1]); }
+		free(metadata_workers);
+		if (fd_clients_left != -1) close(fd_clients_left);
+		if (fd_signal != -1) close(fd_signal);
+		if (fd_stop != -1) close(fd_stop);
+		if (controller.fd_timer != -1) close(controller.fd_timer);
 		if (log_file) fclose(log_file);
 		if (fd_socket != -1) close(fd_socket);
+		if (fd_epoll != -1) close(fd_epoll);
 		return 0;
 
 
 	failure:
-		if (workers)
+		for (size_t j = 0; j < workers_created; j++)
+			pthread_kill(workers[j].thread, SIGKILL); // cannot fail
+		free(workers);
+		for (size_t j = 0; j < metadata_workers_created; j++)
+			pthread_kill(metadata_workers[j].thread, SIGKILL); // cannot fail
+		free(metadata_workers);
+		if (reactors)
 		{
-			size_t j = 0;
-			while (j != i)
+			for (size_t j = 0; j < reactors_created; j++)
+				pthread_kill(reactors[j].thread, SIGKILL); // cannot fail
+			for (size_t j = 0; j < (size_t) reactors_no; j++)
 			{
-				pthread_kill(workers[j], SIGKILL); // cannot fail
-				j++;
+				Scheduler_Free(reactors[j].workers_args.scheduler);
+				Scheduler_Free(reactors[j].workers_args.metadata_scheduler);
+				if (reactors[j].workers_args.fd_epoll != -1) close(reactors[j].workers_args.fd_epoll);
+				IoRing_Free(reactors[j].workers_args.ring);
+				PendingClients_Free(reactors[j].workers_args.pending);
 			}
 		}
-		free(workers);
+		free(reactors);
+		free(connections);
+		free(lock_waits);
+		Placement_Free(&placement);
+		free(reactors_cpus);
+		free(workers_cpus);
 		if (signal_handler_created) pthread_kill(signal_handler_thread, SIGKILL);
 		ServerConfig_Free(config);
 		Storage_Free(storage);
-		BoundedBuffer_Free(tasks);
 		if (sockname) { unlink(sockname); free(sockname); }
 		if (fd_socket != -1) close(fd_socket);
+		EventLog_Free(event_log);
 		if (log_file) fclose(log_file);
-		if (pipe_init) { close(pipe_worker2manager[0]); close(pipe_worker2manager[1]); }
+		if (fd_clients_left != -1) close(fd_clients_left);
+		if (fd_signal != -1) close(fd_signal);
+		if (fd_stop != -1) close(fd_stop);
+		if (controller.fd_timer != -1) close(controller.fd_timer);
+		if (fd_epoll != -1) close(fd_epoll);
 		free(log_name);
-		free(workers_args);
 		exit(EXIT_FAILURE);
 }
 
 static void*
-signal_handler_routine(void* arg)
+reactor_routine(void* arg)
 {
-	sigset_t* set = (sigset_t*) arg; // used to denote signal set
+	struct reactor* reactor = (struct reactor*) arg;
+	int fd_epoll = reactor->workers_args.fd_epoll; // epoll instance monitoring reactor's clients
+	struct epoll_event ready_events[MAXEVENTS]; // events returned by epoll_wait
+	int ready_no = 0; // number of ready descriptors
+	struct connection* connection = NULL; // client which is ready
+	int fd; // client which is ready
 	int err; // placeholder for functions' output values
-	int sig; // used to denote received signal
+
+	if (reactor->pinned) pin_thread(&(reactor->cpus));
 	while (1)
 	{
-		EXIT_IF_NEQ(err, 0, sigwait(set, &sig), sigwait);
-		switch (sig)
+		ready_no = epoll_wait(fd_epoll, ready_events, MAXEVENTS, -1);
+		if (ready_no == -1)
 		{
-			case SIGINT:
-			case SIGQUIT:
-				terminate = 1;
-				return NULL;
+			if (errno == EINTR) continue;
+			perror("epoll_wait");
+			exit(EXIT_FAILURE);
+		}
+		for (int j = 0; j < ready_no; j++)
+		{
+			fd = ready_events[j].data.fd;
+			if (fd == reactor->fd_stop) return NULL;
+			connection = &(reactor->workers_args.connections[fd]);
+			// replies left to reactor are sent first: client's requests are received only once they have all been sent
+			if (connection->output_no != 0)
+			{
+				err = send_output(connection, fd);
+				if (err == 0)
+				{
+					monitor_client(&(reactor->workers_args), fd, false);
+					continue;
+				}
+				if (err == -1) connection->left = true;
+			}
+			// client is waited for again until its request has been fully received
+			if (!connection->left && !receive_available(connection, fd))
+			{
+				monitor_client(&(reactor->workers_args), fd, false);
+				continue;
+			}
+			// hand ready file descriptor to reactor's workers
+			schedule_client(&(reactor->workers_args), fd);
+		}
+	}
+}
 
-			case SIGHUP:
-				no_more_clients = 1;
-				return NULL;
+static struct pending_clients*
+PendingClients_Init(size_t capacity)
+{
+	int errnocopy;
+	struct pending_clients* tmp = (struct pending_clients*) malloc(sizeof(struct pending_clients));
+	if (!tmp) return NULL;
+	tmp->fds = (int*) malloc(sizeof(int) * capacity);
+	if (!tmp->fds) goto failure;
+	tmp->fds_no = 0;
+	tmp->fd_wakeup = eventfd(0, EFD_CLOEXEC);
+	if (tmp->fd_wakeup == -1) goto failure;
+	if ((errno = pthread_mutex_init(&(tmp->mutex), NULL)) != 0)
+	{
+		errnocopy = errno;
+		close(tmp->fd_wakeup);
+		errno = errnocopy;
+		goto failure;
+	}
+	return tmp;
 
-			default:
-				break;
-		}
+	failure:
+		errnocopy = errno;
+		free(tmp->fds);
+		free(tmp);
+		errno = errnocopy;
+		return NULL;
+}
+
+static void
+PendingClients_Free(struct pending_clients* pending)
+{
+	if (!pending) return;
+	pthread_mutex_destroy(&(pending->mutex));
+	close(pending->fd_wakeup);
+	free(pending->fds);
+	free(pending);
+}
+
+static struct scheduler*
+Scheduler_Init(size_t min_workers_no, size_t workers_no, size_t max_workers_no)
+{
+	int errnocopy;
+	struct scheduler* tmp = (struct scheduler*) malloc(sizeof(struct scheduler));
+	if (!tmp) return NULL;
+	tmp->workers_no = max_workers_no;
+	tmp->min_workers_no = min_workers_no;
+	tmp->active = workers_no;
+	tmp->next = 0;
+	tmp->stop = 0;
+	tmp->wait_total = 0;
+	tmp->waited_no = 0;
+	tmp->idle = (int*) calloc(max_workers_no, sizeof(int));
+	tmp->idle_since = (uint64_t*) calloc(max_workers_no, sizeof(uint64_t));
+	tmp->queues = (task_queue_t**) calloc(max_workers_no, sizeof(task_queue_t*));
+	tmp->overflows = (struct overflow*) calloc(max_workers_no, sizeof(struct overflow));
+	if (!tmp->idle || !tmp->idle_since || !tmp->queues || !tmp->overflows) goto failure;
+	for (size_t i = 0; i < max_workers_no; i++)
+	{
+		if ((errno = pthread_mutex_init(&(tmp->overflows[i].mutex), NULL)) != 0) goto failure;
+		tmp->queues[i] = TaskQueue_Init(MAXTASKS);
+		if (!tmp->queues[i]) goto failure;
 	}
+	return tmp;
+
+	failure:
+		errnocopy = errno;
+		Scheduler_Free(tmp);
+		errno = errnocopy;
+		return NULL;
 }
 
-static void*
-worker_routine(void* arg)
+static void
+Scheduler_Free(struct scheduler* scheduler)
 {
-	// -------------------------------------
-	// DECLARATIONS NEEDED TO PARSE MESSAGES
-	// -------------------------------------
-	char* request; // request as a string
-	EXIT_IF_EQ(request, NULL, (char*) malloc(sizeof(char) * REQUESTLEN), malloc);
-	struct workers_args* workers_args = (struct workers_args*) arg;
-	bounded_buffer_t* tasks = workers_args->tasks;
-	storage_t* storage = workers_args->storage;
-	FILE* log_file = workers_args->log_file;
-	int pipe_output_channel = workers_args->pipe_output_channel;
-	int err; // used as a placeholder for functions' output values
-	int tmp_err; // used as a placeholder for functions' output values
-	int errnocopy; // copy of errno value
-	char* fd_ready_string; // currently being served client as a string
-	char* token = NULL; // token for strtok_r
-	char* saveptr = NULL; // saveptr for strtok_r
-	int fd_ready; // currently being served client
-	opcodes_t request_type; // type of request to be handled
-	char* tmp_request; // copy of request as a string
-	char pathname[REQUESTLEN]; // used to denote pathname for operations on storage
-	char pipe_buffer[PIPEBUFFERLEN]; // buffer to be written on pipe
-	char msg_size[SIZELEN]; // used when reading or sending the length of the following message
+	if (!scheduler) return;
+	if (scheduler->queues)
+		for (size_t i = 0; i < scheduler->workers_no; i++)
+			TaskQueue_Free(scheduler->queues[i]);
+	if (scheduler->overflows)
+	{
+		for (size_t i = 0; i < scheduler->workers_no; i++)
+		{
+			pthread_mutex_destroy(&(scheduler->overflows[i].mutex));
+			free(scheduler->overflows[i].fds);
+		}
+	}
+	free(scheduler->queues);
+	free(scheduler->overflows);
+	free(scheduler->idle);
+	free(scheduler->idle_since);
+	free(scheduler);
+}
 
-	// --------------------------------------------
-	// DECLARATIONS NEEDED TO INTERACT WITH STORAGE
-	// --------------------------------------------
-	linked_list_t* evicted = NULL; // used to store evicted files
-	char* evicted_file_name = NULL; // name of evicted file
-	char* evicted_file_content = NULL; // content of evicted file
-	size_t evicted_file_size = 0; // size of evicted file content
-	void* read_buf = NULL; // buffer used for reading operation (USED TO HANDLE readFile)
-	size_t read_size = 0; // size of read_buf (USED TO HANDLE readFile)
-	void* append_buf = NULL; // buffer used for append operation (USED TO HANDLE appendToFile)
-	size_t append_size = 0; // size of buffer to be appended (USED TO HANDLE appendToFile)
-	int flags = 0; // used to denote flags for operations on storage (USED TO HANDLE openFile)
-	size_t write_size = 0; // used to denote size of contents to be written (USED TO HANDLE writeFile)
-	char* write_contents = NULL; // buffer of contents to be written (USED TO HANDLE writeFILE)
-	linked_list_t* read_files = NULL; // list of files read when interacting with a readNFiles request (USED TO HANDLE readNFiles)
-	char* read_file_name = NULL; // used to denote name of read file (USED TO HANDLE readNFiles)
-	char* read_file_content = NULL; // buffer of read file's contents (USED TO HANDLE readNFiles)
-	size_t read_file_size = 0; // size of read file content (USED TO HANDLE readNFiles)
-	size_t tot_read_size = 0; // total read size
-	size_t N = 0; // number of files to be read (USED TO HANDLE readNFiles)
-	while(1)
+static bool
+is_metadata_request(const struct workers_args* reactor_args, int fd)
+{
+	const struct connection* connection = &(reactor_args->connections[fd]);
+	size_t length; // length of the request
+	request_header_t header; // header of a binary request
+	uint64_t args[2]; // offset and length of the slice of a binary READ_RANGE request
+	int opcode;
+	size_t size = 0; // payload moved by the request
+
+	// requests making up a batch are served along with it
+	if (connection->left || connection->batched != 0 || connection->received < sizeof(request_header_t)) return false;
+	length = frame_length(connection->request);
+	// requests are classified only once they have been fully received
+	if (length == 0 || connection->received < length) return false;
+	if (IS_BINARY_FRAME(connection->request))
 	{
-		// reset task string
-		fd_ready_string = NULL;
-		// read ready fd from tasks' queue
-		EXIT_IF_NEQ(err, 0, BoundedBuffer_Dequeue(tasks, &fd_ready_string), BoundedBuffer_Dequeue);
-		EXIT_IF_NEQ(err, 1, sscanf(fd_ready_string, "%d", &fd_ready), sscanf);
-		if (fd_ready == TERMINATE_WORKER) // termination message
+		memcpy(&header, connection->request, sizeof(request_header_t));
+		opcode = (int) header.opcode;
+		size = (size_t) header.payload_len;
+		if (opcode == READ_RANGE)
 		{
-			free(fd_ready_string);
-			break;
+			// numerical arguments are carried by the payload
+			if (size != sizeof(args) || connection->received < length + sizeof(args)) return false;
+			memcpy(args, connection->request + length, sizeof(args));
+			size = (size_t) args[1];
 		}
-		memset(request, 0, TASKLEN);
-		EXIT_IF_EQ(err, -1, readn((long) fd_ready, (void*) request, REQUESTLEN), readn);
-		// request now contains the operation to be run and its arguments as a string
-		tmp_request = request;
-		token = strtok_r(tmp_request, " ", &saveptr);
-		if (!token) NEXT_ITERATION;
-		EXIT_IF_NEQ(err, 1, sscanf(token, "%d", (int*) &request_type), sscanf);
-		switch (request_type)
-		{
-			case OPEN:
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				flags = 0;
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%d", &flags), sscanf);
-				err = Storage_openFile(storage, pathname, flags, fd_ready);
-				errnocopy = errno;
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] openFile %s %d : %d.\n", (int) pthread_self(), pathname, flags, err);
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+	}
+	else
+	{
+		// text requests are NUL-terminated within their frame
+		if (!memchr(connection->request, '\0', REQUESTLEN)) return false;
+		if (sscanf(connection->request, "%d", &opcode) != 1) return false;
+		if ((opcode == WRITE || opcode == APPEND) && sscanf(connection->request, "%*d %*s %lu", &size) != 1)
+			return false;
+		if (opcode == READ_RANGE && sscanf(connection->request, "%*d %*s %*u %lu", &size) != 1) return false;
+	}
+	switch (opcode)
+	{
+		case OPEN:
+		case CLOSE:
+		case LOCK:
+		case UNLOCK:
+		case REMOVE:
+		case STAT:
+		case TERMINATE:
+			return true;
+
+		case WRITE:
+		case APPEND:
+		case READ_RANGE:
+			return size <= reactor_args->metadata_threshold;
+
+		// the size of whole files is not known before they are looked up
+		default:
+			return false;
+	}
+}
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
+static uint32_t
+path_hash(const char* pathname)
+{
+	uint32_t hash = 2166136261u;
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						exit(1);
-				}
-				flags = 0;
-				REQUEST_DONE;
-				break;
+	for (; *pathname != '\0'; pathname++)
+		hash = (hash ^ (uint8_t) *pathname) * 16777619u;
+	return hash;
+}
 
-			case CLOSE:
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				err = Storage_closeFile(storage, pathname, fd_ready);
-				errnocopy = errno;
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] closeFile %s : %d.\n", (int) pthread_self(), pathname, err);
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+static bool
+frame_path(const char* frame, char* pathname)
+{
+	request_header_t header; // header of a binary request
+	int opcode;
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
+	if (IS_BINARY_FRAME(frame))
+	{
+		memcpy(&header, frame, sizeof(request_header_t));
+		if (header.path_len == 0 || header.path_len >= REQUESTLEN - sizeof(request_header_t)) return false;
+		opcode = (int) header.opcode;
+		memcpy(pathname, frame + sizeof(request_header_t), header.path_len);
+		pathname[header.path_len] = '\0';
+	}
+	else
+	{
+		// text requests are NUL-terminated within their frame
+		if (!memchr(frame, '\0', REQUESTLEN)) return false;
+		if (sscanf(frame, "%d %s", &opcode, pathname) != 2) return false;
+	}
+	switch (opcode)
+	{
+		case OPEN:
+		case CLOSE:
+		case READ:
+		case WRITE:
+		case APPEND:
+		case LOCK:
+		case UNLOCK:
+		case REMOVE:
+		case READ_RANGE:
+		case STAT:
+			return true;
+
+		default:
+			return false;
+	}
+}
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						exit(1);
-				}
-				REQUEST_DONE;
-				break;
+static struct workers_args*
+home_reactor(const struct workers_args* reactor_args, int fd)
+{
+	const struct placement* placement = reactor_args->placement;
+	const struct connection* connection = &(reactor_args->connections[fd]);
+	char pathname[REQUESTLEN]; // file request is run on
+	size_t length; // length of the request
+	size_t node; // index of the node file has been assigned to
+	size_t count; // number of reactors running on that node
+
+	if (placement->nodes_no <= 1) return connection->reactor_args;
+	// requests making up a batch are served along with it
+	if (connection->left || connection->batched != 0 || connection->received < sizeof(request_header_t))
+		return connection->reactor_args;
+	length = frame_length(connection->request);
+	if (length == 0 || connection->received < length || !frame_path(connection->request, pathname))
+		return connection->reactor_args;
+	node = (size_t) (path_hash(pathname) % placement->nodes_no);
+	if (node == connection->reactor_args->node) return connection->reactor_args;
+	// clients are spread over the reactors of the node the same way they are spread over workers
+	count = placement->first[node + 1] - placement->first[node];
+	return placement->reactors[placement->first[node] + (size_t) fd % count];
+}
 
-			case READ:
-				read_buf = NULL;
-				read_size = 0;
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				// check whether file to be read's
-				// size and contents are to be saved
-				flags = 0;
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%d", &flags), sscanf);
-				if (flags == 1)
-				{
-					err = Storage_readFile(storage, pathname, &read_buf, &read_size, fd_ready);
-					errnocopy = errno;
-					// send return value
-					memset(request, 0, REQUESTLEN);
-					snprintf(request, REQUESTLEN, "%d", err);
-					LOG_EVENT("[%d] readFile %s : %d -> %lu.\n", (int) pthread_self(), pathname, err, read_size);
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-					switch (err)
-					{
-						case OP_SUCCESS:
-							break;
+static void
+schedule_client(struct workers_args* reactor_args, int fd)
+{
+	int idle = 1; // expected value of an idle worker's flag
+	struct workers_args* home = home_reactor(reactor_args, fd); // reactor whose workers are to serve client
+	struct scheduler* scheduler = home->scheduler;
+	struct connection* connection = &(reactor_args->connections[fd]);
+	int* last = &(connection->worker); // worker which served client last
+	size_t target; // worker client is placed on
+	size_t active;
+
+	if (home->metadata_scheduler && is_metadata_request(home, fd))
+	{
+		scheduler = home->metadata_scheduler;
+		last = &(connection->metadata_worker);
+	}
+	active = __atomic_load_n(&(scheduler->active), __ATOMIC_SEQ_CST);
+	// new clients, as well as those of retired workers, are placed round-robin
+	if (*last == -1 || (size_t) *last >= active)
+		*last = (int) (__atomic_fetch_add(&(scheduler->next), 1, __ATOMIC_RELAXED) % active);
+	target = (size_t) *last;
+	connection->queued_at = now_ns();
+	enqueue_task(scheduler, target, fd);
+	if (__atomic_load_n(&(scheduler->idle[target]), __ATOMIC_SEQ_CST)) return;
+	// target is busy: an idle worker is claimed and nudged so that it steals the client
+	for (size_t i = 1; i < scheduler->workers_no; i++)
+	{
+		size_t sibling = (target + i) % scheduler->workers_no;
+		if (__atomic_compare_exchange_n(&(scheduler->idle[sibling]), &idle, 0, false,
+					__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+		{
+			nudge_worker(scheduler, sibling);
+			return;
+		}
+		idle = 1;
+	}
+}
 
-						case OP_FAILURE:
-							memset(request, 0, REQUESTLEN);
-							snprintf(request, REQUESTLEN, "%d", errnocopy);
-							EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-							break;
+static void
+enqueue_task(struct scheduler* scheduler, size_t worker, int task)
+{
+	int err;
+	struct overflow* overflow = &(scheduler->overflows[worker]);
+	int* tmp;
 
-						case OP_FATAL:
-							memset(request, 0, REQUESTLEN);
-							snprintf(request, REQUESTLEN, "%d", errnocopy);
-							EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-							exit(1);
-					}
-					// send size
-					memset(msg_size, 0, SIZELEN);
-					snprintf(msg_size, SIZELEN, "%lu", read_size);
-					EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-					if (read_size != 0)
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, read_buf, read_size), writen);
-					free(read_buf); read_buf = NULL;
-				}
-				else
-				{
-					err = Storage_readFile(storage, pathname, NULL, NULL, fd_ready);
-					errnocopy = errno;
-					// send return value
-					memset(request, 0, REQUESTLEN);
-					snprintf(request, REQUESTLEN, "%d", err);
-					LOG_EVENT("[%d] readFile %s NULL: %d -> %lu.\n", (int) pthread_self(), pathname, err, read_size);
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-					switch (err)
-					{
-						case OP_SUCCESS:
-							break;
+	// tasks which have found the queue full are not overtaken
+	if (__atomic_load_n(&(overflow->pending), __ATOMIC_SEQ_CST) == 0)
+	{
+		EXIT_IF_EQ(err, -1, TaskQueue_TryEnqueue(scheduler->queues[worker], task), TaskQueue_TryEnqueue);
+		if (err == 1) return;
+	}
+	EXIT_IF_NEQ(err, 0, pthread_mutex_lock(&(overflow->mutex)), pthread_mutex_lock);
+	if (overflow->len == overflow->capacity)
+	{
+		// room taken by moved tasks is reclaimed before growing
+		if (overflow->head != 0)
+		{
+			memmove(overflow->fds, overflow->fds + overflow->head, sizeof(int) * (overflow->len - overflow->head));
+			overflow->len -= overflow->head;
+			overflow->head = 0;
+		}
+		else
+		{
+			overflow->capacity = (overflow->capacity == 0) ? MAXTASKS : 2 * overflow->capacity;
+			EXIT_IF_EQ(tmp, NULL, (int*) realloc(overflow->fds, sizeof(int) * overflow->capacity), realloc);
+			overflow->fds = tmp;
+		}
+	}
+	overflow->fds[overflow->len++] = task;
+	__atomic_store_n(&(overflow->pending), overflow->len - overflow->head, __ATOMIC_SEQ_CST);
+	EXIT_IF_NEQ(err, 0, pthread_mutex_unlock(&(overflow->mutex)), pthread_mutex_unlock);
+	// worker may have emptied its queue and gone to sleep before task was listed
+	nudge_worker(scheduler, worker);
+}
 
-						case OP_FAILURE:
-							memset(request, 0, REQUESTLEN);
-							snprintf(request, REQUESTLEN, "%d", errnocopy);
-							EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-							break;
+static void
+nudge_worker(struct scheduler* scheduler, size_t worker)
+{
+	int err;
 
-						case OP_FATAL:
-							memset(request, 0, REQUESTLEN);
-							snprintf(request, REQUESTLEN, "%d", errnocopy);
-							EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-							exit(1);
-					}
-				}
-				flags = 0;
-				REQUEST_DONE;
-				break;
+	EXIT_IF_EQ(err, -1, TaskQueue_TryEnqueue(scheduler->queues[worker], NUDGE_WORKER), TaskQueue_TryEnqueue);
+}
 
-			case WRITE:
-				evicted = NULL;
-				evicted_file_name = NULL;
-				evicted_file_content = NULL;
-				write_contents = NULL;
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				// get content size
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &write_size), sscanf);
-				// allocate enough memory for contents
-				if (write_size != 0)
-				{
-					EXIT_IF_EQ(write_contents, NULL, (char*) malloc(write_size + 1), malloc);
-					memset(write_contents, 0, write_size + 1);
-					EXIT_IF_EQ(err, -1, readn((long) fd_ready, (void*) write_contents, write_size), readn);
-				}
-				err = Storage_writeFile(storage, pathname, write_size, write_contents, &evicted, fd_ready);
-				errnocopy = errno;
-				free(write_contents);
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] writeFile %s : %d -> %lu.\n\tVictims : %lu.\n", (int) pthread_self(), pathname, err,
-							write_size, LinkedList_GetNumberOfElements(evicted));
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+static void
+refill_queue(struct scheduler* scheduler, size_t worker)
+{
+	int err;
+	struct overflow* overflow = &(scheduler->overflows[worker]);
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
+	if (__atomic_load_n(&(overflow->pending), __ATOMIC_SEQ_CST) == 0) return;
+	EXIT_IF_NEQ(err, 0, pthread_mutex_lock(&(overflow->mutex)), pthread_mutex_lock);
+	while (overflow->head != overflow->len)
+	{
+		EXIT_IF_EQ(err, -1, TaskQueue_TryEnqueue(scheduler->queues[worker], overflow->fds[overflow->head]),
+					TaskQueue_TryEnqueue);
+		if (err == 0) break;
+		overflow->head++;
+	}
+	if (overflow->head == overflow->len) overflow->head = overflow->len = 0;
+	__atomic_store_n(&(overflow->pending), overflow->len - overflow->head, __ATOMIC_SEQ_CST);
+	EXIT_IF_NEQ(err, 0, pthread_mutex_unlock(&(overflow->mutex)), pthread_mutex_unlock);
+}
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
-				}
-				// send number of victims
-				memset(msg_size, 0, SIZELEN);
-				snprintf(msg_size, SIZELEN, "%lu", LinkedList_GetNumberOfElements(evicted));
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-				// send victims if any
-				while (LinkedList_GetNumberOfElements(evicted) != 0)
-				{
-					errno = 0;
-					evicted_file_size = LinkedList_PopFront(evicted, &evicted_file_name, (void**) &evicted_file_content);
-					if (evicted_file_size == 0 && errno == ENOMEM) exit(1);
-					memset(request, 0, REQUESTLEN);
-					snprintf(request, REQUESTLEN, "%s", evicted_file_name); // should error handle this
-					// send victim's name
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, REQUESTLEN), writen);
-					LOG_EVENT("\tVictim name: %s.\n", evicted_file_name);
-					// send victim's contents size
-					memset(msg_size, 0, SIZELEN);
-					snprintf(msg_size, SIZELEN, "%lu", evicted_file_size);
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-					// send actual contents
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) evicted_file_content, evicted_file_size), writen);
-					free(evicted_file_name); evicted_file_name = NULL;
-					free(evicted_file_content); evicted_file_content = NULL;
-				}
-				LinkedList_Free(evicted); evicted = NULL;
-				if (err == OP_FATAL) exit(1);
-				REQUEST_DONE;
-				break;
+/**
+ * @brief Steals a task from the queue of any sibling of given worker.
+ * @returns true if a task has been stolen, false otherwise.
+ * @note Server exits on failure.
+*/
+static bool
+steal_task(struct scheduler* scheduler, size_t worker, int* fdptr)
+{
+	int err;
+	size_t sibling;
 
-			case APPEND:
-				evicted = NULL;
-				append_buf = NULL;
-				append_size = 0;
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				// get buffer size
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &append_size), sscanf);
-				// allocate memory for the buffer
-				if (append_size != 0)
-				{
-					EXIT_IF_EQ(append_buf, NULL, malloc(append_size + 1), malloc);
-					memset(append_buf, 0, append_size + 1);
-					EXIT_IF_EQ(err, -1, readn((long) fd_ready, append_buf, append_size), readn);
-				}
-				err = Storage_appendToFile(storage, pathname, append_buf, append_size, &evicted, fd_ready);
-				errnocopy = errno;
-				free(append_buf);
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] appendToFile %s : %d -> %lu.\n\tVictims : %lu.\n", (int) pthread_self(), pathname,
-							err, append_size, LinkedList_GetNumberOfElements(evicted));
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+	for (size_t i = 1; i < scheduler->workers_no; i++)
+	{
+		sibling = (worker + i) % scheduler->workers_no;
+		EXIT_IF_EQ(err, -1, TaskQueue_TryDequeue(scheduler->queues[sibling], fdptr), TaskQueue_TryDequeue);
+		if (err == 0) continue;
+		if (*fdptr != NUDGE_WORKER) return true;
+		// nudges are meant for their owner
+		nudge_worker(scheduler, sibling);
+	}
+	return false;
+}
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
+static int
+next_task(struct scheduler* scheduler, size_t worker)
+{
+	int err;
+	int fd;
+	task_queue_t* own = scheduler->queues[worker];
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
-				}
-				// send number of victims
-				memset(msg_size, 0, SIZELEN);
-				snprintf(msg_size, SIZELEN, "%lu", LinkedList_GetNumberOfElements(evicted));
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-				// send victims if any
-				while (LinkedList_GetNumberOfElements(evicted) != 0)
-				{
-					errno = 0;
-					evicted_file_size = LinkedList_PopFront(evicted, &evicted_file_name, (void**) &evicted_file_content);
-					if (evicted_file_size == 0 && errno == ENOMEM) exit(1);
-					memset(request, 0, REQUESTLEN);
-					snprintf(request, REQUESTLEN, "%s", evicted_file_name); // should error handle this
-					// send victim's name
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, REQUESTLEN), writen);
-					LOG_EVENT("\tVictim name: %s.\n", evicted_file_name);
-					// send victim's contents size
-					memset(msg_size, 0, SIZELEN);
-					snprintf(msg_size, SIZELEN, "%lu", evicted_file_size);
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-					// send actual contents
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) evicted_file_content, evicted_file_size), writen);
-					free(evicted_file_name); evicted_file_name = NULL;
-					free(evicted_file_content); evicted_file_content = NULL;
-				}
-				LinkedList_Free(evicted); evicted = NULL;
-				if (err == OP_FATAL) exit(1);
-				REQUEST_DONE;
-				break;
+	while (1)
+	{
+		refill_queue(scheduler, worker);
+		EXIT_IF_EQ(err, -1, TaskQueue_TryDequeue(own, &fd), TaskQueue_TryDequeue);
+		if (err == 1 && fd != NUDGE_WORKER) return fd;
+		// retired workers only serve clients which have been placed on them before they were retired
+		if (worker >= __atomic_load_n(&(scheduler->active), __ATOMIC_SEQ_CST)) return TERMINATE_WORKER;
+		if (steal_task(scheduler, worker, &fd)) return fd;
+		if (__atomic_load_n(&(scheduler->stop), __ATOMIC_SEQ_CST)) return TERMINATE_WORKER;
+		__atomic_store_n(&(scheduler->idle_since[worker]), now_ns(), __ATOMIC_RELAXED);
+		__atomic_store_n(&(scheduler->idle[worker]), 1, __ATOMIC_SEQ_CST);
+		// a client may have been placed on a busy sibling before worker was marked as idle
+		if (steal_task(scheduler, worker, &fd))
+		{
+			__atomic_store_n(&(scheduler->idle[worker]), 0, __ATOMIC_SEQ_CST);
+			return fd;
+		}
+		EXIT_IF_NEQ(err, 0, TaskQueue_Dequeue(own, &fd), TaskQueue_Dequeue);
+		__atomic_store_n(&(scheduler->idle[worker]), 0, __ATOMIC_SEQ_CST);
+		if (fd != NUDGE_WORKER) return fd;
+	}
+}
 
-			case READ_N:
-				read_files = NULL;
-				N = 0;
-				// get N
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &N), sscanf);
-				err = Storage_readNFiles(storage, &read_files, N, fd_ready);
-				errnocopy = errno;
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+static void
+control_workers(const struct controller* controller, struct reactor* reactors, size_t reactors_no,
+			struct worker* workers, event_log_t* event_log)
+{
+	int err;
+	int idle = 1; // expected value of an idle worker's flag
+	uint64_t now = now_ns();
+	struct scheduler* scheduler;
+	struct worker* worker;
+	size_t active; // number of workers serving reactor's clients
+	size_t depth; // number of clients waiting for a worker
+	uint64_t waited_no; // number of clients taken from queues since last check
+	uint64_t wait; // average time clients have waited for since last check, in microseconds
+	uint64_t idle_for; // time the last worker has been idle for, in milliseconds
+
+	for (size_t r = 0; r < reactors_no; r++)
+	{
+		scheduler = reactors[r].workers_args.scheduler;
+		active = __atomic_load_n(&(scheduler->active), __ATOMIC_SEQ_CST);
+		waited_no = __atomic_exchange_n(&(scheduler->waited_no), 0, __ATOMIC_RELAXED);
+		wait = __atomic_exchange_n(&(scheduler->wait_total), 0, __ATOMIC_RELAXED);
+		wait = (waited_no != 0) ? wait / waited_no / 1000 : 0;
+		depth = 0;
+		for (size_t k = 0; k < scheduler->workers_no; k++)
+		{
+			depth += TaskQueue_GetNumberOfElements(scheduler->queues[k]);
+			// retired workers which have exited are joined so that their slot may be reused
+			worker = &(workers[k * reactors_no + r]);
+			if (k >= active && worker->started && __atomic_load_n(&(worker->exited), __ATOMIC_SEQ_CST))
+			{
+				pthread_join(worker->thread, NULL);
+				worker->started = false;
+			}
+		}
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
+		if ((wait > controller->wait_threshold || depth > controller->depth_threshold)
+				&& active < scheduler->workers_no)
+		{
+			worker = &(workers[active * reactors_no + r]);
+			// slot is still taken by a retired worker serving its last clients
+			if (worker->started) continue;
+			worker->id = active;
+			worker->workers_args = &(reactors[r].workers_args);
+			worker->scheduler = scheduler;
+			worker->exited = 0;
+			__atomic_store_n(&(scheduler->active), active + 1, __ATOMIC_SEQ_CST);
+			err = pthread_create(&(worker->thread), NULL, &worker_routine, (void*) worker);
+			if (err != 0)
+			{
+				__atomic_store_n(&(scheduler->active), active, __ATOMIC_SEQ_CST);
+				LOG_EVENT(NULL, .event = LOG_RESIZE_FAILED, .fd = (int32_t) r, .status = err);
+				continue;
+			}
+			worker->started = true;
+			LOG_EVENT(NULL, .event = LOG_SCALE_UP, .fd = (int32_t) r, .args = { active, active + 1 }, .bytes = wait,
+						.count = depth);
+			continue;
+		}
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request, ERRNOLEN), writen);
-						break;
-				}
-				// send number of successfully read files
-				memset(msg_size, 0, SIZELEN);
-				snprintf(msg_size, SIZELEN, "%lu", LinkedList_GetNumberOfElements(read_files));
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-				// send read files if any
-				while (LinkedList_GetNumberOfElements(read_files) != 0)
-				{
-					errno = 0;
-					read_file_size = LinkedList_PopFront(read_files, &read_file_name,
-								(void**) &read_file_content);
-					if (read_file_size == 0 && errno == ENOMEM) exit(1);
-					tot_read_size += read_file_size;
-					memset(request, 0, REQUESTLEN);
-					snprintf(request, REQUESTLEN, "%s", read_file_name); // should error handle this
-					// send file's name
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request, REQUESTLEN), writen);
-					// send file's contents size
-					memset(msg_size, 0, SIZELEN);
-					snprintf(msg_size, SIZELEN, "%lu", read_file_size);
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) msg_size, SIZELEN), writen);
-					// send actual contents
-					EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*)
-								read_file_content, read_file_size), writen);
-					free(read_file_name); read_file_name = NULL;
-					free(read_file_content); read_file_content = NULL;
-				}
-				LinkedList_Free(read_files); read_files = NULL;
-				LOG_EVENT("[%d] readNFiles %lu : %d -> %lu.\n", (int) pthread_self(), N, err, tot_read_size);
-				if (err == OP_FATAL) exit(1);
-				REQUEST_DONE;
-				break;
+		// only the worker taking the highest index is retired, so that active ones keep taking the lowest indexes
+		if (active <= scheduler->min_workers_no || depth != 0) continue;
+		if (!__atomic_load_n(&(scheduler->idle[active - 1]), __ATOMIC_SEQ_CST)) continue;
+		idle_for = (now - __atomic_load_n(&(scheduler->idle_since[active - 1]), __ATOMIC_RELAXED)) / 1000000;
+		if (idle_for < controller->cooldown) continue;
+		// worker is claimed so that reactor does not nudge it in the meantime
+		if (!__atomic_compare_exchange_n(&(scheduler->idle[active - 1]), &idle, 0, false,
+					__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+		{
+			idle = 1;
+			continue;
+		}
+		__atomic_store_n(&(scheduler->active), active - 1, __ATOMIC_SEQ_CST);
+		nudge_worker(scheduler, active - 1);
+		LOG_EVENT(NULL, .event = LOG_SCALE_DOWN, .fd = (int32_t) r, .args = { active, active - 1 }, .bytes = idle_for);
+	}
+}
 
-			case LOCK:
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				err = Storage_lockFile(storage, pathname, fd_ready);
-				errnocopy = errno;
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] lockFile %s %d : %d.\n", (int) pthread_self(), pathname, flags, err);
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request,
-							strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+/**
+ * @brief Gets the NUMA node given CPU lies on.
+ * @returns Id of the node, 0 if it cannot be told.
+*/
+static int
+cpu_node(int cpu)
+{
+	char path[64]; // directory describing cpu
+	DIR* dir = NULL;
+	struct dirent* entry = NULL;
+	int node = 0;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+	dir = opendir(path);
+	// kernels built without NUMA support have a single node
+	if (!dir) return 0;
+	while ((entry = readdir(dir)) != NULL)
+		if (sscanf(entry->d_name, "node%d", &node) == 1) break;
+	closedir(dir);
+	return node;
+}
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request,
-									ERRNOLEN), writen);
-						break;
+static int
+place_reactors(struct placement* placement, struct reactor* reactors, size_t reactors_no,
+			const int* reactors_cpus, size_t reactors_cpus_no, const int* workers_cpus, size_t workers_cpus_no)
+{
+	cpu_set_t allowed; // CPUs server may run on
+	int* reactor_node = NULL; // node each reactor runs on
+	int cpu;
+	size_t filled; // number of reactors grouped so far
+	size_t j, k;
+
+	if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == -1) return -1;
+	for (j = 0; j < reactors_cpus_no + workers_cpus_no; j++)
+	{
+		cpu = (j < reactors_cpus_no) ? reactors_cpus[j] : workers_cpus[j - reactors_cpus_no];
+		if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed))
+		{
+			errno = EINVAL;
+			return -1;
+		}
+	}
+	reactor_node = (int*) malloc(sizeof(int) * reactors_no);
+	if (!reactor_node) return -1;
+	for (j = 0; j < reactors_no; j++)
+	{
+		reactor_node[j] = -1;
+		if (reactors_cpus_no != 0)
+		{
+			reactors[j].pinned = true;
+			CPU_ZERO(&(reactors[j].cpus));
+			CPU_SET(reactors_cpus[j % reactors_cpus_no], &(reactors[j].cpus));
+			reactor_node[j] = cpu_node(reactors_cpus[j % reactors_cpus_no]);
+		}
+		if (workers_cpus_no == 0) continue;
+		reactors[j].workers_args.pinned = true;
+		CPU_ZERO(&(reactors[j].workers_args.workers_cpus));
+		for (k = 0; k < workers_cpus_no; k++)
+			if (reactor_node[j] == -1 || cpu_node(workers_cpus[k]) == reactor_node[j])
+				CPU_SET(workers_cpus[k], &(reactors[j].workers_args.workers_cpus));
+		// reactor's node has no workers' CPU: its workers may run on any of them
+		if (CPU_COUNT(&(reactors[j].workers_args.workers_cpus)) == 0)
+			for (k = 0; k < workers_cpus_no; k++)
+				CPU_SET(workers_cpus[k], &(reactors[j].workers_args.workers_cpus));
+	}
+	if (reactors_cpus_no == 0)
+	{
+		free(reactor_node);
+		return 0;
+	}
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request,
-									ERRNOLEN), writen);
-						exit(1);
-				}
-				REQUEST_DONE;
-				break;
+	// reactors are grouped by node
+	placement->nodes = (int*) malloc(sizeof(int) * reactors_no);
+	placement->reactors = (struct workers_args**) malloc(sizeof(struct workers_args*) * reactors_no);
+	placement->first = (size_t*) calloc(reactors_no + 1, sizeof(size_t));
+	if (!placement->nodes || !placement->reactors || !placement->first)
+	{
+		free(reactor_node);
+		Placement_Free(placement);
+		return -1;
+	}
+	placement->nodes_no = 0;
+	for (j = 0; j < reactors_no; j++)
+	{
+		for (k = 0; k < placement->nodes_no && placement->nodes[k] != reactor_node[j]; k++);
+		if (k == placement->nodes_no) placement->nodes[placement->nodes_no++] = reactor_node[j];
+		reactors[j].workers_args.node = k;
+		placement->first[k + 1]++;
+	}
+	for (k = 0; k < placement->nodes_no; k++)
+		placement->first[k + 1] += placement->first[k];
+	for (k = 0, filled = 0; k < placement->nodes_no; k++)
+		for (j = 0; j < reactors_no; j++)
+			if (reactors[j].workers_args.node == k) placement->reactors[filled++] = &(reactors[j].workers_args);
+	free(reactor_node);
+	return 0;
+}
 
-			case UNLOCK:
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				err = Storage_unlockFile(storage, pathname, fd_ready);
-				errnocopy = errno;
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] unlockFile %s %d : %d.\n", (int) pthread_self(), pathname, flags, err);
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request,
-							strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+static void
+Placement_Free(struct placement* placement)
+{
+	free(placement->nodes);
+	free(placement->reactors);
+	free(placement->first);
+	placement->nodes = NULL;
+	placement->reactors = NULL;
+	placement->first = NULL;
+	placement->nodes_no = 1;
+}
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request,
-									ERRNOLEN), writen);
-						break;
+static void
+pin_thread(const cpu_set_t* cpus)
+{
+	int err;
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request,
-									ERRNOLEN), writen);
-						exit(1);
-				}
-				REQUEST_DONE;
-				break;
+	EXIT_IF_NEQ(err, 0, pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), cpus), pthread_setaffinity_np);
+}
 
-			case REMOVE:
-				// get pathname
-				memset(pathname, 0, REQUESTLEN);
-				EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
-				EXIT_IF_NEQ(err, 1, sscanf(token, "%s", pathname), sscanf);
-				err = Storage_removeFile(storage, pathname, fd_ready);
-				errnocopy = errno;
-				// send return value
-				memset(request, 0, REQUESTLEN);
-				snprintf(request, REQUESTLEN, "%d", err);
-				LOG_EVENT("[%d] removeFile %s : %d.\n", (int) pthread_self(), pathname, err);
-				EXIT_IF_EQ(tmp_err, -1, writen((long) fd_ready, (void*) request,
-							strlen(request) + 1), writen);
-				switch (err)
-				{
-					case OP_SUCCESS:
-						break;
+static void*
+uring_reactor_routine(void* arg)
+{
+	struct reactor* reactor = (struct reactor*) arg;
+	io_ring_t* ring = reactor->workers_args.ring; // io_uring instance receiving reactor's requests
+	struct pending_clients* pending = reactor->workers_args.pending; // clients to be monitored again
+	struct connection* connections = reactor->workers_args.connections;
+	struct connection* connection = NULL; // client whose receipt has completed
+	io_ring_completion_t completions[MAXEVENTS]; // completed operations
+	int completed_no = 0; // number of completed operations
+	bool submit = false; // toggled on when any operation has been prepared
+	uint64_t wakeups = 0; // value read from eventfd
+	int* fds = NULL; // clients to be monitored again, as taken from pending ones
+	size_t fds_no = 0; // number of clients to be monitored again
+	int* tmp_fds = NULL; // used when swapping fds with pending ones
+	int fd; // client whose receipt has completed
+	int err; // placeholder for functions' output values
 
-					case OP_FAILURE:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request,
-									ERRNOLEN), writen);
-						break;
+	if (reactor->pinned) pin_thread(&(reactor->cpus));
+	EXIT_IF_EQ(fds, NULL, (int*) malloc(sizeof(int) * reactor->connections_no), malloc);
+	EXIT_IF_EQ(err, -1, IoRing_PreparePoll(ring, reactor->fd_stop, POLLIN, (uint64_t) reactor->fd_stop),
+				IoRing_PreparePoll);
+	EXIT_IF_EQ(err, -1, IoRing_PreparePoll(ring, pending->fd_wakeup, POLLIN, (uint64_t) pending->fd_wakeup),
+				IoRing_PreparePoll);
+	EXIT_IF_EQ(err, -1, IoRing_Submit(ring), IoRing_Submit);
+	while (1)
+	{
+		EXIT_IF_EQ(completed_no, -1, IoRing_WaitCompletions(ring, completions, MAXEVENTS), IoRing_WaitCompletions);
+		submit = false;
+		for (int j = 0; j < completed_no; j++)
+		{
+			fd = (int) completions[j].user_data;
+			if (fd == reactor->fd_stop)
+			{
+				free(fds);
+				return NULL;
+			}
+			// clients are to be monitored again: receipts are submitted all at once
+			if (fd == pending->fd_wakeup)
+			{
+				EXIT_IF_EQ(err, -1, readn((long) fd, (void*) &wakeups, sizeof(wakeups)), readn);
+				EXIT_IF_NEQ(err, 0, pthread_mutex_lock(&(pending->mutex)), pthread_mutex_lock);
+				tmp_fds = pending->fds; pending->fds = fds; fds = tmp_fds;
+				fds_no = pending->fds_no; pending->fds_no = 0;
+				EXIT_IF_NEQ(err, 0, pthread_mutex_unlock(&(pending->mutex)), pthread_mutex_unlock);
+				for (size_t k = 0; k < fds_no; k++)
+					if (uring_monitor_client(reactor, fds[k])) submit = true;
+				EXIT_IF_EQ(err, -1, IoRing_PreparePoll(ring, fd, POLLIN, (uint64_t) fd), IoRing_PreparePoll);
+				submit = true;
+				continue;
+			}
+			connection = &(connections[fd]);
+			// replies left to reactor are sent first: client's requests are received only once they have all been sent
+			if (completions[j].user_data & SOCKET_WRITABLE)
+			{
+				if (send_output(connection, fd) == -1) connection->left = true;
+			}
+			else if (completions[j].res > 0) receipt_done(connection, (size_t) completions[j].res);
+			// client closed its connection (or it has been reset)
+			else connection->left = true;
+			if (uring_monitor_client(reactor, fd)) submit = true;
+		}
+		if (submit) EXIT_IF_EQ(err, -1, IoRing_Submit(ring), IoRing_Submit);
+	}
+}
 
-					case OP_FATAL:
-						memset(request, 0, REQUESTLEN);
-						snprintf(request, REQUESTLEN, "%d", errnocopy);
-						EXIT_IF_EQ(err, -1, writen((long) fd_ready, (void*) request,
-									ERRNOLEN), writen);
-						exit(1);
-				}
-				REQUEST_DONE;
-				break;
+static void
+monitor_client(struct workers_args* reactor_args, int fd, bool first_time)
+{
+	int err;
+	struct epoll_event event;
+	struct connection* connection;
+	struct pending_clients* pending = reactor_args->pending;
+	bool wake_up = false; // toggled on when reactor is to be woken up
+	uint64_t one = 1; // value written to eventfd
+
+	connection = &(reactor_args->connections[fd]);
+	if (first_time)
+	{
+		if (!connection->request)
+			EXIT_IF_EQ(connection->request, NULL, (char*) malloc(REQUESTLEN), malloc);
+		connection->received = 0;
+		connection->consumed = 0;
+		connection->dropped = 0;
+		connection->payload_error = 0;
+		connection->reserved = false;
+		connection->left = false;
+		connection->worker = -1;
+		connection->metadata_worker = -1;
+		connection->batched = 0;
+		connection->deficit = 0;
+		connection->reactor_args = reactor_args;
+		connection->next_waiting = 0;
+	}
+	if (!reactor_args->ring)
+	{
+		// a oneshot registration makes sure no more than one worker serves a client at a time
+		memset(&event, 0, sizeof(event));
+		event.events = ((connection->output_no != 0) ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+		event.data.fd = fd;
+		EXIT_IF_EQ(err, -1, epoll_ctl(reactor_args->fd_epoll, first_time ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event),
+					epoll_ctl);
+		return;
+	}
+	// a single operation is pending at a time, so no more than one worker serves a client at a time:
+	// it is prepared by reactor, which is woken up only if it has no other client to handle
+	EXIT_IF_NEQ(err, 0, pthread_mutex_lock(&(pending->mutex)), pthread_mutex_lock);
+	pending->fds[pending->fds_no++] = fd;
+	wake_up = (pending->fds_no == 1);
+	EXIT_IF_NEQ(err, 0, pthread_mutex_unlock(&(pending->mutex)), pthread_mutex_unlock);
+	if (wake_up) EXIT_IF_EQ(err, -1, writen((long) pending->fd_wakeup, (void*) &one, sizeof(one)), writen);
+}
 
-			case TERMINATE:
-				memset(pipe_buffer, 0, PIPEBUFFERLEN);
-				snprintf(pipe_buffer, PIPEBUFFERLEN, "%d", TERMINATE_WORKER);
-				EXIT_IF_EQ(err, -1, writen((long) pipe_output_channel, (void*) pipe_buffer, PIPEBUFFERLEN), writen);
-				LOG_EVENT("Client left %d.\n", fd_ready);
+static bool
+uring_monitor_client(struct reactor* reactor, int fd)
+{
+	int err;
+	char* buf; // buffer the rest of the request is to be received into
+	size_t size; // number of bytes which may be received into buf
+	io_ring_t* ring = reactor->workers_args.ring;
+	struct connection* connection = &(reactor->workers_args.connections[fd]);
+
+	if (!connection->left && connection->output_no != 0)
+	{
+		EXIT_IF_EQ(err, -1, IoRing_PreparePoll(ring, fd, POLLOUT, (uint64_t) fd | SOCKET_WRITABLE), IoRing_PreparePoll);
+		return true;
+	}
+	if (!connection->left && (size = next_receipt(connection, &buf)) != 0)
+	{
+		EXIT_IF_EQ(err, -1, IoRing_PrepareRecv(ring, fd, buf, size, (uint64_t) fd), IoRing_PrepareRecv);
+		return true;
+	}
+	// hand ready file descriptor to reactor's workers
+	schedule_client(&(reactor->workers_args), fd);
+	return false;
+}
+
+static void*
+signal_handler_routine(void* arg)
+{
+	struct signal_handler_args* args = (struct signal_handler_args*) arg;
+	sigset_t* set = args->set; // used to denote signal set
+	int err; // placeholder for functions' output values
+	int sig; // used to denote received signal
+	uint64_t wake_up = 1; // value written to eventfd
+	while (1)
+	{
+		EXIT_IF_NEQ(err, 0, sigwait(set, &sig), sigwait);
+		switch (sig)
+		{
+			case SIGINT:
+			case SIGQUIT:
+				terminate = 1;
+				// main thread may be waiting for events
+				EXIT_IF_EQ(err, -1, writen((long) args->fd_signal, (void*) &wake_up, sizeof(wake_up)), writen);
+				return NULL;
+
+			case SIGHUP:
+				no_more_clients = 1;
+				EXIT_IF_EQ(err, -1, writen((long) args->fd_signal, (void*) &wake_up, sizeof(wake_up)), writen);
+				return NULL;
+
+			default:
 				break;
 		}
-		free(fd_ready_string);
 	}
+}
+
+static size_t
+frame_length(const char* buf)
+{
+	request_header_t header;
+
+	// text requests always take the same space
+	if (!IS_BINARY_FRAME(buf)) return REQUESTLEN;
+	memcpy(&header, buf, sizeof(request_header_t));
+	if (header.version != PROTOCOL_VERSION || header.path_len >= REQUESTLEN - sizeof(request_header_t)) return 0;
+	return sizeof(request_header_t) + header.path_len;
+}
+
+static int
+parse_text_request(char* buf, struct request* req)
+{
+	int err;
+	char* token = NULL; // token for strtok_r
+	char* saveptr = NULL; // saveptr for strtok_r
+
+	token = strtok_r(buf, " ", &saveptr);
+	if (!token) return -1;
+	EXIT_IF_NEQ(err, 1, sscanf(token, "%d", (int*) &(req->opcode)), sscanf);
+	switch (req->opcode)
+	{
+		case OPEN:
+		case READ:
+			// get pathname and flags
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%s", req->pathname), sscanf);
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%d", &(req->flags)), sscanf);
+			break;
+
+		case CLOSE:
+		case STAT:
+		case LOCK:
+		case UNLOCK:
+		case REMOVE:
+			// get pathname
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%s", req->pathname), sscanf);
+			break;
+
+		case WRITE:
+		case APPEND:
+			// get pathname and contents size
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%s", req->pathname), sscanf);
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &(req->size)), sscanf);
+			break;
+
+		case READ_RANGE:
+			// get pathname, offset and length of the slice
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%s", req->pathname), sscanf);
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &(req->args[0])), sscanf);
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &(req->args[1])), sscanf);
+			break;
+
+		case READ_N:
+			// get N
+			EXIT_IF_EQ(token, NULL, strtok_r(NULL, " ", &saveptr), strtok_r);
+			EXIT_IF_NEQ(err, 1, sscanf(token, "%lu", &(req->args[0])), sscanf);
+			// fall through: get prefix, if any
+
+		case LIST:
+			// get prefix, if any
+			token = strtok_r(NULL, " ", &saveptr);
+			if (token) EXIT_IF_NEQ(err, 1, sscanf(token, "%s", req->pathname), sscanf);
+			break;
+
+		case BATCH: // batches can only be sent as binary frames
+			return 0;
+
+		default:
+			break;
+	}
+	return 1;
+}
+
+static int
+receive_request(struct workers_args* workers_args, int fd, char* buf, struct request* req)
+{
+	struct connection* connection = &(workers_args->connections[fd]); // requests received from client
+	size_t length = sizeof(request_header_t); // length of the request, known as soon as its header has been received
+	request_header_t header; // header of a binary request
+	uint64_t args[2]; // numerical arguments of a binary request
+
+	memset(buf, 0, REQUESTLEN);
+	memset(req, 0, sizeof(struct request));
+	// reactors only hand clients whose request has been fully received, unless they have left
+	if (connection->left || connection->received < sizeof(request_header_t)) return 0;
+	length = frame_length(connection->request);
+	if (length == 0 || connection->received < length) return 0;
+	memcpy(buf, connection->request, length);
+	connection->consumed = length;
+	if (!IS_BINARY_FRAME(buf)) return parse_text_request(buf, req);
+
+	memcpy(&header, buf, sizeof(request_header_t));
+	req->binary = true;
+	req->id = header.request_id;
+	req->opcode = (opcodes_t) header.opcode;
+	req->flags = (int) header.flags;
+	memcpy(req->pathname, buf + sizeof(request_header_t), header.path_len);
+	req->size = (size_t) header.payload_len;
+	if (header.opcode > BATCH) return 0;
+	// requests making up a batch follow its count: they are served as any other request
+	if (req->opcode == BATCH)
+	{
+		if (req->size < sizeof(uint64_t)) return 0;
+		if (receive_payload(connection, (void*) args, sizeof(uint64_t)) == 0) return 0;
+		req->args[0] = (size_t) args[0];
+		req->size = 0;
+	}
+	// numerical arguments are carried by the payload
+	if (req->opcode == READ_RANGE || req->opcode == READ_N)
+	{
+		if (req->size > sizeof(args)) return 0;
+		memset(args, 0, sizeof(args));
+		if (receive_payload(connection, (void*) args, req->size) == 0) return 0;
+		req->args[0] = (size_t) args[0];
+		req->args[1] = (size_t) args[1];
+		req->size = 0;
+	}
+	return 1;
+}
+
+static int
+receive_payload(struct connection* connection, void* buf, size_t size)
+{
+	if (connection->received - connection->consumed < size) return 0;
+	memcpy(buf, connection->request + connection->consumed, size);
+	connection->consumed += size;
+	return 1;
+}
+
+static void*
+take_payload(struct connection* connection, size_t size)
+{
+	char* contents = NULL;
+
+	// contents too large to fit along with the request have been received into a buffer of their own
+	if (connection->payload)
+	{
+		contents = connection->payload;
+		connection->payload = NULL;
+		return (void*) contents;
+	}
+	if (connection->received - connection->consumed < size) return NULL;
+	EXIT_IF_EQ(contents, NULL, (char*) malloc(size + 1), malloc);
+	contents[size] = '\0';
+	receive_payload(connection, (void*) contents, size);
+	return (void*) contents;
+}
+
+static size_t
+payload_length(const char* buf, size_t max_payload)
+{
+	request_header_t header; // header of a binary request
+	int opcode;
+	size_t size = 0;
+
+	if (!IS_BINARY_FRAME(buf))
+	{
+		// text requests are NUL-terminated within their frame: only contents of written files follow them
+		if (!memchr(buf, '\0', REQUESTLEN) || sscanf(buf, "%d", &opcode) != 1) return 0;
+		if ((opcode == WRITE || opcode == APPEND) && sscanf(buf, "%*d %*s %lu", &size) == 1)
+			return (size <= max_payload) ? size : 0;
+		return 0;
+	}
+	memcpy(&header, buf, sizeof(request_header_t));
+	switch (header.opcode)
+	{
+		case WRITE:
+			// contents of a file space is being reserved for are sent only once it has been reserved
+			if (header.flags == WRITE_RESERVE) return 0;
+			// fall through
+
+		case APPEND:
+			// contents larger than the whole storage could never be stored: they are not buffered
+			return (header.payload_len <= max_payload) ? (size_t) header.payload_len : 0;
+
+		case READ_RANGE:
+		case READ_N:
+			// numerical arguments: longer ones make the request a malformed one
+			return (header.payload_len <= 2 * sizeof(uint64_t)) ? (size_t) header.payload_len : 0;
+
+		case BATCH:
+			// requests making up a batch follow its count: they are received one at a time
+			return sizeof(uint64_t);
+
+		default:
+			return 0;
+	}
+}
+
+static size_t
+next_receipt(struct connection* connection, char** bufptr)
+{
+	size_t length; // length of the request
+	size_t payload; // length of its payload
+
+	// payload of a failed request is received where the next request is to be and overwritten
+	if (connection->dropped != 0)
+	{
+		*bufptr = connection->request + connection->received;
+		return MIN(connection->dropped, REQUESTLEN - connection->received);
+	}
+	// request is handed to workers right away to be failed
+	if (connection->payload_error != 0) return 0;
+	if (connection->payload)
+	{
+		*bufptr = connection->payload + connection->payload_received;
+		return connection->payload_len - connection->payload_received;
+	}
+	*bufptr = connection->request + connection->received;
+	if (connection->received < sizeof(request_header_t)) return REQUESTLEN - connection->received;
+	length = frame_length(connection->request);
+	// malformed requests are handed to workers right away
+	if (length == 0) return 0;
+	if (connection->received < length) return REQUESTLEN - connection->received;
+	payload = payload_length(connection->request, connection->reactor_args->max_payload);
+	if (length + payload <= REQUESTLEN)
+		return (connection->received < length + payload) ? REQUESTLEN - connection->received : 0;
+	if (!expect_payload(connection, length, payload))
+	{
+		connection->payload_error = ENOMEM;
+		return 0;
+	}
+	return next_receipt(connection, bufptr);
+}
+
+static void
+receipt_done(struct connection* connection, size_t size)
+{
+	if (connection->dropped != 0) connection->dropped -= size;
+	else if (connection->payload) connection->payload_received += size;
+	else connection->received += size;
+}
+
+static bool
+expect_payload(struct connection* connection, size_t offset, size_t size)
+{
+	size_t moved = MIN(size, connection->received - offset); // bytes of the payload received along with the request
+
+	// a single request failing is better than the whole server exiting
+	if (!(connection->payload = (char*) malloc(size + 1))) return false;
+	connection->payload_len = size;
+	// pages are bound before they are first touched
+	bind_payload(connection);
+	connection->payload[size] = '\0';
+	memcpy(connection->payload, connection->request + offset, moved);
+	memmove(connection->request + offset, connection->request + offset + moved, connection->received - offset - moved);
+	connection->received -= moved;
+	connection->payload_received = moved;
+	return true;
+}
+
+static void
+drop_payload(struct connection* connection, size_t size)
+{
+	size_t moved = MIN(size, connection->received - connection->consumed); // bytes received along with the request
+
+	connection->consumed += moved;
+	connection->dropped = size - moved;
+}
+
+static void
+bind_payload(const struct connection* connection)
+{
+	const struct placement* placement = connection->reactor_args->placement;
+	char pathname[REQUESTLEN]; // file request is run on
+	int node; // node file has been assigned to
+	unsigned long mask; // nodes payload is bound to
+	uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+	uintptr_t start, end; // first and last page lying entirely within payload
+
+	if (placement->nodes_no <= 1 || connection->payload_len < BIND_THRESHOLD
+			|| !frame_path(connection->request, pathname))
+		return;
+	node = placement->nodes[path_hash(pathname) % placement->nodes_no];
+	if (node < 0 || (size_t) node >= sizeof(mask) * CHAR_BIT) return;
+	mask = 1UL << node;
+	// malloc's header shares the first page, which is left alone
+	start = ((uintptr_t) connection->payload + page - 1) & ~(page - 1);
+	end = ((uintptr_t) connection->payload + connection->payload_len + 1) & ~(page - 1);
+	if (end <= start) return;
+	(void) syscall(SYS_mbind, (void*) start, (unsigned long) (end - start), MPOL_PREFERRED, &mask,
+			sizeof(mask) * CHAR_BIT, 0);
+}
+
+static bool
+receive_available(struct connection* connection, int fd)
+{
+	char* buf; // buffer the rest of the request is to be received into
+	size_t size; // number of bytes which may be received into buf
+	ssize_t received; // number of bytes received by last system call
+
+	while ((size = next_receipt(connection, &buf)) != 0)
+	{
+		received = recv(fd, (void*) buf, size, MSG_DONTWAIT);
+		if (received == -1 && errno == EINTR) continue;
+		if (received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+		if (received == -1 && errno != ECONNRESET)
+		{
+			perror("recv");
+			exit(EXIT_FAILURE);
+		}
+		// client closed its connection (or it has been reset)
+		if (received <= 0)
+		{
+			connection->left = true;
+			return true;
+		}
+		receipt_done(connection, (size_t) received);
+	}
+	return true;
+}
+
+static bool
+next_request_received(struct connection* connection)
+{
+	size_t length;
+
+	connection->received -= connection->consumed;
+	memmove(connection->request, connection->request + connection->consumed, connection->received);
+	connection->consumed = 0;
+	// payload of the request which has just failed is still to be dropped
+	if (connection->dropped != 0 || connection->received < sizeof(request_header_t)) return false;
+	length = frame_length(connection->request);
+	// malformed requests are handled right away as well
+	if (length == 0) return true;
+	if (connection->received < length) return false;
+	// payloads too large to fit along with their request are left to the reactor
+	return (length + payload_length(connection->request, connection->reactor_args->max_payload)
+				<= connection->received);
+}
+
+static void
+reply_append(struct reply* reply, const void* buf, size_t size)
+{
+	struct iovec* last; // last buffer to be written
+
+	if (size == 0) return;
+	if (reply->buf_len + size > REPLY_BUFLEN || reply->iovcnt == REPLY_IOVECS) reply_flush(reply);
+	memcpy(reply->buf + reply->buf_len, buf, size);
+	// bytes copied right after the last ones are written along with them
+	last = (reply->iovcnt != 0) ? &(reply->iov[reply->iovcnt - 1]) : NULL;
+	if (last && (char*) last->iov_base + last->iov_len == reply->buf + reply->buf_len) last->iov_len += size;
+	else
+	{
+		reply->iov[reply->iovcnt].iov_base = (void*) (reply->buf + reply->buf_len);
+		reply->iov[reply->iovcnt].iov_len = size;
+		reply->owned[reply->iovcnt] = NULL;
+		reply->iovcnt++;
+	}
+	reply->buf_len += size;
+	reply->bytes_no += size;
+}
+
+static void
+reply_give(struct reply* reply, void* buf, size_t size)
+{
+	if (size <= reply->copy_threshold)
+	{
+		reply_append(reply, buf, size);
+		free(buf);
+		return;
+	}
+	if (reply->iovcnt == REPLY_IOVECS) reply_flush(reply);
+	reply->iov[reply->iovcnt].iov_base = buf;
+	reply->iov[reply->iovcnt].iov_len = size;
+	reply->owned[reply->iovcnt] = buf;
+	reply->iovcnt++;
+	reply->bytes_no += size;
+}
+
+static void
+reply_flush(struct reply* reply)
+{
+	ssize_t written; // bytes written by last system call
+	struct msghdr msg; // buffers yet to be written
+	int first = 0; // first buffer yet to be written whole
+	bool left = false; // toggled on when client has left
+
+	memset(&msg, 0, sizeof(msg));
+	// replies are sent in order: nothing is written as long as parts of the previous ones are yet to be sent
+	while (first != reply->iovcnt && reply->connection->output_no == 0)
+	{
+		msg.msg_iov = reply->iov + first;
+		msg.msg_iovlen = (size_t) (reply->iovcnt - first);
+		written = sendmsg(reply->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (written == -1 && errno == EINTR) continue;
+		// socket is full: whatever is left is sent by the reactor
+		if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		// client has left: it is noticed as soon as its next request is to be received
+		if (written == -1 && (errno == EPIPE || errno == ECONNRESET))
+		{
+			left = true;
+			break;
+		}
+		if (written == -1)
+		{
+			perror("sendmsg");
+			exit(EXIT_FAILURE);
+		}
+		reply->writes_no++;
+		// socket has taken only part of the reply: the rest is written by the next call
+		while (first != reply->iovcnt && (size_t) written >= reply->iov[first].iov_len)
+		{
+			written -= (ssize_t) reply->iov[first].iov_len;
+			free(reply->owned[first]);
+			first++;
+		}
+		if (first != reply->iovcnt)
+		{
+			reply->iov[first].iov_base = (void*) ((char*) reply->iov[first].iov_base + written);
+			reply->iov[first].iov_len -= (size_t) written;
+		}
+	}
+	for (; first != reply->iovcnt; first++)
+	{
+		if (left) free(reply->owned[first]);
+		else output_push(reply->connection, &(reply->iov[first]), reply->owned[first]);
+	}
+	reply->iovcnt = 0;
+	reply->buf_len = 0;
+}
+
+static void
+output_push(struct connection* connection, const struct iovec* iov, void* owned)
+{
+	struct chunk* tmp = NULL;
+	struct chunk* chunk;
+
+	if (connection->output_no == connection->output_capacity)
+	{
+		EXIT_IF_EQ(tmp, NULL, (struct chunk*) realloc(connection->output,
+					sizeof(struct chunk) * (connection->output_capacity == 0 ? REPLY_IOVECS
+					: connection->output_capacity * 2)), realloc);
+		connection->output = tmp;
+		connection->output_capacity = (connection->output_capacity == 0) ? REPLY_IOVECS
+					: connection->output_capacity * 2;
+	}
+	chunk = &(connection->output[connection->output_no++]);
+	// parts lying in a worker's buffer are copied, as it is reused as soon as it has been flushed
+	if (!owned)
+	{
+		EXIT_IF_EQ(owned, NULL, malloc(iov->iov_len), malloc);
+		memcpy(owned, iov->iov_base, iov->iov_len);
+		chunk->base = (char*) owned;
+	}
+	else chunk->base = (char*) iov->iov_base;
+	chunk->len = iov->iov_len;
+	chunk->owned = owned;
+}
+
+static int
+send_output(struct connection* connection, int fd)
+{
+	struct iovec iov[REPLY_IOVECS]; // parts to be written by next system call
+	struct msghdr msg; // parts to be written by next system call
+	ssize_t written; // bytes written by last system call
+	struct chunk* chunk;
+
+	while (connection->output_head != connection->output_no)
+	{
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = MIN(REPLY_IOVECS, connection->output_no - connection->output_head);
+		for (size_t i = 0; i < msg.msg_iovlen; i++)
+		{
+			iov[i].iov_base = (void*) connection->output[connection->output_head + i].base;
+			iov[i].iov_len = connection->output[connection->output_head + i].len;
+		}
+		written = sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (written == -1 && errno == EINTR) continue;
+		if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+		if (written == -1 && (errno == EPIPE || errno == ECONNRESET))
+		{
+			output_drop(connection);
+			return -1;
+		}
+		if (written == -1)
+		{
+			perror("sendmsg");
+			exit(EXIT_FAILURE);
+		}
+		while (connection->output_head != connection->output_no
+					&& (size_t) written >= connection->output[connection->output_head].len)
+		{
+			chunk = &(connection->output[connection->output_head++]);
+			written -= (ssize_t) chunk->len;
+			free(chunk->owned);
+		}
+		if (connection->output_head != connection->output_no)
+		{
+			chunk = &(connection->output[connection->output_head]);
+			chunk->base += written;
+			chunk->len -= (size_t) written;
+		}
+	}
+	connection->output_head = 0;
+	connection->output_no = 0;
+	return 1;
+}
+
+static void
+output_drop(struct connection* connection)
+{
+	for (size_t i = connection->output_head; i < connection->output_no; i++)
+		free(connection->output[i].owned);
+	connection->output_head = 0;
+	connection->output_no = 0;
+}
+
+static void
+send_status(struct reply* reply, const struct request* req, int status, int error)
+{
+	reply_header_t header; // status and errno as a binary reply
+	char msg[SIZELEN]; // status or errno as a string
+
+	reply->replies_no++;
+	if (req->binary)
+	{
+		memset(&header, 0, sizeof(reply_header_t));
+		header.magic = PROTOCOL_MAGIC;
+		header.status = (uint8_t) status;
+		header.error = (status == OP_SUCCESS) ? 0 : (int32_t) error;
+		header.request_id = req->id;
+		reply_append(reply, (void*) &header, sizeof(reply_header_t));
+		return;
+	}
+	memset(msg, 0, SIZELEN);
+	snprintf(msg, SIZELEN, "%d", status);
+	reply_append(reply, (void*) msg, strlen(msg) + 1);
+	if (status == OP_SUCCESS) return;
+	memset(msg, 0, SIZELEN);
+	snprintf(msg, SIZELEN, "%d", error);
+	reply_append(reply, (void*) msg, ERRNOLEN);
+}
+
+static void
+send_size(struct reply* reply, const struct request* req, size_t size)
+{
+	uint64_t binary_size = (uint64_t) size; // size as a binary reply
+	char msg_size[SIZELEN]; // size as a string
+
+	if (req->binary)
+	{
+		reply_append(reply, (void*) &binary_size, sizeof(uint64_t));
+		return;
+	}
+	memset(msg_size, 0, SIZELEN);
+	snprintf(msg_size, SIZELEN, "%lu", size);
+	reply_append(reply, (void*) msg_size, SIZELEN);
+}
+
+static void
+send_name(struct reply* reply, const struct request* req, const char* name)
+{
+	char msg[REQUESTLEN]; // name as a string
+
+	if (req->binary)
+	{
+		send_size(reply, req, strlen(name));
+		reply_append(reply, (void*) name, strlen(name));
+		return;
+	}
+	memset(msg, 0, REQUESTLEN);
+	snprintf(msg, REQUESTLEN, "%s", name); // should error handle this
+	reply_append(reply, (void*) msg, REQUESTLEN);
+}
+
+static void
+send_stat(struct reply* reply, const struct request* req, const file_stat_t* file_stat)
+{
+	uint64_t binary_stat[4]; // metadata as a binary reply
+	char stat_msg[STATLEN]; // metadata as a string
+
+	// send size, version, lock owner and open count as a single message
+	if (req->binary)
+	{
+		binary_stat[0] = (uint64_t) file_stat->size;
+		binary_stat[1] = (uint64_t) file_stat->version;
+		binary_stat[2] = (uint64_t) file_stat->lock_owner;
+		binary_stat[3] = (uint64_t) file_stat->open_count;
+		reply_append(reply, (void*) binary_stat, sizeof(binary_stat));
+		return;
+	}
+	memset(stat_msg, 0, STATLEN);
+	snprintf(stat_msg, SIZELEN, "%lu", file_stat->size);
+	snprintf(stat_msg + SIZELEN, SIZELEN, "%lu", file_stat->version);
+	snprintf(stat_msg + 2 * SIZELEN, SIZELEN, "%d", file_stat->lock_owner);
+	snprintf(stat_msg + 3 * SIZELEN, SIZELEN, "%lu", file_stat->open_count);
+	reply_append(reply, (void*) stat_msg, STATLEN);
+}
+
+static void
+send_victims(struct reply* reply, const struct request* req, linked_list_t* evicted, struct workers_args* reactor_args)
+{
+	event_log_t* event_log = reactor_args->event_log;
+	char* evicted_file_name = NULL; // name of evicted file
+	char* evicted_file_content = NULL; // content of evicted file
+	size_t evicted_file_size = 0; // size of evicted file content
+
+	// send number of victims
+	send_size(reply, req, LinkedList_GetNumberOfElements(evicted));
+	// send victims if any
+	while (LinkedList_GetNumberOfElements(evicted) != 0)
+	{
+		errno = 0;
+		evicted_file_size = LinkedList_PopFront(evicted, &evicted_file_name, (void**) &evicted_file_content);
+		if (evicted_file_size == 0 && errno == ENOMEM) exit(1);
+		// send victim's name
+		send_name(reply, req, evicted_file_name);
+		LOG_EVENT(evicted_file_name, .event = LOG_VICTIM);
+		// its lock, if any, has been released along with it
+		wake_lock_waiters(reactor_args, evicted_file_name);
+		// send victim's contents size
+		send_size(reply, req, evicted_file_size);
+		// send actual contents: they are freed once sent
+		reply_give(reply, (void*) evicted_file_content, evicted_file_size); evicted_file_content = NULL;
+		free(evicted_file_name); evicted_file_name = NULL;
+	}
+	LinkedList_Free(evicted);
+}
+
+/**
+ * @brief Gets the stripe clients waiting for the lock of given file are listed in.
+ * @returns Index of the stripe.
+*/
+static size_t
+lock_stripe(const char* pathname)
+{
+	return (size_t) (path_hash(pathname) % LOCK_STRIPES);
+}
+
+static int
+lock_or_wait(struct workers_args* reactor_args, struct reply* reply, int fd, const char* pathname)
+{
+	int err;
+	int outcome; // outcome of Storage_lockFile
+	int errnocopy; // errno value set by Storage_lockFile
+	struct lock_waits* stripe = &(reactor_args->lock_waits[lock_stripe(pathname)]);
+
+	// lock is attempted and client is listed as a single step: whoever releases a lock of the same stripe
+	// afterwards finds it waiting
+	EXIT_IF_NEQ(err, 0, pthread_mutex_lock(&(stripe->mutex)), pthread_mutex_lock);
+	outcome = Storage_lockFile(reactor_args->storage, pathname, fd);
+	errnocopy = errno;
+	if (outcome == OP_FAILURE && errnocopy == EPERM)
+	{
+		// replies are sent before client is listed: it may be handed to another worker as soon as it is
+		reply_flush(reply);
+		if (stripe->last != 0) reactor_args->connections[stripe->last].next_waiting = fd;
+		else stripe->first = fd;
+		stripe->last = fd;
+		outcome = -1;
+	}
+	EXIT_IF_NEQ(err, 0, pthread_mutex_unlock(&(stripe->mutex)), pthread_mutex_unlock);
+	errno = errnocopy;
+	return outcome;
+}
+
+static void
+wake_lock_waiters(struct workers_args* reactor_args, const char* pathname)
+{
+	int err;
+	struct lock_waits* stripe;
+	struct connection* connection;
+	int fd; // waiting client
+	int next; // client waiting after it
+	size_t first = pathname ? lock_stripe(pathname) : 0; // first stripe to be visited
+	size_t last = pathname ? first + 1 : LOCK_STRIPES; // stripe following the last one to be visited
+
+	for (size_t i = first; i < last; i++)
+	{
+		stripe = &(reactor_args->lock_waits[i]);
+		EXIT_IF_NEQ(err, 0, pthread_mutex_lock(&(stripe->mutex)), pthread_mutex_lock);
+		fd = stripe->first;
+		stripe->first = 0;
+		stripe->last = 0;
+		EXIT_IF_NEQ(err, 0, pthread_mutex_unlock(&(stripe->mutex)), pthread_mutex_unlock);
+		// every client of the stripe tries again, in arrival order: those waiting for another file,
+		// or beaten to it, are listed again
+		while (fd != 0)
+		{
+			connection = &(reactor_args->connections[fd]);
+			next = connection->next_waiting;
+			connection->next_waiting = 0;
+			schedule_client(connection->reactor_args, fd);
+			fd = next;
+		}
+	}
+}
+
+static void*
+worker_routine(void* arg)
+{
+	// -------------------------------------
+	// DECLARATIONS NEEDED TO PARSE MESSAGES
+	// -------------------------------------
+	struct worker* self = (struct worker*) arg;
+	struct workers_args* workers_args = self->workers_args;
+	// workers spawned under load are pinned as well: buffers allocated from now on lie on their own node
+	if (workers_args->pinned) pin_thread(&(workers_args->workers_cpus));
+	char* request; // request as received from the client
+	EXIT_IF_EQ(request, NULL, (char*) malloc(sizeof(char) * REQUESTLEN), malloc);
+	struct request req; // request as parsed, whichever protocol it has been sent with
+	struct scheduler* scheduler = self->scheduler;
+	storage_t* storage = workers_args->storage;
+	event_log_t* event_log = workers_args->event_log;
+	int fd_clients_left = workers_args->fd_clients_left;
+	uint64_t client_left = 1; // value written to eventfd when a client leaves
+	int err; // used as a placeholder for functions' output values
+	int errnocopy; // copy of errno value
+	int fd_ready; // currently being served client
+	struct connection* connection; // requests received from client being served
+	bool pipelined = false; // toggled on when client's next request has already been fully received
+	size_t served = 0; // number of requests of client served since its replies were last sent
+	size_t gathered = 0; // number of bytes gathered for replies before the current request was served
+	uint64_t started = 0; // time the current request started being served at
+	struct reply reply; // replies gathered for the client being served
+	memset(&reply, 0, sizeof(struct reply));
+	EXIT_IF_EQ(reply.buf, NULL, (char*) malloc(sizeof(char) * REPLY_BUFLEN), malloc);
+	reply.copy_threshold = MIN(workers_args->copy_threshold, REPLY_BUFLEN);
+
+	// --------------------------------------------
+	// DECLARATIONS NEEDED TO INTERACT WITH STORAGE
+	// --------------------------------------------
+	linked_list_t* evicted = NULL; // used to store evicted files
+	void* read_buf = NULL; // buffer used for reading operation (USED TO HANDLE readFile)
+	size_t read_size = 0; // size of read_buf (USED TO HANDLE readFile)
+	file_stat_t file_stat; // metadata of requested file (USED TO HANDLE statFile)
+	void* write_contents = NULL; // buffer of contents to be written or appended (USED TO HANDLE writeFile, appendToFile)
+	storage_cursor_t* cursor = NULL; // cursor over files read when interacting with a readNFiles request (USED TO HANDLE readNFiles)
+	char* read_file_name = NULL; // used to denote name of read file (USED TO HANDLE readNFiles)
+	char* read_file_content = NULL; // buffer of read file's contents (USED TO HANDLE readNFiles)
+	size_t read_file_size = 0; // size of read file content (USED TO HANDLE readNFiles)
+	size_t tot_read_size = 0; // total read size
+	linked_list_t* listed = NULL; // names of files matching prefix (USED TO HANDLE listFiles)
+	char* listed_name = NULL; // name of listed file (USED TO HANDLE listFiles)
+	char* list_buf = NULL; // newline separated names of listed files (USED TO HANDLE listFiles)
+	char* tmp_list_buf = NULL; // used when growing list_buf (USED TO HANDLE listFiles)
+	size_t list_size = 0; // length of list_buf's contents (USED TO HANDLE listFiles)
+	size_t list_capacity = 0; // allocated size of list_buf (USED TO HANDLE listFiles)
+	while(1)
+	{
+		// read ready fd from own tasks' queue or from a sibling's one
+		fd_ready = next_task(scheduler, self->id);
+		if (fd_ready == TERMINATE_WORKER) break; // termination message
+		// client is placed on this worker from now on, as long as it is active
+		connection = &(workers_args->connections[fd_ready]);
+		if (self->metadata) connection->metadata_worker = (int) self->id;
+		else connection->worker = (int) self->id;
+		__atomic_add_fetch(&(scheduler->wait_total), now_ns() - connection->queued_at, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&(scheduler->waited_no), 1, __ATOMIC_RELAXED);
+		// clients are served round-robin, each one moving about as many bytes as the others (deficit round-robin):
+		// those still in debt after being credited wait for their next turn
+		connection->deficit += workers_args->client_quantum;
+		if (connection->deficit <= 0)
+		{
+			schedule_client(workers_args, fd_ready);
+			continue;
+		}
+		// requests sent back to back are served in order, as long as they have already been received:
+		// their replies are sent at once
+		served = 0;
+		gathered = reply.bytes_no;
+		reply.fd = fd_ready;
+		reply.connection = connection;
+		do
+		{
+			pipelined = false;
+			err = receive_request(workers_args, fd_ready, request, &req);
+			if (err == -1)
+			{
+				reply_flush(&reply);
+				break;
+			}
+			started = now_ns();
+			// client closed its connection without sending a termination message or has nested a batch
+			if (err == 0 || (req.opcode == BATCH && connection->batched != 0)) req.opcode = TERMINATE;
+			switch (req.opcode)
+			{
+				case BATCH:
+					// requests are served as soon as they are received, whether they have been received
+					// along with the batch or not
+					LOG_REQUEST(NULL, .event = LOG_BATCH, .fd = fd_ready, .args = { req.args[0] });
+					send_status(&reply, &req, OP_SUCCESS, 0);
+					send_size(&reply, &req, req.args[0]);
+					connection->batched = req.args[0];
+					REQUEST_DONE;
+					break;
+
+				case OPEN:
+					evicted = NULL;
+					err = Storage_openFile(storage, req.pathname, req.flags, &evicted, fd_ready);
+					errnocopy = errno;
+					if (IS_O_CREATE_SET(req.flags))
+					{
+						LOG_REQUEST(req.pathname, .event = LOG_OPEN_CREATE, .fd = fd_ready, .flags = req.flags, .status = err,
+									.count = LinkedList_GetNumberOfElements(evicted));
+					}
+					else LOG_REQUEST(req.pathname, .event = LOG_OPEN, .fd = fd_ready, .flags = req.flags, .status = err);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					// files evicted to make room for a new one are sent only when creating it
+					if (IS_O_CREATE_SET(req.flags)) send_victims(&reply, &req, evicted, workers_args);
+					else LinkedList_Free(evicted);
+					evicted = NULL;
+					REQUEST_DONE;
+					break;
+
+				case CLOSE:
+					err = Storage_closeFile(storage, req.pathname, fd_ready);
+					errnocopy = errno;
+					LOG_REQUEST(req.pathname, .event = LOG_CLOSE, .fd = fd_ready, .status = err);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					REQUEST_DONE;
+					break;
+
+				case READ:
+					read_buf = NULL;
+					read_size = 0;
+					// check whether file to be read's
+					// size and contents are to be saved
+					if (req.flags == READ_CONTENTS)
+					{
+						err = Storage_readFile(storage, req.pathname, &read_buf, &read_size, fd_ready);
+						errnocopy = errno;
+						LOG_REQUEST(req.pathname, .event = LOG_READ, .fd = fd_ready, .flags = req.flags, .status = err,
+									.bytes = read_size);
+						// send return value
+						send_status(&reply, &req, err, errnocopy);
+						if (err == OP_FATAL) exit(1);
+						// send size and contents
+						send_size(&reply, &req, read_size);
+						reply_give(&reply, read_buf, read_size); read_buf = NULL;
+					}
+					else
+					{
+						err = Storage_readFile(storage, req.pathname, NULL, NULL, fd_ready);
+						errnocopy = errno;
+						LOG_REQUEST(req.pathname, .event = LOG_READ, .fd = fd_ready, .flags = req.flags, .status = err,
+									.bytes = read_size);
+						// send return value
+						send_status(&reply, &req, err, errnocopy);
+						if (err == OP_FATAL) exit(1);
+					}
+					REQUEST_DONE;
+					break;
+
+				case READ_RANGE:
+					read_buf = NULL;
+					read_size = 0;
+					err = Storage_readFileRange(storage, req.pathname, req.args[0], req.args[1], &read_buf, &read_size,
+								fd_ready);
+					errnocopy = errno;
+					LOG_REQUEST(req.pathname, .event = LOG_READ_RANGE, .fd = fd_ready, .args = { req.args[0], req.args[1] },
+								.status = err, .bytes = read_size);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					// send size and contents
+					send_size(&reply, &req, read_size);
+					reply_give(&reply, read_buf, read_size); read_buf = NULL;
+					REQUEST_DONE;
+					break;
+
+				case STAT:
+					err = Storage_statFile(storage, req.pathname, &file_stat);
+					errnocopy = errno;
+					LOG_REQUEST(req.pathname, .event = LOG_STAT, .fd = fd_ready, .status = err, .bytes = file_stat.size);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					if (err == OP_SUCCESS) send_stat(&reply, &req, &file_stat);
+					REQUEST_DONE;
+					break;
+
+				case WRITE:
+				case APPEND:
+					evicted = NULL;
+					write_contents = NULL;
+					if (req.size > workers_args->max_payload) connection->payload_error = EFBIG;
+					// request fails on its own: contents sent along with it are dropped, unless they are
+					// yet to be sent since space has to be reserved first
+					if (connection->payload_error != 0)
+					{
+						if (!connection->reserved && !(req.opcode == WRITE && req.flags == WRITE_RESERVE))
+							drop_payload(connection, req.size);
+						err = OP_FAILURE;
+						errnocopy = connection->payload_error;
+						connection->payload_error = 0;
+						connection->reserved = false;
+						LOG_REQUEST(req.pathname, .event = (req.opcode == WRITE) ? LOG_WRITE : LOG_APPEND, .fd = fd_ready,
+									.status = err, .bytes = req.size);
+						send_status(&reply, &req, err, errnocopy);
+						send_victims(&reply, &req, NULL, workers_args);
+						// client is not charged for contents which may never be sent
+						req.size = 0;
+						REQUEST_DONE;
+					}
+					// space is reserved before contents are sent: client sends them only if it gets a success,
+					// then request is served again as soon as reactor has received them
+					if (req.opcode == WRITE && req.flags == WRITE_RESERVE && !connection->reserved)
+					{
+						err = Storage_reserveFile(storage, req.pathname, req.size, &evicted, fd_ready);
+						errnocopy = errno;
+						LOG_REQUEST(req.pathname, .event = LOG_RESERVE, .fd = fd_ready, .status = err, .bytes = req.size,
+									.count = LinkedList_GetNumberOfElements(evicted));
+						// send return value and victims if any, then wait for contents
+						send_status(&reply, &req, err, errnocopy);
+						send_victims(&reply, &req, evicted, workers_args); evicted = NULL;
+						if (err == OP_FATAL) exit(1);
+						reply_flush(&reply);
+						if (err != OP_SUCCESS) REQUEST_DONE;
+						if (req.size != 0)
+						{
+							connection->reserved = true;
+							// contents are dropped as they are received, write fails once they have been
+							if (!expect_payload(connection, connection->consumed, req.size))
+							{
+								connection->payload_error = ENOMEM;
+								drop_payload(connection, req.size);
+							}
+							monitor_client(connection->reactor_args, fd_ready, false);
+							break;
+						}
+					}
+					connection->reserved = false;
+					// contents have been received straight into the buffer storage is going to keep,
+					// unless they are small enough to have been received along with the request
+					if (req.size != 0 && !(write_contents = take_payload(connection, req.size)))
+					{
+						err = OP_FAILURE;
+						errnocopy = ECONNRESET;
+					}
+					if (req.size != 0 && !write_contents)
+					{
+						LOG_EVENT(req.pathname, .event = LOG_UPLOAD_LEFT, .fd = fd_ready);
+					}
+					else if (req.opcode == WRITE)
+					{
+						// contents are handed to storage
+						err = Storage_writeFile(storage, req.pathname, req.size, (char*) write_contents, &evicted,
+									fd_ready);
+						errnocopy = errno;
+						write_contents = NULL;
+						LOG_REQUEST(req.pathname, .event = LOG_WRITE, .fd = fd_ready, .status = err, .bytes = req.size,
+									.count = LinkedList_GetNumberOfElements(evicted));
+					}
+					else
+					{
+						err = Storage_appendToFile(storage, req.pathname, write_contents, req.size, &evicted, fd_ready);
+						errnocopy = errno;
+						LOG_REQUEST(req.pathname, .event = LOG_APPEND, .fd = fd_ready, .status = err, .bytes = req.size,
+									.count = LinkedList_GetNumberOfElements(evicted));
+					}
+					free(write_contents); write_contents = NULL;
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					// send victims if any
+					send_victims(&reply, &req, evicted, workers_args); evicted = NULL;
+					if (err == OP_FATAL) exit(1);
+					REQUEST_DONE;
+					break;
+
+				case READ_N:
+					cursor = NULL;
+					tot_read_size = 0;
+					err = Storage_readNFiles(storage, &cursor, req.args[0], req.pathname, fd_ready);
+					errnocopy = errno;
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					// stream read files one at a time
+					while (cursor)
+					{
+						err = Storage_cursorNext(cursor, &read_file_name, (void**) &read_file_content, &read_file_size);
+						if (err != OP_SUCCESS || !read_file_name) break;
+						tot_read_size += read_file_size;
+						// send file's name, contents size and actual contents
+						send_name(&reply, &req, read_file_name);
+						send_size(&reply, &req, read_file_size);
+						reply_give(&reply, (void*) read_file_content, read_file_size); read_file_content = NULL;
+						free(read_file_name); read_file_name = NULL;
+					}
+					Storage_cursorFree(cursor); cursor = NULL;
+					// an empty name marks the end of the stream
+					send_name(&reply, &req, "");
+					LOG_REQUEST(req.pathname, .event = LOG_READ_N, .fd = fd_ready, .args = { req.args[0] }, .status = err,
+								.bytes = tot_read_size);
+					if (err == OP_FATAL) exit(1);
+					REQUEST_DONE;
+					break;
+
+				case LIST:
+					listed = NULL;
+					list_buf = NULL;
+					list_size = 0;
+					list_capacity = 0;
+					err = Storage_listFiles(storage, req.pathname, &listed);
+					errnocopy = errno;
+					// names are sent as a single newline separated buffer
+					while (err == OP_SUCCESS && LinkedList_GetNumberOfElements(listed) != 0)
+					{
+						errno = 0;
+						if (LinkedList_PopFront(listed, &listed_name, NULL) == 0 && errno != 0)
+						{
+							err = OP_FATAL;
+							errnocopy = errno;
+							break;
+						}
+						if (list_size + strlen(listed_name) + 1 > list_capacity)
+						{
+							list_capacity = (list_size + strlen(listed_name) + 1) * 2;
+							EXIT_IF_EQ(tmp_list_buf, NULL, (char*) realloc(list_buf, list_capacity), realloc);
+							list_buf = tmp_list_buf;
+						}
+						memcpy(list_buf + list_size, listed_name, strlen(listed_name));
+						list_size += strlen(listed_name);
+						list_buf[list_size++] = '\n';
+						free(listed_name); listed_name = NULL;
+					}
+					LinkedList_Free(listed); listed = NULL;
+					LOG_REQUEST(req.pathname, .event = LOG_LIST, .fd = fd_ready, .status = err, .bytes = list_size);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					if (err == OP_SUCCESS)
+					{
+						// send size and names
+						send_size(&reply, &req, list_size);
+						reply_give(&reply, (void*) list_buf, list_size); list_buf = NULL;
+					}
+					free(list_buf); list_buf = NULL;
+					REQUEST_DONE;
+					break;
+
+				case LOCK:
+					err = lock_or_wait(workers_args, &reply, fd_ready, req.pathname);
+					errnocopy = errno;
+					// client waits for the lock without holding this worker: request is served again once woken up
+					if (err == -1)
+					{
+						LOG_REQUEST(req.pathname, .event = LOG_LOCK_WAIT, .fd = fd_ready, .flags = req.flags);
+						break;
+					}
+					LOG_REQUEST(req.pathname, .event = LOG_LOCK, .fd = fd_ready, .flags = req.flags, .status = err);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					REQUEST_DONE;
+					break;
+
+				case UNLOCK:
+					err = Storage_unlockFile(storage, req.pathname, fd_ready);
+					errnocopy = errno;
+					LOG_REQUEST(req.pathname, .event = LOG_UNLOCK, .fd = fd_ready, .flags = req.flags, .status = err);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					if (err == OP_SUCCESS) wake_lock_waiters(workers_args, req.pathname);
+					REQUEST_DONE;
+					break;
+
+				case REMOVE:
+					err = Storage_removeFile(storage, req.pathname, fd_ready);
+					errnocopy = errno;
+					LOG_REQUEST(req.pathname, .event = LOG_REMOVE, .fd = fd_ready, .status = err);
+					// send return value
+					send_status(&reply, &req, err, errnocopy);
+					if (err == OP_FATAL) exit(1);
+					if (err == OP_SUCCESS) wake_lock_waiters(workers_args, req.pathname);
+					REQUEST_DONE;
+					break;
+
+				case TERMINATE:
+					// replies to the requests preceding it are sent before its descriptor gets closed
+					reply_flush(&reply);
+					if (connection->payload)
+					{
+						LOG_EVENT(NULL, .event = LOG_PAYLOAD_LEFT, .fd = fd_ready);
+					}
+					free(connection->payload); connection->payload = NULL;
+					output_drop(connection);
+					// client's descriptor is about to be reused: whatever it still holds is to be released
+					EXIT_IF_NEQ(err, OP_SUCCESS, Storage_clientLeft(storage, fd_ready), Storage_clientLeft);
+					// locks client owned have been released
+					wake_lock_waiters(workers_args, NULL);
+					close(fd_ready);
+					EXIT_IF_EQ(err, -1, writen((long) fd_clients_left, (void*) &client_left, sizeof(client_left)), writen);
+					LOG_EVENT(NULL, .event = LOG_CLIENT_LEFT, .fd = fd_ready);
+					break;
+			}
+		} while (pipelined);
+	}
+	LOG_EVENT(NULL, .event = LOG_WORKER_REPLIES, .args = { reply.replies_no, reply.writes_no });
+	// retired workers' rings are taken over by those spawned later
+	EventLog_Detach(event_log);
+	free(reply.buf);
 	free(request);
+	// main thread may now reuse worker's slot
+	__atomic_store_n(&(self->exited), 1, __ATOMIC_SEQ_CST);
 	return NULL;
-}
\ No newline at end of file
+}
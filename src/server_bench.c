@@ -0,0 +1,392 @@
+/**
+ * @brief Load generator for a running server: latency of light clients issuing small requests
+ * while heavy or slow clients keep the server busy.
+ * @author Giacomo Trapani.
+*/
+
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <server_defines.h>
+#include <server_interface.h>
+#include <utilities.h>
+#include <wrappers.h>
+
+#define DEFAULT_LIGHT 4 // light clients
+#define DEFAULT_ITERATIONS 2000 // LOCK/UNLOCK pairs issued by each light client
+#define DEFAULT_HEAVY_SIZE 1000000 // size of each heavy client's files
+#define HEAVY_FILES 64 // files read back by each heavy client's batches
+#define SLOW_CHUNK 65536 // bytes slow clients send or receive at once
+#define SLOW_HEADER_CHUNK 128 // bytes of a request header slow clients send at once
+#define SLOW_FILE_SIZE (4 << 20) // size of the file slow readers read back
+#define SLOW_APPEND_SIZE (8 * SLOW_CHUNK) // size of the contents slow writers append
+#define SLOW_RCVBUF 16384 // receive buffer of slow readers, so that the server cannot hand their replies to the kernel
+#define CONNECT_TIMEOUT 5 // seconds clients keep trying to connect for
+#define CONNECT_RETRY 100 // milliseconds between connection attempts
+
+#define USAGE \
+"Usage: %s -f <socket> [-c light clients] [-n LOCK/UNLOCK pairs per light client]\n"\
+"          [-H heavy clients] [-s size of each heavy client's files] [-S slow clients of each kind]\n"
+
+// Shared by every client process.
+struct shared
+{
+	int ready; // clients of the background load which are done setting up
+	int done; // set once every light client has completed
+	uint64_t heavy_batches; // readFiles batches completed by heavy clients
+	uint64_t heavy_bytes; // bytes read by heavy clients
+	uint64_t slow_rounds; // requests completed by slow clients
+	uint64_t latencies[]; // one per light client's request, in ns
+};
+
+struct bench
+{
+	const char* sockname;
+	int light;
+	int iterations;
+	int heavy;
+	size_t heavy_size;
+	int slow;
+	struct shared* shared;
+};
+
+static uint64_t
+now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int
+compare_u64(const void* a, const void* b)
+{
+	uint64_t x = *((const uint64_t*) a), y = *((const uint64_t*) b);
+	return (x > y) - (x < y);
+}
+
+static void
+fail(const char* what)
+{
+	perror(what);
+	exit(EXIT_FAILURE);
+}
+
+static void
+connect_client(const char* sockname)
+{
+	struct timespec abstime = { .tv_nsec = 0, .tv_sec = time(NULL) + CONNECT_TIMEOUT };
+	if (openConnection(sockname, CONNECT_RETRY, abstime) != 0) fail("openConnection");
+}
+
+/**
+ * @brief Issues LOCK/UNLOCK pairs on a file of its own, saving each request's latency.
+*/
+static void
+light_client(struct bench* bench, int id)
+{
+	char pathname[MAXPATH];
+	uint64_t* latencies = bench->shared->latencies + (size_t) id * 2 * bench->iterations;
+	uint64_t start;
+
+	snprintf(pathname, MAXPATH, "/light%d", id);
+	connect_client(bench->sockname);
+	if (openFile(pathname, O_CREATE) != 0) fail("openFile");
+	for (int i = 0; i < bench->iterations; i++)
+	{
+		start = now_ns();
+		if (lockFile(pathname) != 0) fail("lockFile");
+		latencies[2 * i] = now_ns() - start;
+		start = now_ns();
+		if (unlockFile(pathname) != 0) fail("unlockFile");
+		latencies[2 * i + 1] = now_ns() - start;
+	}
+	closeConnection(bench->sockname);
+}
+
+/**
+ * @brief Fills files of its own, then reads all of them back in a single batch
+ * for as long as light clients run.
+*/
+static void
+heavy_client(struct bench* bench, int id)
+{
+	char* pathnames[HEAVY_FILES];
+	void* bufs[HEAVY_FILES];
+	size_t sizes[HEAVY_FILES];
+	char* contents = (char*) malloc(bench->heavy_size);
+
+	if (!contents) fail("malloc");
+	memset(contents, 'x', bench->heavy_size);
+	connect_client(bench->sockname);
+	for (int i = 0; i < HEAVY_FILES; i++)
+	{
+		if (!(pathnames[i] = (char*) malloc(MAXPATH))) fail("malloc");
+		snprintf(pathnames[i], MAXPATH, "/heavy%d_%d", id, i);
+		if (openFile(pathnames[i], O_CREATE) != 0) fail("openFile");
+		if (appendToFile(pathnames[i], contents, bench->heavy_size, NULL) != 0) fail("appendToFile");
+	}
+	free(contents);
+	__atomic_fetch_add(&(bench->shared->ready), 1, __ATOMIC_RELEASE);
+
+	while (!__atomic_load_n(&(bench->shared->done), __ATOMIC_ACQUIRE))
+	{
+		if (readFiles((const char**) pathnames, HEAVY_FILES, bufs, sizes) != 0) fail("readFiles");
+		for (int i = 0; i < HEAVY_FILES; i++)
+		{
+			__atomic_fetch_add(&(bench->shared->heavy_bytes), sizes[i], __ATOMIC_RELAXED);
+			free(bufs[i]);
+		}
+		__atomic_fetch_add(&(bench->shared->heavy_batches), 1, __ATOMIC_RELAXED);
+	}
+	for (int i = 0; i < HEAVY_FILES; i++)
+		free(pathnames[i]);
+	closeConnection(bench->sockname);
+}
+
+static void
+pause_ms(int msec)
+{
+	struct timespec ts = { .tv_sec = msec / 1000, .tv_nsec = (msec % 1000) * 1000000L };
+	nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief Sends given buffer in chunks of given size, pausing for given milliseconds after each of them.
+*/
+static void
+trickle(int fd, const char* buf, size_t len, size_t chunk, int msec)
+{
+	for (size_t sent = 0; sent < len; sent += chunk)
+	{
+		if (writen(fd, (void*) (buf + sent), MIN(chunk, len - sent)) == -1) fail("writen");
+		pause_ms(msec);
+	}
+}
+
+/**
+ * @brief Sends a text request at once.
+*/
+static void
+send_text(int fd, const char* request)
+{
+	char buf[REQUESTLEN];
+	memset(buf, 0, REQUESTLEN);
+	strncpy(buf, request, REQUESTLEN - 1);
+	if (writen(fd, buf, REQUESTLEN) == -1) fail("writen");
+}
+
+/**
+ * @brief Receives a text reply's status followed by given bytes, which are discarded.
+*/
+static void
+receive_text(int fd, size_t trailing)
+{
+	char status[2], buf[STATLEN];
+	if (readn(fd, status, 2) <= 0) fail("readn");
+	if (status[0] != '0')
+	{
+		fprintf(stderr, "A slow client's request failed.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (trailing && readn(fd, buf, trailing) <= 0) fail("readn");
+}
+
+/**
+ * @brief Speaks the text protocol as slowly as given kind requires, for as long as light clients run:
+ * 0 trickles requests' headers, 1 trickles payloads, 2 reads replies slowly.
+*/
+static void
+slow_client(struct bench* bench, int id)
+{
+	struct sockaddr_un sock_addr;
+	char pathname[MAXPATH], request[REQUESTLEN], size[SIZELEN];
+	char* contents = (char*) malloc(SLOW_FILE_SIZE);
+	int kind = id % 3, fd, rcvbuf = SLOW_RCVBUF;
+	size_t left, received;
+
+	if (!contents) fail("malloc");
+	memset(contents, 'x', SLOW_FILE_SIZE);
+	memset(&sock_addr, 0, sizeof(sock_addr));
+	strncpy(sock_addr.sun_path, bench->sockname, sizeof(sock_addr.sun_path) - 1);
+	sock_addr.sun_family = AF_UNIX;
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) fail("socket");
+	if (kind == 2 && setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) == -1) fail("setsockopt");
+	if (connect(fd, (struct sockaddr*) &sock_addr, sizeof(sock_addr)) == -1) fail("connect");
+
+	snprintf(pathname, MAXPATH, "/slow%d", id);
+	snprintf(request, REQUESTLEN, "%d %s %d", OPEN, pathname, O_CREATE | O_LOCK);
+	send_text(fd, request);
+	receive_text(fd, SIZELEN);
+	if (kind == 2)
+	{
+		snprintf(request, REQUESTLEN, "%d %s %d", WRITE, pathname, SLOW_FILE_SIZE);
+		send_text(fd, request);
+		if (writen(fd, contents, SLOW_FILE_SIZE) == -1) fail("writen");
+		receive_text(fd, SIZELEN);
+	}
+	__atomic_fetch_add(&(bench->shared->ready), 1, __ATOMIC_RELEASE);
+
+	while (!__atomic_load_n(&(bench->shared->done), __ATOMIC_ACQUIRE))
+	{
+		switch (kind)
+		{
+			case 0:
+				memset(request, 0, REQUESTLEN);
+				snprintf(request, REQUESTLEN, "%d %s", STAT, pathname);
+				trickle(fd, request, REQUESTLEN, SLOW_HEADER_CHUNK, 20);
+				receive_text(fd, STATLEN);
+				break;
+			case 1:
+				snprintf(request, REQUESTLEN, "%d %s %d", APPEND, pathname, SLOW_APPEND_SIZE);
+				send_text(fd, request);
+				trickle(fd, contents, SLOW_APPEND_SIZE, SLOW_CHUNK, 25);
+				receive_text(fd, SIZELEN);
+				break;
+			case 2:
+				snprintf(request, REQUESTLEN, "%d %s %d", READ, pathname, READ_CONTENTS);
+				send_text(fd, request);
+				receive_text(fd, 0);
+				if (readn(fd, size, SIZELEN) <= 0) fail("readn");
+				for (left = strtoul(size, NULL, 10); left > 0; left -= received)
+				{
+					received = MIN(left, SLOW_CHUNK);
+					if (readn(fd, contents, received) <= 0) fail("readn");
+					pause_ms(40);
+				}
+				break;
+		}
+		__atomic_fetch_add(&(bench->shared->slow_rounds), 1, __ATOMIC_RELAXED);
+	}
+	snprintf(request, REQUESTLEN, "%d", TERMINATE);
+	send_text(fd, request);
+	close(fd);
+	free(contents);
+}
+
+/**
+ * @brief Forks a client process running given routine.
+ * @returns pid of the new process.
+*/
+static pid_t
+spawn(struct bench* bench, void (*routine)(struct bench*, int), int id)
+{
+	pid_t pid = fork();
+	if (pid == -1) fail("fork");
+	if (pid == 0)
+	{
+		routine(bench, id);
+		exit(EXIT_SUCCESS);
+	}
+	return pid;
+}
+
+/**
+ * @brief Waits for given processes.
+ * @returns number of processes which did not exit successfully.
+*/
+static int
+wait_all(const pid_t* pids, int n)
+{
+	int status, failed = 0;
+	for (int i = 0; i < n; i++)
+		if (waitpid(pids[i], &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+			failed++;
+	return failed;
+}
+
+int
+main(int argc, char* argv[])
+{
+	struct bench bench = { .sockname = NULL, .light = DEFAULT_LIGHT, .iterations = DEFAULT_ITERATIONS,
+			.heavy = 0, .heavy_size = DEFAULT_HEAVY_SIZE, .slow = 0 };
+	size_t requests, shared_size;
+	pid_t* pids;
+	int opt, background, failed;
+	uint64_t start, elapsed;
+
+	while ((opt = getopt(argc, argv, "f:c:n:H:s:S:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'f': bench.sockname = optarg; break;
+			case 'c': bench.light = atoi(optarg); break;
+			case 'n': bench.iterations = atoi(optarg); break;
+			case 'H': bench.heavy = atoi(optarg); break;
+			case 's': bench.heavy_size = strtoul(optarg, NULL, 10); break;
+			case 'S': bench.slow = atoi(optarg); break;
+			default:
+				fprintf(stderr, USAGE, argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if (!bench.sockname || bench.light <= 0 || bench.iterations <= 0 || bench.heavy < 0 || bench.heavy_size == 0
+			|| bench.slow < 0)
+	{
+		fprintf(stderr, USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+	print_enabled = false;
+
+	requests = (size_t) bench.light * 2 * bench.iterations;
+	shared_size = sizeof(struct shared) + requests * sizeof(uint64_t);
+	bench.shared = (struct shared*) mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (bench.shared == MAP_FAILED) fail("mmap");
+	background = bench.heavy + 3 * bench.slow;
+	if (!(pids = (pid_t*) malloc(sizeof(pid_t) * (bench.light + background)))) fail("malloc");
+
+	// the background load is set up before light clients start
+	for (int i = 0; i < bench.heavy; i++)
+		pids[bench.light + i] = spawn(&bench, heavy_client, i);
+	for (int i = 0; i < 3 * bench.slow; i++)
+		pids[bench.light + bench.heavy + i] = spawn(&bench, slow_client, i);
+	while (__atomic_load_n(&(bench.shared->ready), __ATOMIC_ACQUIRE) < background)
+	{
+		if (waitpid(-1, NULL, WNOHANG) > 0)
+		{
+			fprintf(stderr, "A client failed while setting up.\n");
+			return EXIT_FAILURE;
+		}
+		usleep(10000);
+	}
+
+	start = now_ns();
+	for (int i = 0; i < bench.light; i++)
+		pids[i] = spawn(&bench, light_client, i);
+	failed = wait_all(pids, bench.light);
+	elapsed = now_ns() - start;
+	__atomic_store_n(&(bench.shared->done), 1, __ATOMIC_RELEASE);
+	failed += wait_all(pids + bench.light, background);
+	if (failed)
+	{
+		fprintf(stderr, "%d clients failed.\n", failed);
+		return EXIT_FAILURE;
+	}
+
+	qsort(bench.shared->latencies, requests, sizeof(uint64_t), compare_u64);
+	printf("light: %d clients, %zu requests in %.3f s, %.0f req/s, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+			bench.light, requests, (double) elapsed / 1e9, (double) requests * 1e9 / (double) elapsed,
+			(double) bench.shared->latencies[requests / 2] / 1e3,
+			(double) bench.shared->latencies[(size_t) ((double) requests * 0.99)] / 1e3,
+			(double) bench.shared->latencies[requests - 1] / 1e3);
+	if (bench.heavy)
+		printf("heavy: %d clients, %lu batches, %.1f MB/s\n", bench.heavy, bench.shared->heavy_batches,
+				(double) bench.shared->heavy_bytes * 1e3 / (double) elapsed);
+	if (bench.slow)
+		printf("slow: %d clients, %lu requests\n", 3 * bench.slow, bench.shared->slow_rounds);
+
+	munmap(bench.shared, shared_size);
+	free(pids);
+	return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include <errno.h>
 #include <linux/limits.h>
 #include <math.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
@@ -26,13 +27,769 @@
 #include <wrappers.h>
 
 #define ERRORSTRINGLEN 128 // maximum length for errno description
-#define OPVALUE_LEN 2 // maximum length of buffer to read when reading the output value of an operation inside the file system
+#define FRAMELEN (sizeof(request_header_t) + MAXPATH + 2 * sizeof(uint64_t)) // maximum length of a request sent at once
+#define PIPELINE_DEPTH 128 // maximum number of pipelined requests awaiting their reply
+#define UPLOAD_CHUNK 65536 // size of the chunks files are read and sent in
+
+// Used to denote a request whose reply has yet to be received.
+struct pipelined_request
+{
+	uint64_t id;
+	opcodes_t opcode;
+	int flags;
+	char pathname[MAXPATH + 1];
+	char* dirname; // where evicted files are to be stored, may be NULL
+};
+
+// Used to denote a request sent as part of a batch.
+struct batch_entry
+{
+	uint64_t id;
+	opcodes_t opcode;
+	int flags;
+	const char* pathname;
+	const void* payload; // contents to be written or appended, may be NULL
+	bool streamed; // if true, contents are streamed from the file at pathname rather than taken from payload
+	size_t payload_len;
+	int status; // outcome of the request, set to OP_FAILURE until its reply has been received
+	void* buf; // read contents (USED BY readFiles)
+	size_t size; // size of read contents (USED BY readFiles)
+};
 
 static int fd_socket = -1;
+static uint64_t request_id = 0; // id of the last request sent
 static char socketpath[MAXPATH];
+static struct pipelined_request pipeline[PIPELINE_DEPTH]; // circular buffer of requests awaiting their reply
+static size_t pipeline_head = 0; // oldest request awaiting its reply
+static size_t pipeline_no = 0; // number of requests awaiting their reply
+static size_t pipeline_failures = 0; // number of pipelined requests failed since last drain
+static int pipeline_errno = 0; // errno value of the first pipelined request failed since last drain
 bool print_enabled = true;
 bool exit_on_fatal_errors = true;
 
+static int
+complete_pipelined(size_t n);
+
+/**
+ * @brief Writes given buffer to the socket, receiving the replies to pipelined requests whenever the server
+ * has some ready: as the server stops reading requests while its replies cannot be written, waiting for the whole
+ * buffer to be written may never end.
+ * @returns 0 on success, -1 on failure.
+ * @exception It sets "errno" to "EBADMSG" if the server sends anything while no reply is awaited. The function may
+ * also fail and set "errno" for any of the errors specified for the routines "poll", "send", "complete_pipelined".
+*/
+static int
+write_pipelined(const char* buf, size_t len)
+{
+	struct pollfd pfd;
+	ssize_t sent;
+
+	while (len != 0)
+	{
+		pfd.fd = fd_socket;
+		pfd.events = POLLIN | POLLOUT;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, -1) == -1)
+		{
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		if (pfd.revents & POLLIN)
+		{
+			if (pipeline_no == 0)
+			{
+				errno = EBADMSG;
+				return -1;
+			}
+			if (complete_pipelined(1) == -1) return -1;
+			continue;
+		}
+		sent = send(fd_socket, (const void*) buf, len, MSG_DONTWAIT);
+		if (sent == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+			return -1;
+		}
+		buf += sent;
+		len -= (size_t) sent;
+	}
+	return 0;
+}
+
+/**
+ * @brief Fills given header of a binary request, tagging it with a new id.
+*/
+static void
+init_header(request_header_t* header, opcodes_t opcode, int flags, size_t path_len, size_t payload_len)
+{
+	memset(header, 0, sizeof(request_header_t));
+	header->magic = PROTOCOL_MAGIC;
+	header->version = PROTOCOL_VERSION;
+	header->opcode = (uint8_t) opcode;
+	header->flags = (uint8_t) flags;
+	header->path_len = (uint16_t) path_len;
+	header->payload_len = (uint64_t) payload_len;
+	header->request_id = ++request_id;
+}
+
+/**
+ * @brief Sends a binary request made of a header followed by given path and, if any, given payload.
+ * @returns 0 on success, -1 on failure.
+ * @param path if NULL, an empty path is sent.
+ * @param payload if NULL, payload is left to be sent by callee.
+ * @param payload_len length of the payload following the request, whether it is sent by this function or not.
+ * @param pipelined if true, replies to previous requests are received whenever the socket cannot be written to.
+ * @exception It sets "errno" to "EINVAL" if path is longer than MAXPATH. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "writen", "write_pipelined".
+ * @note Small payloads are sent along with the header in a single write.
+*/
+static int
+send_frame(opcodes_t opcode, int flags, const char* path, const void* payload, size_t payload_len, bool pipelined)
+{
+	char frame[FRAMELEN];
+	request_header_t header;
+	size_t path_len = path ? strlen(path) : 0;
+	size_t frame_len = sizeof(request_header_t) + path_len;
+
+	if (path_len > MAXPATH)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	init_header(&header, opcode, flags, path_len, payload_len);
+	memcpy(frame, &header, sizeof(request_header_t));
+	if (path_len != 0) memcpy(frame + sizeof(request_header_t), path, path_len);
+	if (payload && frame_len + payload_len <= FRAMELEN)
+	{
+		memcpy(frame + frame_len, payload, payload_len);
+		frame_len += payload_len;
+		payload = NULL;
+	}
+	if (pipelined)
+	{
+		if (write_pipelined(frame, frame_len) == -1) return -1;
+		if (payload && payload_len != 0 && write_pipelined((const char*) payload, payload_len) == -1) return -1;
+		return 0;
+	}
+	if (writen((long) fd_socket, (void*) frame, frame_len) == -1) return -1;
+	if (payload && payload_len != 0 && writen((long) fd_socket, (void*) payload, payload_len) == -1) return -1;
+	return 0;
+}
+
+/**
+ * @brief Sends a binary request whose reply is to be waited for by callee.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines
+ * "complete_pipelined", "send_frame".
+ * @note As replies are sent in order, the ones to pipelined requests are received first.
+*/
+static int
+send_request(opcodes_t opcode, int flags, const char* path, const void* payload, size_t payload_len)
+{
+	if (pipeline_no != 0 && complete_pipelined(pipeline_no) == -1) return -1;
+	return send_frame(opcode, flags, path, payload, payload_len, false);
+}
+
+/**
+ * @brief Reads given length from given file into given chunk. If the file is shorter, the rest of the chunk
+ * is filled with zeros.
+ * @returns true if the chunk has been read whole, false otherwise.
+ * @param file if NULL, the chunk is filled with zeros.
+*/
+static bool
+read_chunk(FILE* file, char* chunk, size_t length)
+{
+	size_t read_len = (file && length != 0) ? fread(chunk, sizeof(char), length, file) : 0;
+
+	if (read_len == length) return true;
+	memset(chunk + read_len, 0, length - read_len);
+	return false;
+}
+
+/**
+ * @brief Sends given length of given file's contents one chunk at a time, hence the file is never held in memory
+ * as a whole.
+ * @returns 0 on success, -1 on failure.
+ * @param file if NULL, zeros are sent and the function fails.
+ * @param length if the file gets shorter in the meantime, the missing bytes are sent as zeros for the stream
+ * to stay well formed, then the function fails.
+ * @param pipelined if true, replies to previous requests are received whenever the socket cannot be written to.
+ * @exception It sets "errno" to "EBADE" if the file could not be read whole. The function may also fail and set
+ * "errno" for any of the errors specified for the routines "writen", "write_pipelined".
+*/
+static int
+stream_file(FILE* file, size_t length, bool pipelined)
+{
+	char chunk[UPLOAD_CHUNK];
+	size_t chunk_len; // length of the chunk being sent
+	bool truncated = false; // toggled on if the file has got shorter
+
+	for (size_t sent = 0; sent < length; sent += chunk_len)
+	{
+		chunk_len = MIN(length - sent, UPLOAD_CHUNK);
+		if (!read_chunk(file, chunk, chunk_len)) truncated = true;
+		if (pipelined && write_pipelined(chunk, chunk_len) == -1) return -1;
+		if (!pipelined && writen((long) fd_socket, (void*) chunk, chunk_len) == -1) return -1;
+	}
+	if (truncated)
+	{
+		errno = EBADE;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Sends a binary request whose payload is given file's contents, which are streamed as "stream_file" does.
+ * @returns 0 on success, -1 on failure.
+ * @param file cannot be NULL, it must be positioned at its beginning.
+ * @param length length of the payload declared by the request.
+ * @param pipelined if false, replies to pipelined requests are received first.
+ * @exception It sets "errno" to "EBADE" if the file could not be read whole: the request has been sent nonetheless.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "complete_pipelined",
+ * "send_frame", "stream_file".
+ * @note Files fitting a single chunk are sent along with their request.
+*/
+static int
+send_file(opcodes_t opcode, const char* path, FILE* file, size_t length, bool pipelined)
+{
+	char chunk[UPLOAD_CHUNK];
+	bool truncated = false; // toggled on if the file has got shorter
+
+	if (!pipelined && pipeline_no != 0 && complete_pipelined(pipeline_no) == -1) return -1;
+	if (length > UPLOAD_CHUNK)
+	{
+		if (send_frame(opcode, 0, path, NULL, length, pipelined) == -1) return -1;
+		return stream_file(file, length, pipelined);
+	}
+	truncated = !read_chunk(file, chunk, length);
+	if (send_frame(opcode, 0, path, chunk, length, pipelined) == -1) return -1;
+	if (truncated)
+	{
+		errno = EBADE;
+		return -1;
+	}
+	return 0;
+}
+
+
+/**
+ * @brief Reads from the socket exactly given size, failing on a premature end of stream.
+ * @returns 0 on success, -1 on failure.
+ * @exception It sets "errno" to "EBADMSG" if the server has closed the connection. The function may also fail
+ * and set "errno" for any of the errors specified for the routine "readn".
+*/
+static int
+receive_exactly(void* buf, size_t size)
+{
+	int err = readn((long) fd_socket, buf, size);
+	if (err == -1) return -1;
+	if (err == 0 && size != 0)
+	{
+		errno = EBADMSG;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Reads from the socket the reply to given request, made of its outcome and errno value.
+ * @returns 0 on success, -1 on failure.
+ * @param status cannot be NULL, it is set to OP_SUCCESS, OP_FAILURE or OP_FATAL.
+ * @param error cannot be NULL, it is set to errno value sent by the server.
+ * @exception It sets "errno" to "EBADMSG" if the reply is not a valid one or it does not match given request.
+ * The function may also fail and set "errno" for any of the errors specified for the routine "readn".
+*/
+static int
+receive_reply(uint64_t id, int* status, int* error)
+{
+	reply_header_t reply;
+
+	if (receive_exactly((void*) &reply, sizeof(reply_header_t)) == -1) return -1;
+	if (reply.magic != PROTOCOL_MAGIC || reply.request_id != id || reply.status > OP_FATAL)
+	{
+		errno = EBADMSG;
+		return -1;
+	}
+	*status = (int) reply.status;
+	*error = (int) reply.error;
+	return 0;
+}
+
+/**
+ * @brief Reads from the socket a size or a count.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routine "receive_exactly".
+*/
+static int
+receive_size(size_t* size)
+{
+	uint64_t tmp;
+
+	if (receive_exactly((void*) &tmp, sizeof(uint64_t)) == -1) return -1;
+	*size = (size_t) tmp;
+	return 0;
+}
+
+/**
+ * @brief Reads from the socket a file's name and stores it as a string inside given buffer.
+ * @returns 0 on success, -1 on failure.
+ * @param buf must be at least REQUESTLEN bytes long. An empty name marks the end of a stream of files.
+ * @exception It sets "errno" to "EBADMSG" if the name would not fit given buffer. The function may also fail
+ * and set "errno" for any of the errors specified for the routine "receive_exactly".
+*/
+static int
+receive_name(char* buf)
+{
+	size_t len;
+
+	memset(buf, 0, REQUESTLEN);
+	if (receive_size(&len) == -1) return -1;
+	if (len >= REQUESTLEN)
+	{
+		errno = EBADMSG;
+		return -1;
+	}
+	return receive_exactly((void*) buf, len);
+}
+
+/**
+ * @brief Reads from the socket the files evicted by the server while handling the last request and stores
+ * them inside given directory.
+ * @returns 0 on success, -1 on failure.
+ * @param dirname if NULL, evicted files will not be stored.
+ * @param fatal cannot be NULL. It is toggled on if the failure is to be considered a fatal one.
+ * @exception It sets "errno" to "EBADMSG" if any response read from the socket is not a valid one, to "ENAMETOOLONG"
+ * if the path an evicted file would be stored at is too long. The function may also fail and set "errno" for any
+ * of the errors specified for the routines "receive_size", "receive_name", "readn", "malloc", "savefile".
+*/
+static int
+read_victims(const char* dirname, bool* fatal)
+{
+	int err;
+	char buffer[REQUESTLEN];
+	char* contents = NULL;
+	size_t evicted_no = 0;
+	size_t content_size = 0;
+
+	*fatal = false;
+	// get number of victims
+	if (receive_size(&evicted_no) == -1) return -1;
+	while (evicted_no != 0)
+	{
+		// get filename
+		if (receive_name(buffer) == -1) return -1;
+		// get content length
+		if (receive_size(&content_size) == -1) return -1;
+		if (content_size != 0)
+		{
+			contents = (char*) malloc(content_size + 1);
+			if (!contents)
+			{
+				*fatal = true;
+				return -1;
+			}
+			memset(contents, 0, content_size + 1);
+			if (readn((long) fd_socket, (void*) contents, content_size) == -1) goto failure;
+		}
+		// files are to be stored if and only if dirname has been specified
+		if (dirname)
+		{
+			// prepend dirname to filename
+			size_t dir_len = strlen(dirname);
+			if (dir_len + strlen(buffer) > PATH_MAX)
+			{
+				errno = ENAMETOOLONG;
+				goto failure;
+			}
+			memmove(buffer + dir_len, buffer, strlen(buffer) + 1);
+			memcpy(buffer, dirname, dir_len);
+			// save file
+			if (savefile(buffer, contents ? contents : "") == -1) goto failure;
+		}
+		free(contents); contents = NULL;
+		evicted_no--;
+	}
+	return 0;
+
+	failure:
+		err = errno;
+		free(contents);
+		errno = err;
+		return -1;
+}
+
+/**
+ * @brief Asks the server to reserve space for given file before its contents are sent. Files evicted to make room
+ * for it are received right away.
+ * @returns 0 if space has been reserved, -1 otherwise.
+ * @param fatal cannot be NULL, it is toggled on if a fatal error has been triggered either inside the storage or
+ * while receiving evicted files.
+ * @exception It sets "errno" to the "errno" value set in the storage if the reservation has been denied.
+ * The function may also fail and set "errno" for any of the errors specified for the routines "complete_pipelined",
+ * "send_frame", "receive_reply", "read_victims".
+ * @note Replies to pipelined requests are received first. On success, file contents are to be sent right away:
+ * the reply to the write follows them.
+*/
+static int
+reserve_file(const char* pathname, size_t length, const char* dirname, bool* fatal)
+{
+	int answer, answer_errno;
+
+	*fatal = false;
+	if (pipeline_no != 0 && complete_pipelined(pipeline_no) == -1) return -1;
+	if (send_frame(WRITE, WRITE_RESERVE, pathname, NULL, length, false) == -1) return -1;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1) return -1;
+	if (read_victims(dirname, fatal) == -1) return -1;
+	if (answer == OP_SUCCESS) return 0;
+	*fatal = (answer == OP_FATAL);
+	errno = answer_errno;
+	return -1;
+}
+
+/**
+ * @brief Prints the outcome of a request which has not been waited for the same way it is printed when it is.
+*/
+static void
+print_outcome(opcodes_t opcode, int flags, const char* pathname, const char* dirname, int answer, int answer_errno)
+{
+	char request_string[REQUESTLEN];
+	char error_string[ERRORSTRINGLEN];
+
+	if (!print_enabled) return;
+	if (!dirname) dirname = "NULL";
+	switch (opcode)
+	{
+		case OPEN:
+			snprintf(request_string, REQUESTLEN, "openFile %s %d", pathname, flags);
+			break;
+
+		case READ:
+			snprintf(request_string, REQUESTLEN, "readFile %s", pathname);
+			break;
+
+		case WRITE:
+			snprintf(request_string, REQUESTLEN, "writeFile %s %s", pathname, dirname);
+			break;
+
+		case APPEND:
+			snprintf(request_string, REQUESTLEN, "appendToFile %s %s", pathname, dirname);
+			break;
+
+		case LOCK:
+			snprintf(request_string, REQUESTLEN, "lockFile %s", pathname);
+			break;
+
+		case UNLOCK:
+			snprintf(request_string, REQUESTLEN, "unlockFile %s", pathname);
+			break;
+
+		case CLOSE:
+			snprintf(request_string, REQUESTLEN, "closeFile %s", pathname);
+			break;
+
+		case REMOVE:
+			snprintf(request_string, REQUESTLEN, "removeFile %s", pathname);
+			break;
+
+		default:
+			return;
+	}
+	if (answer == OP_SUCCESS)
+	{
+		fprintf(stdout, "%s : SUCCESS.\n", request_string);
+		return;
+	}
+	strerror_r(answer_errno, error_string, ERRORSTRINGLEN);
+	fprintf(stdout, "%s : %s. errno = %s.\n", request_string, (answer == OP_FATAL) ? "FATAL ERROR" : "FAILURE",
+				error_string);
+}
+
+/**
+ * @brief Reads from the socket the reply to given request along with whatever follows it: evicted files are stored
+ * inside given directory, read contents are stored inside given buffer.
+ * @returns 0 on success, -1 on failure.
+ * @param buf if NULL, contents following the reply to a READ request are discarded. Otherwise it is set to a null terminated
+ * buffer to be freed by callee, or to NULL if the file is empty.
+ * @param answer cannot be NULL, it is set to OP_SUCCESS, OP_FAILURE or OP_FATAL. Failures in storing evicted files
+ * or read contents are accounted for as failures of the request.
+ * @param answer_errno cannot be NULL, it is set to errno value of the request.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "receive_reply",
+ * "receive_size", "receive_exactly".
+*/
+static int
+receive_outcome(uint64_t id, opcodes_t opcode, int flags, const char* dirname, void** buf, size_t* size,
+			int* answer, int* answer_errno)
+{
+	bool victims_fatal = false;
+	char* contents = NULL;
+	size_t contents_size = 0;
+
+	if (receive_reply(id, answer, answer_errno) == -1) return -1;
+	// evicted files and read contents follow the reply just as they do when the request is waited for
+	if (opcode == WRITE || opcode == APPEND || (opcode == OPEN && IS_O_CREATE_SET(flags) && *answer != OP_FATAL))
+	{
+		if (read_victims(dirname, &victims_fatal) == -1)
+		{
+			*answer_errno = errno;
+			*answer = victims_fatal ? OP_FATAL : OP_FAILURE;
+		}
+	}
+	if (opcode == READ && flags == READ_CONTENTS && *answer != OP_FATAL)
+	{
+		if (receive_size(&contents_size) == -1) return -1;
+		if (contents_size != 0)
+		{
+			contents = (char*) malloc(contents_size + 1);
+			if (!contents) return -1;
+			if (receive_exactly((void*) contents, contents_size) == -1)
+			{
+				free(contents);
+				return -1;
+			}
+			contents[contents_size] = '\0'; // string needs to be null terminated
+		}
+		if (buf) *buf = (void*) contents;
+		else free(contents);
+		if (size) *size = contents_size;
+	}
+	return 0;
+}
+
+/**
+ * @brief Receives the replies to given number of pipelined requests, oldest first. Failures are recorded
+ * to be reported by "pipelineDrain".
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routine "receive_outcome".
+ * @note If any of the requests triggered a fatal error, the callee may exit with an exit status equal to
+ * the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+*/
+static int
+complete_pipelined(size_t n)
+{
+	int answer, answer_errno;
+	struct pipelined_request* req;
+
+	while (n != 0 && pipeline_no != 0)
+	{
+		req = &(pipeline[pipeline_head]);
+		if (receive_outcome(req->id, req->opcode, req->flags, req->dirname, NULL, NULL, &answer, &answer_errno) == -1)
+			return -1;
+		print_outcome(req->opcode, req->flags, req->pathname, req->dirname, answer, answer_errno);
+		if (answer != OP_SUCCESS)
+		{
+			if (pipeline_failures == 0) pipeline_errno = answer_errno;
+			pipeline_failures++;
+		}
+		free(req->dirname); req->dirname = NULL;
+		pipeline_head = (pipeline_head + 1) % PIPELINE_DEPTH;
+		pipeline_no--;
+		n--;
+		if (answer == OP_FATAL && exit_on_fatal_errors) exit(answer_errno);
+	}
+	return 0;
+}
+
+/**
+ * @brief Sends a binary request without waiting for its reply, which is received as soon as it is needed.
+ * @returns 0 on success, -1 on failure.
+ * @param file if not NULL, the payload is read from it as it is sent rather than taken from given buffer.
+ * If flags are set to "WRITE_RESERVE" as well, the request has already been sent by "reserve_file": only the payload
+ * is sent.
+ * @param dirname if not NULL, files evicted while handling the request will be stored inside it.
+ * @exception It sets "errno" to "ENOTCONN" if callee is not connected to a socket. The function may also fail
+ * and set "errno" for any of the errors specified for the routines "complete_pipelined", "send_frame", "send_file",
+ * "strdup".
+ * @note If PIPELINE_DEPTH requests are already awaiting their reply, the oldest one is completed first.
+*/
+static int
+pipeline_request(opcodes_t opcode, int flags, const char* pathname, const void* payload, size_t payload_len,
+			FILE* file, const char* dirname)
+{
+	int err;
+	struct pipelined_request* req;
+	char* dirname_copy = NULL;
+
+	if (fd_socket == -1)
+	{
+		errno = ENOTCONN;
+		return -1;
+	}
+	if (pipeline_no == PIPELINE_DEPTH && complete_pipelined(1) == -1) return -1;
+	if (dirname && !(dirname_copy = strdup(dirname))) return -1;
+	if (!file) err = send_frame(opcode, flags, pathname, payload, payload_len, true);
+	else if (flags == WRITE_RESERVE) err = stream_file(file, payload_len, true);
+	else err = send_file(opcode, pathname, file, payload_len, true);
+	// a file which could not be read whole has been sent nonetheless: its reply is still to be received
+	if (err == -1 && errno != EBADE)
+	{
+		free(dirname_copy);
+		return -1;
+	}
+	// previous replies may have been received while sending, hence the slot is chosen only now
+	req = &(pipeline[(pipeline_head + pipeline_no) % PIPELINE_DEPTH]);
+	req->id = request_id;
+	req->opcode = opcode;
+	req->flags = flags;
+	strncpy(req->pathname, pathname, MAXPATH);
+	req->pathname[MAXPATH] = '\0';
+	req->dirname = dirname_copy;
+	pipeline_no++;
+	if (err == -1) errno = EBADE;
+	return err;
+}
+
+/**
+ * @brief Sends given requests as a single batch, then receives their replies and prints the outcome of each of them.
+ * @returns 0 if every request has succeeded, -1 otherwise.
+ * @param entries cannot be NULL. Read contents are stored inside them.
+ * @param dirname if not NULL, files evicted while handling the requests will be stored inside it.
+ * @exception It sets "errno" to "EINVAL" if any pathname is not valid, to "ENOTCONN" if callee is not connected
+ * to a socket, to "EBADMSG" if any response read from the socket is not a valid one, to the "errno" value of the first
+ * failed request if any has failed. The function may also fail and set "errno" for any of the errors specified
+ * for the routines "malloc", "writen", "complete_pipelined", "receive_outcome".
+ * @note If any of the requests triggered a fatal error, the callee may exit with an exit status equal to
+ * the "errno" value set in the storage if "exit_on_fatal_errors" has been toggled on.
+*/
+static int
+run_batch(struct batch_entry* entries, size_t n, const char* dirname)
+{
+	int err;
+	int answer, answer_errno;
+	int first_errno = 0; // errno value of the first failed request
+	request_header_t header;
+	uint64_t batch_id, count = (uint64_t) n;
+	size_t batch_len = sizeof(uint64_t); // length of the payload of the batch
+	size_t frame_len = sizeof(request_header_t) + sizeof(uint64_t); // length of the part not streamed from files
+	size_t path_len, offset, replies_no;
+	bool truncated = false; // toggled on if any streamed file has got shorter or could not be opened
+	char* frame = NULL;
+	FILE* file = NULL;
+
+	if (fd_socket == -1)
+	{
+		errno = ENOTCONN;
+		return -1;
+	}
+	for (size_t i = 0; i < n; i++)
+	{
+		if (!entries[i].pathname || strlen(entries[i].pathname) > MAXPATH)
+		{
+			errno = EINVAL;
+			return -1;
+		}
+		entries[i].status = OP_FAILURE;
+		entries[i].buf = NULL;
+		entries[i].size = 0;
+		batch_len += sizeof(request_header_t) + strlen(entries[i].pathname) + entries[i].payload_len;
+		frame_len += sizeof(request_header_t) + strlen(entries[i].pathname);
+		if (!entries[i].streamed) frame_len += entries[i].payload_len;
+	}
+	if (n == 0) return 0;
+
+	// the whole batch is sent with a single write, but for the files which are streamed
+	frame = (char*) malloc(frame_len);
+	if (!frame) return -1;
+	// replies to pipelined requests precede the ones to this batch
+	if (pipeline_no != 0 && complete_pipelined(pipeline_no) == -1) goto failure;
+	init_header(&header, BATCH, 0, 0, batch_len);
+	batch_id = request_id;
+	memcpy(frame, &header, sizeof(request_header_t));
+	memcpy(frame + sizeof(request_header_t), &count, sizeof(uint64_t));
+	offset = sizeof(request_header_t) + sizeof(uint64_t);
+	for (size_t i = 0; i < n; i++)
+	{
+		path_len = strlen(entries[i].pathname);
+		init_header(&header, entries[i].opcode, entries[i].flags, path_len, entries[i].payload_len);
+		entries[i].id = request_id;
+		memcpy(frame + offset, &header, sizeof(request_header_t));
+		offset += sizeof(request_header_t);
+		memcpy(frame + offset, entries[i].pathname, path_len);
+		offset += path_len;
+		if (entries[i].streamed)
+		{
+			// whatever precedes the file is sent first, then the file is opened only while it is being sent
+			if (writen((long) fd_socket, (void*) frame, offset) == -1) goto failure;
+			offset = 0;
+			file = fopen(entries[i].pathname, "r");
+			err = stream_file(file, entries[i].payload_len, false);
+			if (file) fclose(file);
+			if (err == -1)
+			{
+				if (errno != EBADE) goto failure;
+				truncated = true;
+			}
+			continue;
+		}
+		if (entries[i].payload_len != 0) memcpy(frame + offset, entries[i].payload, entries[i].payload_len);
+		offset += entries[i].payload_len;
+	}
+	if (offset != 0 && writen((long) fd_socket, (void*) frame, offset) == -1) goto failure;
+	free(frame); frame = NULL;
+
+	// the batch itself is always accepted, then its requests are replied to one at a time
+	if (receive_reply(batch_id, &answer, &answer_errno) == -1) return -1;
+	if (receive_size(&replies_no) == -1) return -1;
+	if (answer != OP_SUCCESS || replies_no != n)
+	{
+		errno = EBADMSG;
+		return -1;
+	}
+	for (size_t i = 0; i < n; i++)
+	{
+		if (receive_outcome(entries[i].id, entries[i].opcode, entries[i].flags, dirname, &(entries[i].buf),
+					&(entries[i].size), &answer, &answer_errno) == -1)
+			return -1;
+		entries[i].status = answer;
+		print_outcome(entries[i].opcode, entries[i].flags, entries[i].pathname, dirname, answer, answer_errno);
+		if (answer != OP_SUCCESS && first_errno == 0) first_errno = answer_errno;
+		if (answer == OP_FATAL && exit_on_fatal_errors) exit(answer_errno);
+	}
+	if (first_errno == 0 && truncated) first_errno = EBADE;
+	if (first_errno != 0)
+	{
+		errno = first_errno;
+		return -1;
+	}
+	return 0;
+
+	failure:
+		err = errno;
+		free(frame);
+		errno = err;
+		return -1;
+}
+
+/**
+ * @brief Runs the same operation on every given file as a single batch.
+ * @returns 0 if it has succeeded on every file, -1 otherwise.
+ * @exception It sets "errno" to "EINVAL" if any param is not valid. The function may also fail and set "errno"
+ * for any of the errors specified for the routines "malloc", "run_batch".
+*/
+static int
+batch_files(opcodes_t opcode, int flags, const char** pathnames, size_t n, const char* dirname)
+{
+	int err;
+	struct batch_entry* entries = NULL;
+
+	if (!pathnames || n == 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	entries = (struct batch_entry*) calloc(n, sizeof(struct batch_entry));
+	if (!entries) return -1;
+	for (size_t i = 0; i < n; i++)
+	{
+		entries[i].opcode = opcode;
+		entries[i].flags = flags;
+		entries[i].pathname = pathnames[i];
+	}
+	err = run_batch(entries, n, dirname);
+	free(entries);
+	return err;
+}
+
 int
 openConnection(const char* sockname, int msec, const struct timespec abstime)
 {
@@ -115,12 +872,8 @@ closeConnection(const char* sockname)
 	 * it is first required the client sends a "termination" message.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d", TERMINATE);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// it is necessary to send the whole request at this point
+	if (send_request(TERMINATE, 0, NULL, NULL, 0) == -1)
 	{
 		err = errno;
 		goto failure;
@@ -136,6 +889,8 @@ closeConnection(const char* sockname)
 	}
 
 	fd_socket = -1;
+	pipeline_failures = 0;
+	pipeline_errno = 0;
 
 	PRINT_IF(print_enabled, "closeConnection %s : SUCCESS.\n", sockname);
 	return 0;
@@ -150,6 +905,12 @@ closeConnection(const char* sockname)
 
 int
 openFile(const char* pathname, int flags)
+{
+	return openFileEvicted(pathname, flags, NULL);
+}
+
+int
+openFileEvicted(const char* pathname, int flags, const char* dirname)
 {
 	int err;
 	char error_string[ERRORSTRINGLEN];
@@ -167,37 +928,110 @@ openFile(const char* pathname, int flags)
 
 	/**
 	 * The actual open will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(OPEN) PATHNAME FLAGS.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(OPEN, FLAGS) PATHNAME.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %s %d", OPEN, pathname, flags);
+	// it is necessary to send the whole request at this point
+	if (send_request(OPEN, flags, pathname, NULL, 0) == -1)
+	{
+		err = errno;
+		goto failure;
+	}
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
+	{
+		err = errno;
+		goto failure;
+	}
+	bool _failure = false, victims_fatal = false;
+	// handle output
+	switch (answer)
+	{
+		case OP_SUCCESS:
+			break;
 
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+		case OP_FAILURE:
+			err = answer_errno;
+			_failure = true;
+			break;
+
+		case OP_FATAL:
+			err = answer_errno;
+			goto fatal;
+	}
+	// when creating a file, the server sends the files evicted to make room for it
+	if (IS_O_CREATE_SET(flags) && read_victims(dirname, &victims_fatal) == -1)
 	{
 		err = errno;
+		if (victims_fatal) goto fatal;
+		goto failure;
+	}
+
+	if (_failure) goto failure;
+
+	PRINT_IF(print_enabled, "openFile %s %d : SUCCESS.\n", pathname, flags);
+	return 0;
+
+	failure:
+		strerror_r(err, error_string, ERRORSTRINGLEN);
+		PRINT_IF(print_enabled, "openFile %s %d : FAILURE. errno = %s.\n", pathname, flags,
+					error_string);
+		errno = err;
+		return -1;
+
+	fatal:
+		strerror_r(err, error_string, ERRORSTRINGLEN);
+		PRINT_IF(print_enabled, "openFile %s %d : FATAL ERROR. errno = %s.\n", pathname,
+					flags, error_string);
+		errno = err;
+		if (exit_on_fatal_errors) exit(errno);
+		else return -1;
+}
+
+int
+readFile(const char* pathname, void** buf, size_t* size)
+{
+	int err;
+	char error_string[REQUESTLEN];
+
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		err = EINVAL;
+		goto failure;
+	}
+	if (fd_socket == -1)
+	{
+		err = ENOTCONN;
 		goto failure;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+
+	if (buf) *buf = NULL;
+	if (size) *size = 0;
+
+	/**
+	 * The actual reading will be handled by the server;
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(READ, READ_CONTENTS if contents are wanted) PATHNAME.
+	*/
+
+	// it is necessary to send the whole request at this point
+	if (send_request(READ, (buf && size) ? READ_CONTENTS : 0, pathname, NULL, 0) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
-		err = EBADMSG;
+		err = errno;
 		goto failure;
 	}
-	char errno_str[ERRNOLEN];
+	bool _failure = false, _fatal = false;
 	// handle output
 	switch (answer)
 	{
@@ -205,60 +1039,280 @@ openFile(const char* pathname, int flags)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
+			err = answer_errno;
+			_failure = true;
+			break;
+
+		case OP_FATAL:
+			err = answer_errno;
+			_fatal = true;
+			break;
+	}
+
+	char* read_buffer = NULL;
+	size_t read_size = 0;
+	// size and contents are only sent when they have been asked for
+	if (buf && size)
+	{
+		// read size
+		if (receive_size(&read_size) == -1)
+		{
+			err = errno;
+			goto failure;
+		}
+		// ensure there is enough space for the buffer
+		// to be nul terminated
+		if (read_size !=  0)
+		{
+			read_buffer = (char*) malloc(sizeof(char) * (read_size + 1));
+			if (!read_buffer) // enomem
 			{
 				err = errno;
-				goto failure;
+				goto fatal;
 			}
-			if (sscanf(errno_str, "%d", &err) != 1)
+			memset(read_buffer, 0, read_size + 1);
+			if (readn((long) fd_socket, (void*) read_buffer, read_size) == -1)
 			{
-				err = EBADMSG;
+				err = errno;
 				goto failure;
 			}
-			goto failure;
+			read_buffer[read_size] = '\0';
+		}
+		*size = read_size;
+		// ensure buffer is null terminated
+		*buf = (void*) read_buffer;
+	}
+
+	if (_failure) goto failure;
+	if (_fatal) goto fatal;
+
+	PRINT_IF(print_enabled, "readFile %s : SUCCESS.\n", pathname);
+
+	return 0;
+
+	failure:
+		strerror_r(err, error_string, REQUESTLEN);
+		PRINT_IF(print_enabled, "readFile %s : FAILURE. errno = %s.\n", pathname,
+					error_string);
+		errno = err;
+		return -1;
+
+	fatal:
+		strerror_r(err, error_string, REQUESTLEN);
+		PRINT_IF(print_enabled, "readFile %s : FATAL ERROR. errno = %s.\n", pathname,
+					error_string);
+		errno = err;
+		if (exit_on_fatal_errors) exit(errno);
+		else return -1;
+}
+
+int
+readFileRange(const char* pathname, size_t offset, size_t len, void** buf, size_t* size)
+{
+	int err;
+	char error_string[REQUESTLEN];
+
+	if (!pathname || strlen(pathname) > MAXPATH || !buf || !size)
+	{
+		err = EINVAL;
+		goto failure;
+	}
+	if (fd_socket == -1)
+	{
+		err = ENOTCONN;
+		goto failure;
+	}
+
+	*buf = NULL;
+	*size = 0;
+
+	/**
+	 * The actual reading will be handled by the server;
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(READ_RANGE) PATHNAME OFFSET LENGTH, where offset and length are the payload.
+	*/
+
+	uint64_t args[2] = { (uint64_t) offset, (uint64_t) len };
+	// it is necessary to send the whole request at this point
+	if (send_request(READ_RANGE, 0, pathname, (void*) args, sizeof(args)) == -1)
+	{
+		err = errno;
+		goto failure;
+	}
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
+	{
+		err = errno;
+		goto failure;
+	}
+	bool _failure = false, _fatal = false;
+	// handle output
+	switch (answer)
+	{
+		case OP_SUCCESS:
+			break;
+
+		case OP_FAILURE:
+			err = answer_errno;
+			_failure = true;
+			break;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
+			err = answer_errno;
+			_fatal = true;
+			break;
+	}
+
+	char* read_buffer = NULL;
+	size_t read_size = 0;
+	// size and contents are only sent when they have been asked for
+	if (buf && size)
+	{
+		// read size
+		if (receive_size(&read_size) == -1)
+		{
+			err = errno;
+			goto failure;
+		}
+		// ensure there is enough space for the buffer
+		// to be nul terminated
+		if (read_size !=  0)
+		{
+			read_buffer = (char*) malloc(sizeof(char) * (read_size + 1));
+			if (!read_buffer) // enomem
+			{
+				err = errno;
+				goto fatal;
+			}
+			memset(read_buffer, 0, read_size + 1);
+			if (readn((long) fd_socket, (void*) read_buffer, read_size) == -1)
 			{
 				err = errno;
 				goto failure;
 			}
-			if (sscanf(errno_str, "%d", &err) != 1)
+			read_buffer[read_size] = '\0';
+		}
+		*size = read_size;
+		// ensure buffer is null terminated
+		*buf = (void*) read_buffer;
+	}
+
+	if (_failure) goto failure;
+	if (_fatal) goto fatal;
+
+	PRINT_IF(print_enabled, "readFileRange %s %lu %lu : SUCCESS.\n", pathname, offset, len);
+
+	return 0;
+
+	failure:
+		strerror_r(err, error_string, REQUESTLEN);
+		PRINT_IF(print_enabled, "readFileRange %s %lu %lu : FAILURE. errno = %s.\n", pathname, offset,
+					len, error_string);
+		errno = err;
+		return -1;
+
+	fatal:
+		strerror_r(err, error_string, REQUESTLEN);
+		PRINT_IF(print_enabled, "readFileRange %s %lu %lu : FATAL ERROR. errno = %s.\n", pathname, offset,
+					len, error_string);
+		errno = err;
+		if (exit_on_fatal_errors) exit(errno);
+		else return -1;
+}
+
+int
+statFile(const char* pathname, file_stat_t* stat)
+{
+	int err;
+	char error_string[REQUESTLEN];
+
+	if (!pathname || strlen(pathname) > MAXPATH || !stat)
+	{
+		err = EINVAL;
+		goto failure;
+	}
+	if (fd_socket == -1)
+	{
+		err = ENOTCONN;
+		goto failure;
+	}
+
+	memset(stat, 0, sizeof(file_stat_t));
+
+	/**
+	 * The metadata will be retrieved by the server;
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(STAT) PATHNAME.
+	*/
+
+	// it is necessary to send the whole request at this point
+	if (send_request(STAT, 0, pathname, NULL, 0) == -1)
+	{
+		err = errno;
+		goto failure;
+	}
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
+	{
+		err = errno;
+		goto failure;
+	}
+	uint64_t stat_msg[4];
+	// handle output
+	switch (answer)
+	{
+		case OP_SUCCESS:
+			// read size, version, lock owner and open count
+			if (receive_exactly((void*) stat_msg, sizeof(stat_msg)) == -1)
 			{
-				err = EBADMSG;
+				err = errno;
 				goto failure;
 			}
+			stat->size = (size_t) stat_msg[0];
+			stat->version = (unsigned long) stat_msg[1];
+			stat->lock_owner = (int) stat_msg[2];
+			stat->open_count = (size_t) stat_msg[3];
+			break;
+
+		case OP_FAILURE:
+			err = answer_errno;
+			goto failure;
+
+		case OP_FATAL:
+			err = answer_errno;
 			goto fatal;
 	}
 
-	PRINT_IF(print_enabled, "openFile %s %d : SUCCESS.\n", pathname, flags);
+	PRINT_IF(print_enabled, "statFile %s : SUCCESS.\n", pathname);
+
 	return 0;
 
 	failure:
 		strerror_r(err, error_string, REQUESTLEN);
-		PRINT_IF(print_enabled, "openFile %s %d : FAILURE. errno = %s.\n", pathname, flags,
-					error_string);
+		PRINT_IF(print_enabled, "statFile %s : FAILURE. errno = %s.\n", pathname, error_string);
 		errno = err;
 		return -1;
 
 	fatal:
 		strerror_r(err, error_string, REQUESTLEN);
-		PRINT_IF(print_enabled, "openFile %s %d : FATAL ERROR. errno = %s.\n", pathname,
-					flags, error_string);
+		PRINT_IF(print_enabled, "statFile %s : FATAL ERROR. errno = %s.\n", pathname, error_string);
 		errno = err;
 		if (exit_on_fatal_errors) exit(errno);
 		else return -1;
 }
 
 int
-readFile(const char* pathname, void** buf, size_t* size)
+listFiles(const char* prefix, char** list, size_t* size)
 {
 	int err;
 	char error_string[REQUESTLEN];
-
-	if (!pathname || strlen(pathname) > MAXPATH)
+	const char* separator = (prefix && *prefix != '\0') ? " " : ""; // used when printing prefix
+	if (!prefix) prefix = "";
+	if (strlen(prefix) > MAXPATH || strchr(prefix, ' ') || !list || !size)
 	{
 		err = EINVAL;
 		goto failure;
@@ -269,138 +1323,85 @@ readFile(const char* pathname, void** buf, size_t* size)
 		goto failure;
 	}
 
-	if (buf) *buf = NULL;
-	if (size) *size = 0;
+	*list = NULL;
+	*size = 0;
 
 	/**
-	 * The actual reading will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(READ) PATHNAME.
+	 * The names will be retrieved by the server;
+	 * the client will send a binary request for them.
+	 * The request will follow the following format:
+	 * HEADER(LIST) [PREFIX].
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	if (buf && size)
-		snprintf(buffer, REQUESTLEN, "%d %s 1", READ, pathname);
-	else
-		snprintf(buffer, REQUESTLEN, "%d %s 0", READ, pathname);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// it is necessary to send the whole request at this point
+	if (send_request(LIST, 0, prefix, NULL, 0) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
-	bool _failure = false, _fatal = false;
+	char* list_buffer = NULL;
+	size_t list_size = 0;
 	// handle output
 	switch (answer)
 	{
 		case OP_SUCCESS:
-			break;
-
-		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
+			// read size
+			if (receive_size(&list_size) == -1)
 			{
 				err = errno;
 				goto failure;
 			}
-			if (sscanf(errno_str, "%d", &err) != 1)
+			// ensure there is enough space for the buffer
+			// to be nul terminated
+			if (list_size != 0)
 			{
-				err = EBADMSG;
-				goto failure;
+				list_buffer = (char*) malloc(sizeof(char) * (list_size + 1));
+				if (!list_buffer) // enomem
+				{
+					err = errno;
+					goto fatal;
+				}
+				if (readn((long) fd_socket, (void*) list_buffer, list_size) == -1)
+				{
+					err = errno;
+					free(list_buffer);
+					goto failure;
+				}
+				list_buffer[list_size] = '\0';
 			}
-			_failure = true;
 			break;
 
-		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
-			_fatal = true;
-			break;
-	}
+		case OP_FAILURE:
+			err = answer_errno;
+			goto failure;
 
-	char* read_buffer = NULL;
-	size_t read_size = 0;
-	// read size
-	char msg_size[SIZELEN];
-	memset(msg_size, 0, SIZELEN);
-	if (readn((long) fd_socket, (void*) msg_size, SIZELEN) == -1)
-	{
-		err = errno;
-		goto failure;
-	}
-	if (sscanf(msg_size, "%lu", &read_size) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	// ensure there is enough space for the buffer
-	// to be nul terminated
-	if (read_size !=  0)
-	{
-		read_buffer = (char*) malloc(sizeof(char) * (read_size + 1));
-		if (!read_buffer) // enomem
-		{
-			err = errno;
+		case OP_FATAL:
+			err = answer_errno;
 			goto fatal;
-		}
-		memset(read_buffer, 0, read_size + 1);
-		if (readn((long) fd_socket, (void*) read_buffer, read_size) == -1)
-		{
-			err = errno;
-			goto failure;
-		}
-		read_buffer[read_size] = '\0';
 	}
-	*size = read_size;
-	// ensure buffer is null terminated
-	*buf = (void*) read_buffer;
-
-	if (_failure) goto failure;
-	if (_fatal) goto fatal;
+	*list = list_buffer;
+	*size = list_size;
 
-	PRINT_IF(print_enabled, "readFile %s : SUCCESS.\n", pathname);
+	PRINT_IF(print_enabled, "listFiles%s%s : SUCCESS.\n", separator, prefix);
 
 	return 0;
 
 	failure:
 		strerror_r(err, error_string, REQUESTLEN);
-		PRINT_IF(print_enabled, "readFile %s : FAILURE. errno = %s.\n", pathname,
-					error_string);
+		PRINT_IF(print_enabled, "listFiles%s%s : FAILURE. errno = %s.\n", separator, prefix, error_string);
 		errno = err;
 		return -1;
 
 	fatal:
 		strerror_r(err, error_string, REQUESTLEN);
-		PRINT_IF(print_enabled, "readFile %s : FATAL ERROR. errno = %s.\n", pathname,
-					error_string);
+		PRINT_IF(print_enabled, "listFiles%s%s : FATAL ERROR. errno = %s.\n", separator, prefix, error_string);
 		errno = err;
 		if (exit_on_fatal_errors) exit(errno);
 		else return -1;
@@ -408,10 +1409,18 @@ readFile(const char* pathname, void** buf, size_t* size)
 
 int
 readNFiles(int N, const char* dirname)
+{
+	return readNFilesPrefix(N, NULL, dirname);
+}
+
+int
+readNFilesPrefix(int N, const char* prefix, const char* dirname)
 {
 	int err;
 	char error_string[REQUESTLEN];
-	if (N < 0)
+	const char* separator = (prefix && *prefix != '\0') ? " " : ""; // used when printing prefix
+	if (!prefix) prefix = "";
+	if (N < 0 || strlen(prefix) > MAXPATH || strchr(prefix, ' '))
 	{
 		err = EINVAL;
 		goto failure;
@@ -425,37 +1434,26 @@ readNFiles(int N, const char* dirname)
 
 	/**
 	 * The actual reading will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(READ_N) PATHNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(READ_N) [PREFIX] N, where N is the payload.
 	*/
 
 	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %d", READ_N, N);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	uint64_t args[1] = { (uint64_t) N };
+	// it is necessary to send the whole request at this point
+	if (send_request(READ_N, 0, prefix, (void*) args, sizeof(args)) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
 	bool _failure = false, _fatal = false;
 	// handle output
 	switch (answer)
@@ -464,132 +1462,91 @@ readNFiles(int N, const char* dirname)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			_failure = true;
 			break;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			_fatal = true;
 			break;
 	}
 	// handle sent files
-	// get number of files
-	char msg_size[SIZELEN];
-	memset(msg_size, 0, SIZELEN);
-	if (readn((long) fd_socket, (void*) msg_size, SIZELEN) == -1)
-	{
-		err = errno;
-		goto failure;
-	}
-	size_t read_no = 0;
-	if (sscanf(msg_size, "%lu", &read_no) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	if (read_no !=  0) // there have been victims
+	// files are streamed one at a time till an empty name is read
+	while (1)
 	{
-		while (1)
+		// get filename
+		if (receive_name(buffer) == -1)
+		{
+			err = errno;
+			goto failure;
+		}
+		if (buffer[0] == '\0') break; // end of stream
+		// get content length
+		size_t content_size;
+		if (receive_size(&content_size) == -1)
 		{
-			if (read_no == 0) break;
-			// get filename
-			memset(buffer, 0, REQUESTLEN);
-			if (readn((long) fd_socket, buffer, REQUESTLEN) == -1)
+			err = errno;
+			goto failure;
+		}
+		char* contents = NULL;
+		if (content_size != 0)
+		{
+			contents = (char*) malloc(content_size + 1);
+			if (!contents)
 			{
 				err = errno;
-				goto failure;
+				goto fatal;
 			}
-			// get content length
-			memset(msg_size, 0, SIZELEN);
-			if (readn((long) fd_socket, msg_size, SIZELEN) == -1)
+			memset(contents, 0, content_size + 1);
+			if (readn((long) fd_socket, (void*) contents, content_size) == -1)
 			{
 				err = errno;
+				free(contents);
 				goto failure;
 			}
-			size_t content_size;
-			if (sscanf(msg_size, "%lu", &content_size) != 1)
+		}
+		// files are to be stored if and only if dirname has been specified
+		if (dirname)
+		{
+			// prepend dirname to filename
+			size_t dir_len = strlen(dirname);
+			if (dir_len + strlen(buffer) > PATH_MAX)
 			{
-				err = EBADMSG;
+				err = ENAMETOOLONG;
+				free(contents);
 				goto failure;
 			}
-			char* contents = NULL;
-			if (content_size != 0)
-			{
-				contents = (char*) malloc(content_size + 1);
-				if (!contents)
-				{
-					err = errno;
-					goto fatal;
-				}
-				memset(contents, 0, content_size + 1);
-				if (readn((long) fd_socket, (void*) contents, content_size) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-			}
-			// files are to be stored if and only if dirname has been specified
-			if (dirname)
+			memmove(buffer + dir_len, buffer, strlen(buffer) + 1);
+			memcpy(buffer, dirname, dir_len);
+			// save file
+			if (savefile(buffer, contents) == -1)
 			{
-				// prepend dirname to filename
-				size_t dir_len = strlen(dirname);
-				if (dir_len + strlen(buffer) > PATH_MAX)
-				{
-					err = ENAMETOOLONG;
-					goto failure;
-				}
-				memmove(buffer + dir_len, buffer, strlen(buffer) + 1);
-				memcpy(buffer, dirname, dir_len);
-				// save file
-				if (savefile(buffer, contents) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
+				err = errno;
+				free(contents);
+				goto failure;
 			}
-			free(contents); contents = NULL;
-			read_no--;
 		}
+		free(contents); contents = NULL;
 	}
 
 	if (_failure) goto failure;
 	if (_fatal) goto fatal;
 
-	PRINT_IF(print_enabled, "readNFiles %d : SUCCESS.\n", N);
+	PRINT_IF(print_enabled, "readNFiles %d%s%s : SUCCESS.\n", N, separator, prefix);
 
 	return 0;
 
 	failure:
 		strerror_r(err, error_string, REQUESTLEN);
-		PRINT_IF(print_enabled, "readNFiles %d : FAILURE. errno = %s.\n", N,
+		PRINT_IF(print_enabled, "readNFiles %d%s%s : FAILURE. errno = %s.\n", N, separator, prefix,
 					error_string);
 		errno = err;
 		return -1;
 
 	fatal:
 		strerror_r(err, error_string, REQUESTLEN);
-		PRINT_IF(print_enabled, "readNFiles %d : FATAL ERROR. errno = %s.\n", N,
+		PRINT_IF(print_enabled, "readNFiles %d%s%s : FATAL ERROR. errno = %s.\n", N, separator, prefix,
 					error_string);
 		errno = err;
 		if (exit_on_fatal_errors) exit(errno);
@@ -619,130 +1576,114 @@ is_regular_file(const char *pathname)
 	return 0;
 }
 
-int
-writeFile(const char* pathname, const char* dirname)
+/**
+ * @brief Opens given regular file for reading.
+ * @returns 0 on success, -1 on failure.
+ * @param file cannot be NULL, it is set to the opened file to be closed by callee.
+ * @param length cannot be NULL, it is set to the length of the file.
+ * @exception It sets "errno" to "EINVAL" if pathname is not a regular file. The function may also fail and set
+ * "errno" for any of the errors specified for the routines "is_regular_file", "fopen", "fseek", "ftell".
+*/
+static int
+open_file(const char* pathname, FILE** file, size_t* length)
 {
 	int err;
-	char error_string[REQUESTLEN];
-	if (!pathname || strlen(pathname) > MAXPATH)
-	{
-		err = EINVAL;
-		goto failure;
-	}
-
-	if (fd_socket == -1)
-	{
-		err = ENOTCONN;
-		goto failure;
-	}
+	long file_length = 0;
 
-	long length = 0;
-	// calculating length
 	// must check whether pathname is a regular file
 	err = is_regular_file(pathname);
-	if (err == -1)
-	{
-		err = errno;
-		goto failure;
-	}
+	if (err == -1) return -1;
 	if (err == 0)
 	{
-		err = EINVAL;
-		goto failure;
+		errno = EINVAL;
+		return -1;
 	}
 
 	// opening file
-	FILE* pathname_file = fopen(pathname, "r");
-	char* pathname_contents = NULL;
-	if (!pathname_file)
-	{
+	FILE* tmp = fopen(pathname, "r");
+	if (!tmp) return -1;
+
+	// calculating file's content buffer length
+	if (fseek(tmp, 0, SEEK_END) != 0) goto failure;
+	if ((file_length = ftell(tmp)) == -1) goto failure;
+	if (fseek(tmp, 0, SEEK_SET) != 0) goto failure;
+	*file = tmp;
+	*length = (size_t) file_length;
+	return 0;
+
+	failure:
 		err = errno;
+		fclose(tmp);
+		errno = err;
+		return -1;
+}
+
+int
+writeFile(const char* pathname, const char* dirname)
+{
+	int err;
+	char error_string[REQUESTLEN];
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		err = EINVAL;
 		goto failure;
 	}
 
-	// calculating file's content buffer length
-	err = fseek(pathname_file, 0, SEEK_END);
-	if (err != 0)
+	if (fd_socket == -1)
 	{
-		err = errno;
-		fclose(pathname_file);
+		err = ENOTCONN;
 		goto failure;
 	}
-	length = ftell(pathname_file);
-	if (fseek(pathname_file, 0, SEEK_SET) != 0)
+
+	FILE* file = NULL;
+	size_t length = 0;
+	if (open_file(pathname, &file, &length) == -1)
 	{
 		err = errno;
-		fclose(pathname_file);
 		goto failure;
 	}
-	// read file contents
-	if (length != 0)
-	{
-		pathname_contents = (char*) malloc(sizeof(char) * (length + 1));
-		if (!pathname_contents)
-		{
-			err = errno;
-			fclose(pathname_file);
-			goto failure;
-		}
-		size_t read_length = fread(pathname_contents, sizeof(char), length, pathname_file);
-		if (read_length != length && ferror(pathname_file)) // fread failed
-		{
-			fclose(pathname_file);
-			free(pathname_contents);
-			err = EBADE;
-			goto failure;
-		}
-		pathname_contents[length] = '\0'; // string needs to be null terminated
-	}
-	fclose(pathname_file);
-
 
 	/**
 	 * The actual writing will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(WRITE) PATHNAME DIRNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(WRITE) PATHNAME CONTENTS, where contents are the payload
+	 * and are streamed from the file one chunk at a time.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %s %lu", WRITE, pathname, length);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// files spanning more than a chunk are sent only once space has been reserved for them,
+	// so that a rejection does not cost their whole transfer
+	bool truncated = false, reserve_fatal = false;
+	if (length > UPLOAD_CHUNK && reserve_file(pathname, length, dirname, &reserve_fatal) == -1)
 	{
 		err = errno;
+		fclose(file);
+		if (reserve_fatal) goto fatal;
 		goto failure;
 	}
-	// send file contents
-	if (length != 0)
+	// it is necessary to send the whole request at this point
+	if (length > UPLOAD_CHUNK) err = stream_file(file, length, false);
+	else err = send_file(WRITE, pathname, file, length, false);
+	if (err == -1)
 	{
-		if (writen((long) fd_socket, (void*) pathname_contents, length) == -1)
+		err = errno;
+		if (err != EBADE)
 		{
-			err = errno;
-			free(pathname_contents);
+			fclose(file);
 			goto failure;
 		}
-		free(pathname_contents);
+		// request has been sent nonetheless: its reply is still to be received
+		truncated = true;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+	fclose(file);
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
-	bool _failure = false, _fatal = false;
+	bool _failure = false, _fatal = false, victims_fatal = false;
 	// handle output
 	switch (answer)
 	{
@@ -750,117 +1691,30 @@ writeFile(const char* pathname, const char* dirname)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			_failure = true;
 			break;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			_fatal = true;
 			break;
 	}
 	// handle evicted files
-	// get number of victims
-	char msg_size[SIZELEN];
-	memset(msg_size, 0, SIZELEN);
-	if (readn((long) fd_socket, (void*) msg_size, SIZELEN) == -1)
+	if (read_victims(dirname, &victims_fatal) == -1)
 	{
 		err = errno;
+		if (victims_fatal) goto fatal;
 		goto failure;
 	}
-	size_t evicted_no = 0;
-	if (sscanf(msg_size, "%lu", &evicted_no) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	if (evicted_no !=  0) // there have been victims
-	{
-		while (1)
-		{
-			if (evicted_no == 0) break;
-			// get filename
-			memset(buffer, 0, REQUESTLEN);
-			if (readn((long) fd_socket, buffer, REQUESTLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			// get content length
-			memset(msg_size, 0, SIZELEN);
-			if (readn((long) fd_socket, msg_size, SIZELEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			size_t content_size;
-			if (sscanf(msg_size, "%lu", &content_size) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
-			char* contents = NULL;
-			if (content_size != 0)
-			{
-				contents = (char*) malloc(content_size + 1);
-				if (!contents)
-				{
-					err = errno;
-					goto fatal;
-				}
-				memset(contents, 0, content_size + 1);
-				if (readn((long) fd_socket, (void*) contents, content_size) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-			}
-			// files are to be stored if and only if dirname has been specified
-			if (dirname)
-			{
-				// prepend dirname to filename
-				size_t dir_len = strlen(dirname);
-				if (dir_len + strlen(buffer) > PATH_MAX)
-				{
-					err = ENAMETOOLONG;
-					goto failure;
-				}
-				memmove(buffer + dir_len, buffer, strlen(buffer) + 1);
-				memcpy(buffer, dirname, dir_len);
-				// save file
-				if (savefile(buffer, contents) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-			}
-			free(contents); contents = NULL;
-			evicted_no--;
-		}
-	}
 
 	if (_failure) goto failure;
 	if (_fatal) goto fatal;
+	if (truncated)
+	{
+		err = EBADE;
+		goto failure;
+	}
 
 	if (dirname)
 	{
@@ -924,47 +1778,25 @@ appendToFile(const char* pathname, void* buf, size_t size, const char* dirname)
 
 	/**
 	 * The actual append will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(APPEND) PATHNAME BUFFER SIZE DIRNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(APPEND) PATHNAME BUFFER, where buffer is the payload.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %s %lu", APPEND, pathname, size);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// it is necessary to send the whole request at this point
+	if (send_request(APPEND, 0, pathname, buf, size) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// send file contents
-	if (size != 0)
-	{
-		if (writen((long) fd_socket, (void*) buf, size) == -1)
-		{
-			err = errno;
-			goto failure;
-		}
-	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
-	bool _failure = false, _fatal = false;
+	bool _failure = false, _fatal = false, victims_fatal = false;
 	// handle output
 	switch (answer)
 	{
@@ -972,114 +1804,22 @@ appendToFile(const char* pathname, void* buf, size_t size, const char* dirname)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			_failure = true;
 			break;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			_fatal = true;
 			break;
 	}
 	// handle evicted files
-	// get number of victims
-	char msg_size[SIZELEN];
-	memset(msg_size, 0, SIZELEN);
-	if (readn((long) fd_socket, (void*) msg_size, SIZELEN) == -1)
+	if (read_victims(dirname, &victims_fatal) == -1)
 	{
 		err = errno;
+		if (victims_fatal) goto fatal;
 		goto failure;
 	}
-	size_t evicted_no = 0;
-	if (sscanf(msg_size, "%lu", &evicted_no) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	if (evicted_no !=  0) // there have been victims
-	{
-		while (1)
-		{
-			if (evicted_no == 0) break;
-			// get filename
-			memset(buffer, 0, REQUESTLEN);
-			if (readn((long) fd_socket, buffer, REQUESTLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			// get content length
-			memset(msg_size, 0, SIZELEN);
-			if (readn((long) fd_socket, msg_size, SIZELEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			size_t content_size;
-			if (sscanf(msg_size, "%lu", &content_size) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
-			char* contents = NULL;
-			if (content_size != 0)
-			{
-				contents = (char*) malloc(content_size + 1);
-				if (!contents)
-				{
-					err = errno;
-					goto fatal;
-				}
-				memset(contents, 0, content_size + 1);
-				if (readn((long) fd_socket, (void*) contents, content_size) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-			}
-			// files are to be stored if and only if dirname has been specified
-			if (dirname)
-			{
-				// prepend dirname to filename
-				size_t dir_len = strlen(dirname);
-				if (dir_len + strlen(buffer) > PATH_MAX)
-				{
-					err = ENAMETOOLONG;
-					goto failure;
-				}
-				memmove(buffer + dir_len, buffer, strlen(buffer) + 1);
-				memcpy(buffer, dirname, dir_len);
-				// save file
-				if (savefile(buffer, contents) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-			}
-			free(contents); contents = NULL;
-			evicted_no--;
-		}
-	}
 
 	if (_failure) goto failure;
 	if (_fatal) goto fatal;
@@ -1124,39 +1864,26 @@ lockFile(const char* pathname)
 
 	/**
 	 * The actual locking will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(LOCK) PATHNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(LOCK) PATHNAME.
 	*/
 
-	char buffer[REQUESTLEN];
 	while (1)
 	{
-		memset(buffer, 0, REQUESTLEN);
-		snprintf(buffer, REQUESTLEN, "%d %s", LOCK, pathname);
-
-		// it is necessary to send the whole buffer at this point
-		if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+		// it is necessary to send the whole request at this point
+		if (send_request(LOCK, 0, pathname, NULL, 0) == -1)
 		{
 			err = errno;
 			goto failure;
 		}
-		// read actual output
-		char answer_str[OPVALUE_LEN];
-		memset(answer_str, 0, OPVALUE_LEN);
-		if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+		// read actual output along with errno value
+		int answer, answer_errno;
+		if (receive_reply(request_id, &answer, &answer_errno) == -1)
 		{
 			err = errno;
 			goto failure;
 		}
-		// check whether output is legal
-		int answer;
-		if (sscanf(answer_str, "%d", &answer) != 1)
-		{
-			err = EBADMSG;
-			goto failure;
-		}
-		char errno_str[ERRNOLEN];
 		// handle output
 		switch (answer)
 		{
@@ -1164,31 +1891,11 @@ lockFile(const char* pathname)
 				goto success;
 
 			case OP_FAILURE:
-				// read errno value
-				if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-				if (sscanf(errno_str, "%d", &err) != 1)
-				{
-					err = EBADMSG;
-					goto failure;
-				}
+				err = answer_errno;
 				if (err != EPERM) goto failure;
 
 			case OP_FATAL:
-				// read errno value
-				if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-				{
-					err = errno;
-					goto failure;
-				}
-				if (sscanf(errno_str, "%d", &err) != 1)
-				{
-					err = EBADMSG;
-					goto failure;
-				}
+				err = answer_errno;
 				goto fatal;
 		}
 	}
@@ -1232,37 +1939,24 @@ unlockFile(const char* pathname)
 
 	/**
 	 * The actual unlocking will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(LOCK) PATHNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(UNLOCK) PATHNAME.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %s", UNLOCK, pathname);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// it is necessary to send the whole request at this point
+	if (send_request(UNLOCK, 0, pathname, NULL, 0) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
 	// handle output
 	switch (answer)
 	{
@@ -1270,31 +1964,11 @@ unlockFile(const char* pathname)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			goto failure;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			goto fatal;
 	}
 
@@ -1337,37 +2011,24 @@ closeFile(const char* pathname)
 
 	/**
 	 * The actual closure will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(CLOSE) PATHNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(CLOSE) PATHNAME.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %s", CLOSE, pathname);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// it is necessary to send the whole request at this point
+	if (send_request(CLOSE, 0, pathname, NULL, 0) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1)
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
 	// handle output
 	switch (answer)
 	{
@@ -1375,31 +2036,11 @@ closeFile(const char* pathname)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			goto failure;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			goto fatal;
 	}
 
@@ -1407,14 +2048,14 @@ closeFile(const char* pathname)
 	return 0;
 
 	failure:
-		strerror_r(err, error_string, REQUESTLEN);
+		strerror_r(err, error_string, ERRORSTRINGLEN);
 		PRINT_IF(print_enabled, "closeFile %s : FAILURE. errno = %s.\n", pathname,
 					error_string);
 		errno = err;
 		return -1;
 
 	fatal:
-		strerror_r(err, error_string, REQUESTLEN);
+		strerror_r(err, error_string, ERRORSTRINGLEN);
 		PRINT_IF(print_enabled, "closeFile %s : FATAL ERROR. errno = %s.\n", pathname,
 					error_string);
 		errno = err;
@@ -1441,37 +2082,24 @@ removeFile(const char* pathname)
 
 	/**
 	 * The actual removal will be handled by the server;
-	 * the client will send a buffer requesting it.
-	 * The buffer will follow the following format:
-	 * OPCODE(REMOVE) PATHNAME.
+	 * the client will send a binary request for it.
+	 * The request will follow the following format:
+	 * HEADER(REMOVE) PATHNAME.
 	*/
 
-	char buffer[REQUESTLEN];
-	memset(buffer, 0, REQUESTLEN);
-	snprintf(buffer, REQUESTLEN, "%d %s", REMOVE, pathname);
-
-	// it is necessary to send the whole buffer at this point
-	if (writen((long) fd_socket, (void*) buffer, REQUESTLEN) == -1)
+	// it is necessary to send the whole request at this point
+	if (send_request(REMOVE, 0, pathname, NULL, 0) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// read actual output
-	char answer_str[OPVALUE_LEN];
-	memset(answer_str, 0, OPVALUE_LEN);
-	if (readn((long) fd_socket, (void*) answer_str, OPVALUE_LEN) == -1) // !!deadlock here!!
+	// read actual output along with errno value
+	int answer, answer_errno;
+	if (receive_reply(request_id, &answer, &answer_errno) == -1)
 	{
 		err = errno;
 		goto failure;
 	}
-	// check whether output is legal
-	int answer;
-	if (sscanf(answer_str, "%d", &answer) != 1)
-	{
-		err = EBADMSG;
-		goto failure;
-	}
-	char errno_str[ERRNOLEN];
 	// handle output
 	switch (answer)
 	{
@@ -1479,31 +2107,11 @@ removeFile(const char* pathname)
 			break;
 
 		case OP_FAILURE:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			goto failure;
 
 		case OP_FATAL:
-			// read errno value
-			if (readn((long) fd_socket, (void*) errno_str, ERRNOLEN) == -1)
-			{
-				err = errno;
-				goto failure;
-			}
-			if (sscanf(errno_str, "%d", &err) != 1)
-			{
-				err = EBADMSG;
-				goto failure;
-			}
+			err = answer_errno;
 			goto fatal;
 	}
 
@@ -1524,4 +2132,215 @@ removeFile(const char* pathname)
 		errno = err;
 		if (exit_on_fatal_errors) exit(errno);
 		else return -1;
-}
\ No newline at end of file
+}
+
+int
+pipelineOpenFile(const char* pathname, int flags, const char* dirname)
+{
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	return pipeline_request(OPEN, flags, pathname, NULL, 0, NULL, IS_O_CREATE_SET(flags) ? dirname : NULL);
+}
+
+int
+pipelineWriteFile(const char* pathname, const char* dirname)
+{
+	int err, errnocopy;
+	bool reserve_fatal = false;
+	FILE* file = NULL;
+	size_t length = 0;
+
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	if (open_file(pathname, &file, &length) == -1) return -1;
+	// files spanning more than a chunk are sent only once space has been reserved for them
+	if (length > UPLOAD_CHUNK && reserve_file(pathname, length, dirname, &reserve_fatal) == -1)
+	{
+		errnocopy = errno;
+		fclose(file);
+		// its outcome is known already, yet it is accounted for when the pipeline is drained as well
+		print_outcome(WRITE, 0, pathname, dirname, reserve_fatal ? OP_FATAL : OP_FAILURE, errnocopy);
+		if (reserve_fatal && exit_on_fatal_errors) exit(errnocopy);
+		if (pipeline_failures == 0) pipeline_errno = errnocopy;
+		pipeline_failures++;
+		errno = errnocopy;
+		return -1;
+	}
+	// contents are streamed from the file as they are sent
+	err = pipeline_request(WRITE, (length > UPLOAD_CHUNK) ? WRITE_RESERVE : 0, pathname, NULL, length, file, dirname);
+	errnocopy = errno;
+	fclose(file);
+	errno = errnocopy;
+	return err;
+}
+
+int
+pipelineAppendToFile(const char* pathname, void* buf, size_t size, const char* dirname)
+{
+	if (!pathname || strlen(pathname) > MAXPATH || (!buf && size != 0))
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	return pipeline_request(APPEND, 0, pathname, buf, size, NULL, dirname);
+}
+
+int
+pipelineUnlockFile(const char* pathname)
+{
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	return pipeline_request(UNLOCK, 0, pathname, NULL, 0, NULL, NULL);
+}
+
+int
+pipelineCloseFile(const char* pathname)
+{
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	return pipeline_request(CLOSE, 0, pathname, NULL, 0, NULL, NULL);
+}
+
+int
+pipelineRemoveFile(const char* pathname)
+{
+	if (!pathname || strlen(pathname) > MAXPATH)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	return pipeline_request(REMOVE, 0, pathname, NULL, 0, NULL, NULL);
+}
+
+int
+pipelineDrain(void)
+{
+	if (fd_socket == -1)
+	{
+		errno = ENOTCONN;
+		return -1;
+	}
+	if (complete_pipelined(pipeline_no) == -1) return -1;
+	if (pipeline_failures == 0) return 0;
+	errno = pipeline_errno;
+	pipeline_failures = 0;
+	pipeline_errno = 0;
+	return -1;
+}
+
+int
+openFiles(const char** pathnames, size_t n, int flags, const char* dirname)
+{
+	return batch_files(OPEN, flags, pathnames, n, IS_O_CREATE_SET(flags) ? dirname : NULL);
+}
+
+int
+readFiles(const char** pathnames, size_t n, void** bufs, size_t* sizes)
+{
+	int err, errnocopy;
+	struct batch_entry* entries = NULL;
+
+	if (!pathnames || n == 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	entries = (struct batch_entry*) calloc(n, sizeof(struct batch_entry));
+	if (!entries) return -1;
+	for (size_t i = 0; i < n; i++)
+	{
+		entries[i].opcode = READ;
+		entries[i].flags = (bufs && sizes) ? READ_CONTENTS : 0;
+		entries[i].pathname = pathnames[i];
+	}
+	err = run_batch(entries, n, NULL);
+	errnocopy = errno;
+	for (size_t i = 0; bufs && sizes && i < n; i++)
+	{
+		// empty files are told apart from the ones which could not be read
+		if (entries[i].status == OP_SUCCESS && !entries[i].buf && !(entries[i].buf = calloc(1, sizeof(char))))
+		{
+			err = -1;
+			errnocopy = errno;
+		}
+		bufs[i] = entries[i].buf;
+		sizes[i] = entries[i].size;
+	}
+	free(entries);
+	errno = errnocopy;
+	return err;
+}
+
+int
+writeFiles(const char** pathnames, size_t n, const char* dirname)
+{
+	int errnocopy = 0, load_errno;
+	struct batch_entry* entries = NULL;
+	FILE* file = NULL;
+	size_t length = 0, loaded = 0;
+
+	if (!pathnames || n == 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	entries = (struct batch_entry*) calloc(n, sizeof(struct batch_entry));
+	if (!entries) return -1;
+	// files which cannot be opened are left out of the batch, the others are streamed as the batch is sent:
+	// each of them is opened again only while it is being sent
+	for (size_t i = 0; i < n; i++)
+	{
+		if (!pathnames[i] || strlen(pathnames[i]) > MAXPATH) errno = EINVAL;
+		else if (open_file(pathnames[i], &file, &length) == 0)
+		{
+			fclose(file);
+			entries[loaded].opcode = WRITE;
+			entries[loaded].pathname = pathnames[i];
+			entries[loaded].streamed = true;
+			entries[loaded].payload_len = length;
+			loaded++;
+			continue;
+		}
+		load_errno = errno;
+		if (errnocopy == 0) errnocopy = load_errno;
+		print_outcome(WRITE, 0, pathnames[i] ? pathnames[i] : "NULL", dirname, OP_FAILURE, load_errno);
+	}
+	if (loaded != 0 && run_batch(entries, loaded, dirname) == -1 && errnocopy == 0) errnocopy = errno;
+	free(entries);
+	if (errnocopy != 0)
+	{
+		errno = errnocopy;
+		return -1;
+	}
+	return 0;
+}
+
+int
+lockFiles(const char** pathnames, size_t n)
+{
+	return batch_files(LOCK, 0, pathnames, n, NULL);
+}
+
+int
+unlockFiles(const char** pathnames, size_t n)
+{
+	return batch_files(UNLOCK, 0, pathnames, n, NULL);
+}
+
+int
+closeFiles(const char** pathnames, size_t n)
+{
+	return batch_files(CLOSE, 0, pathnames, n, NULL);
+}
@@ -14,11 +14,14 @@
 
 #include <hashtable.h>
 #include <linked_list.h>
+#include <radix_tree.h>
 #include <server_defines.h>
 #include <storage.h>
 #include <rwlock.h>
 #include <wrappers.h>
 
+#define CLIENTS_BUCKETS 1024 // buckets of the table of clients' records
+
 // Struct used to denote a file inside storage.
 typedef struct _stored_file
 {
@@ -26,11 +29,14 @@ typedef struct _stored_file
 	char* name; // file name
 	void* contents; // file contents
 	size_t contents_size; // size of file contents
+	unsigned long version; // incremented whenever contents get modified
 
 	int lock_owner; // lock owner's fd; when there is none, it is set to 0.
 	linked_list_t* called_open; // list of fds which called open on this file
 
 	int potential_writer; // will be set to 0 if there is none
+	size_t reserved; // space reserved for contents yet to be written, counted in storage size
+	int reserved_by; // client space has been reserved by; when there is none, it is set to 0.
 	rwlock_t* rwlock; // used for multithreading purposes
 
 	// used for replacement algorithms
@@ -80,9 +86,12 @@ StoredFile_Init(const char* name, const void* contents, size_t contents_size)
 	tmp->name = tmp_name;
 	tmp->contents = tmp_contents;
 	tmp->contents_size = contents_size;
+	tmp->version = 0;
 	tmp->lock_owner = 0;
 	tmp->called_open = tmp_called_open;
 	tmp->potential_writer = 0;
+	tmp->reserved = 0;
+	tmp->reserved_by = 0;
 	tmp->rwlock = tmp_lock;
 	tmp->frequency = 0;
 	tmp->last_used = time(NULL);
@@ -114,6 +123,17 @@ StoredFile_Free(void* arg)
 	free(file);
 }
 
+/**
+ * Frees a client's record: the table keeps a pointer to the list of names in it.
+*/
+static void
+ClientRecord_Free(void* arg)
+{
+	if (!arg) return;
+	LinkedList_Free(*((linked_list_t**) arg));
+	free(arg);
+}
+
 // Used when sorting files in storage according to LFU or LRU policies.
 typedef struct usage
 {
@@ -145,6 +165,7 @@ struct _storage
 	hashtable_t* files; // table of files in storage
 	replacement_policy_t algorithm; // FIFO, LFU, LRU.
 	linked_list_t* names; // list of file names
+	radix_tree_t* index; // file names sorted lexicographically, used for prefix queries
 
 	size_t max_files_no; // maximum number of storeable files
 	size_t max_storage_size; // maximum storage size
@@ -153,6 +174,11 @@ struct _storage
 
 	rwlock_t* lock; // used for multithreading purposes
 
+	// names of the files each client has opened, locked or reserved space in, by client's fd
+	hashtable_t* clients;
+	// records are also edited by clients opening and closing files while storage is locked in read mode
+	pthread_mutex_t clients_mutex;
+
 	// as per requirements:
 	size_t reached_files_no; // maximum reached number of files
 	size_t reached_storage_size; // maximum reached storage size in bytes
@@ -170,7 +196,9 @@ Storage_Init(size_t max_files_no, size_t max_storage_size, replacement_policy_t
 	int err;
 	storage_t* tmp = NULL;
 	linked_list_t* tmp_names = NULL;
+	radix_tree_t* tmp_index = NULL;
 	hashtable_t* tmp_files = NULL;
+	hashtable_t* tmp_clients = NULL;
 	rwlock_t* tmp_lock = NULL;
 	tmp_lock = RWLock_Init();
 	GOTO_LABEL_IF_EQ(tmp_lock, NULL, err, init_failure);
@@ -178,12 +206,20 @@ Storage_Init(size_t max_files_no, size_t max_storage_size, replacement_policy_t
 	GOTO_LABEL_IF_EQ(tmp, NULL, err, init_failure);
 	tmp_names = LinkedList_Init(free);
 	GOTO_LABEL_IF_EQ(tmp_names, NULL, err, init_failure);
+	tmp_index = RadixTree_Init();
+	GOTO_LABEL_IF_EQ(tmp_index, NULL, err, init_failure);
 	tmp_files = HashTable_Init(max_files_no, NULL, NULL, StoredFile_Free);
 	GOTO_LABEL_IF_EQ(tmp_files, NULL, err, init_failure);
+	tmp_clients = HashTable_Init(CLIENTS_BUCKETS, NULL, NULL, ClientRecord_Free);
+	GOTO_LABEL_IF_EQ(tmp_clients, NULL, err, init_failure);
+	errno = pthread_mutex_init(&(tmp->clients_mutex), NULL);
+	GOTO_LABEL_IF_NEQ(errno, 0, err, init_failure);
 
 	tmp->algorithm = chosen_algo;
 	tmp->files = tmp_files;
 	tmp->names = tmp_names;
+	tmp->index = tmp_index;
+	tmp->clients = tmp_clients;
 	tmp->lock = tmp_lock;
 	tmp->max_files_no = max_files_no;
 	tmp->max_storage_size = max_storage_size;
@@ -199,12 +235,117 @@ Storage_Init(size_t max_files_no, size_t max_storage_size, replacement_policy_t
 		err = errno;
 		RWLock_Free(tmp_lock);
 		LinkedList_Free(tmp_names);
+		RadixTree_Free(tmp_index);
 		HashTable_Free(tmp_files);
+		HashTable_Free(tmp_clients);
 		free(tmp);
 		errno = err;
 		return NULL;
 }
 
+/**
+ * @brief Adds given file to given client's record, unless it is already there.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines
+ * "pthread_mutex_lock", "HashTable_GetPointerToData", "HashTable_Insert", "LinkedList_Init", "LinkedList_Contains",
+ * "LinkedList_PushFront".
+*/
+static int
+Storage_recordFile(storage_t* storage, const char* str_client, const char* pathname)
+{
+	int err, contains;
+	linked_list_t* record = NULL;
+	linked_list_t* const* found = NULL;
+
+	if ((errno = pthread_mutex_lock(&(storage->clients_mutex))) != 0) return -1;
+	errno = 0;
+	found = (linked_list_t* const*) HashTable_GetPointerToData(storage->clients, (void*) str_client);
+	if (found) record = *found;
+	else // first file client holds
+	{
+		if (errno != ENOENT) goto failure;
+		if (!(record = LinkedList_Init(free))) goto failure;
+		if (HashTable_Insert(storage->clients, (void*) str_client, strlen(str_client) + 1,
+					(void*) &record, sizeof(record)) != 1)
+		{
+			err = errno;
+			LinkedList_Free(record);
+			errno = err;
+			goto failure;
+		}
+	}
+	if ((contains = LinkedList_Contains(record, pathname)) == -1) goto failure;
+	if (contains == 0 && LinkedList_PushFront(record, pathname, strlen(pathname) + 1, NULL, 0) != 0) goto failure;
+	pthread_mutex_unlock(&(storage->clients_mutex));
+	return 0;
+
+	failure:
+		err = errno;
+		pthread_mutex_unlock(&(storage->clients_mutex));
+		errno = err;
+		return -1;
+}
+
+/**
+ * @brief Removes given file from given client's record, if it is there.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines
+ * "pthread_mutex_lock", "HashTable_GetPointerToData", "LinkedList_Remove".
+*/
+static int
+Storage_unrecordFile(storage_t* storage, const char* str_client, const char* pathname)
+{
+	int err;
+	linked_list_t* const* found = NULL;
+
+	if ((errno = pthread_mutex_lock(&(storage->clients_mutex))) != 0) return -1;
+	errno = 0;
+	found = (linked_list_t* const*) HashTable_GetPointerToData(storage->clients, (void*) str_client);
+	if ((!found && errno != ENOENT) || (found && LinkedList_Remove(*found, pathname) == -1))
+	{
+		err = errno;
+		pthread_mutex_unlock(&(storage->clients_mutex));
+		errno = err;
+		return -1;
+	}
+	pthread_mutex_unlock(&(storage->clients_mutex));
+	return 0;
+}
+
+/**
+ * @brief Removes given file, which is about to be deleted, from the record of every client holding it.
+ * @returns 0 on success, -1 on failure.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines
+ * "Node_CopyKey", "Storage_unrecordFile".
+*/
+static int
+Storage_forgetFile(storage_t* storage, const stored_file_t* file)
+{
+	char* key = NULL;
+	char str_client[SIZELEN];
+	int err;
+
+	for (const node_t* node = LinkedList_GetFirst(file->called_open); node; node = Node_GetNext(node))
+	{
+		if (Node_CopyKey(node, &key) != 0) return -1;
+		err = Storage_unrecordFile(storage, key, file->name);
+		free(key); key = NULL;
+		if (err != 0) return -1;
+	}
+	// locks and reservations outlive their owner's open
+	if (file->lock_owner != 0)
+	{
+		snprintf(str_client, SIZELEN, "%d", file->lock_owner);
+		if (Storage_unrecordFile(storage, str_client, file->name) != 0) return -1;
+	}
+	if (file->reserved_by != 0)
+	{
+		snprintf(str_client, SIZELEN, "%d", file->reserved_by);
+		if (Storage_unrecordFile(storage, str_client, file->name) != 0) return -1;
+	}
+	return 0;
+}
+
 /**
  * @brief Gets victim name from storage.
  * @returns 0 on success, -1 on failure.
@@ -234,6 +375,7 @@ Storage_getVictim(storage_t* storage, char** victim_name)
 			errno = 0;
 			i = LinkedList_PopBack(storage->names, victim_name, NULL);
 			if (i == 0 && errno == ENOMEM) return -1;
+			RadixTree_Remove(storage->index, *victim_name);
 			return 0;
 
 		case LFU:
@@ -262,6 +404,7 @@ Storage_getVictim(storage_t* storage, char** victim_name)
 			strcpy(victim, stats[0].name);
 			// remove victim from names
 			LinkedList_Remove(storage->names, victim);
+			RadixTree_Remove(storage->index, victim);
 			*victim_name = victim;
 			while (j != i) { free(stats[j].name); j++; }
 			free(stats);
@@ -294,6 +437,7 @@ Storage_getVictim(storage_t* storage, char** victim_name)
 			strcpy(victim, stats[0].name);
 			// remove victim from names
 			LinkedList_Remove(storage->names, victim);
+			RadixTree_Remove(storage->index, victim);
 			*victim_name = victim;
 			while (j != i) { free(stats[j].name); j++; }
 			free(stats);
@@ -313,8 +457,64 @@ Storage_getVictim(storage_t* storage, char** victim_name)
 		return -1;
 }
 
+/**
+ * @brief Evicts files according to storage's replacement policy till there is enough room for given number of files
+ * and given number of bytes. Lock over storage must have already been acquired in writer mode.
+ * @returns 0 on success, -1 on failure.
+ * @param storage cannot be NULL.
+ * @param pathname if it is not NULL and the file it denotes gets evicted, no other file is evicted.
+ * @param evicted if NULL, evicted files' data is not saved; otherwise it is initialized as soon as a file is evicted.
+ * @param pathname_evicted cannot be NULL. It is toggled on if the file pathname denotes got evicted.
+ * @exception The function may fail and set "errno" for any of the errors specified for the routines "Storage_getVictim",
+ * "HashTable_GetPointerToData", "Storage_forgetFile", "HashTable_DeleteNode", "LinkedList_Init", "LinkedList_PushFront".
+*/
+static int
+Storage_makeRoom(storage_t* storage, const char* pathname, size_t files, size_t size, linked_list_t** evicted,
+			bool* pathname_evicted)
+{
+	int err;
+	char* victim_name = NULL; // used to denote victim's name
+	stored_file_t* victim = NULL; // used to denote victim as a file inside storage
+
+	*pathname_evicted = false;
+	if (storage->files_no + files <= storage->max_files_no && storage->storage_size + size <= storage->max_storage_size)
+		return 0;
+	// there's no room: start replacement algorithm
+	storage->evictions_no++;
+	if (evicted && !*evicted) // if a list is specified, save evicted files' data
+	{
+		*evicted = LinkedList_Init(NULL);
+		if (!*evicted) return -1;
+	}
+	while (!(*pathname_evicted) && storage->files_no != 0)
+	{
+		if (storage->files_no + files <= storage->max_files_no && storage->storage_size + size <= storage->max_storage_size)
+			break;
+		if (Storage_getVictim(storage, &victim_name) != 0) return -1;
+		if (pathname && strcmp(victim_name, pathname) == 0) // file the operation is performed on got evicted
+			*pathname_evicted = true;
+		victim = (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) victim_name);
+		if (!victim) goto failure;
+		if (evicted && LinkedList_PushFront(*evicted, victim_name, strlen(victim_name) + 1,
+					victim->contents, victim->contents_size) != 0)
+			goto failure;
+		storage->storage_size -= victim->contents_size + victim->reserved; // update storage size
+		storage->files_no--; // update number of files
+		if (Storage_forgetFile(storage, victim) != 0) goto failure;
+		if (HashTable_DeleteNode(storage->files, (void*) victim_name) == -1) goto failure;
+		free(victim_name); victim_name = NULL;
+	}
+	return 0;
+
+	failure:
+		err = errno;
+		free(victim_name);
+		errno = err;
+		return -1;
+}
+
 int
-Storage_openFile(storage_t* storage, const char* pathname, int flags, int client)
+Storage_openFile(storage_t* storage, const char* pathname, int flags, linked_list_t** evicted, int client)
 {
 	if (!storage || !pathname)
 	{
@@ -323,9 +523,11 @@ Storage_openFile(storage_t* storage, const char* pathname, int flags, int client
 	}
 
 	int err, exists;
+	bool failure = false; // never toggled on as the file to be created cannot be a victim
 	stored_file_t* file;
 	char str_client[SIZELEN]; // used to denote client as a string
 
+	if (evicted) *evicted = NULL;
 	int len = snprintf(str_client, SIZELEN, "%d", client); // converting client to a string
 	bool w_lock = IS_O_CREATE_SET(flags);
 
@@ -355,24 +557,23 @@ Storage_openFile(storage_t* storage, const char* pathname, int flags, int client
 			errno = ENOENT;
 			return OP_FAILURE;
 		}
-		if (storage->files_no == storage->max_files_no)
-		{
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
-			errno = ENOSPC;
-			return OP_FAILURE;
-		}
-		else // add file to storage
+		// storage is full: make room for one more file
+		RETURN_FATAL_IF_NEQ(err, 0, Storage_makeRoom(storage, NULL, 1, 0, evicted, &failure));
+		// add file to storage
 		{
 			storage->files_no++;
+			storage->reached_files_no = MAX(storage->reached_files_no, storage->files_no);
 			RETURN_FATAL_IF_EQ(file, NULL, StoredFile_Init(pathname, NULL, 0));
 			if (IS_O_LOCK_SET(flags))
 				file->lock_owner = client; // client owns this file's lock
 			if (IS_O_LOCK_SET(flags) && w_lock)
 				file->potential_writer = client; // client can write this file
 			RETURN_FATAL_IF_NEQ(err, 0, LinkedList_PushFront(file->called_open, str_client, len+1, NULL, 0));
+			RETURN_FATAL_IF_NEQ(err, 0, Storage_recordFile(storage, str_client, pathname));
 			RETURN_FATAL_IF_EQ(err, -1, HashTable_Insert(storage->files, (void*) pathname, strlen(pathname) + 1,
 						(void*) file, sizeof(*file)));
 			RETURN_FATAL_IF_EQ(err, -1, LinkedList_PushFront(storage->names, pathname, strlen(pathname) + 1, NULL, 0));
+			RETURN_FATAL_IF_EQ(err, -1, RadixTree_Insert(storage->index, pathname));
 			// file has been copied inside storage
 			free(file);
 		}
@@ -415,6 +616,7 @@ Storage_openFile(storage_t* storage, const char* pathname, int flags, int client
 			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(file->rwlock));
 			// add the client to the list of the ones who opened this file
 			RETURN_FATAL_IF_NEQ(err, 0 , LinkedList_PushFront(file->called_open, str_client, len + 1, NULL, 0));
+			RETURN_FATAL_IF_NEQ(err, 0, Storage_recordFile(storage, str_client, pathname));
 			// edit file usage params
 			file->last_used = time(NULL);
 			file->frequency++;
@@ -431,6 +633,13 @@ Storage_openFile(storage_t* storage, const char* pathname, int flags, int client
 
 int
 Storage_readFile(storage_t* storage, const char* pathname, void** buf, size_t* size, int client)
+{
+	return Storage_readFileRange(storage, pathname, 0, 0, buf, size, client);
+}
+
+int
+Storage_readFileRange(storage_t* storage, const char* pathname, size_t offset, size_t len, void** buf, size_t* size,
+			int client)
 {
 	if (!storage || !pathname || !buf || !size)
 	{
@@ -472,17 +681,19 @@ Storage_readFile(storage_t* storage, const char* pathname, void** buf, size_t* s
 		}
 		else // file has been opened by this client
 		{
-			if (file->contents_size == 0 || !file->contents)
+			if (file->contents_size == 0 || !file->contents || offset >= file->contents_size)
 			{
 				RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
 				RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
 				return OP_SUCCESS;
 			}
-			else // file is not empty
+			else // requested slice is not empty
 			{
-				tmp_size = file->contents_size;
+				// only the requested slice is copied
+				tmp_size = file->contents_size - offset;
+				if (len != 0 && len < tmp_size) tmp_size = len;
 				RETURN_FATAL_IF_EQ(tmp_contents, NULL, malloc(tmp_size));
-				memcpy(tmp_contents, file->contents, tmp_size);
+				memcpy(tmp_contents, (char*) file->contents + offset, tmp_size);
 				RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
 				RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(file->rwlock));
 				file->potential_writer = 0; // writing this file is not allowed
@@ -508,129 +719,284 @@ Storage_readFile(storage_t* storage, const char* pathname, void** buf, size_t* s
 }
 
 int
-Storage_readNFiles(storage_t* storage, linked_list_t** read_files, size_t n, int client)
+Storage_statFile(storage_t* storage, const char* pathname, file_stat_t* stat)
 {
-	if (!storage || !read_files)
+	if (!storage || !pathname || !stat)
 	{
 		errno = EINVAL;
 		return OP_FAILURE;
 	}
 
-	int err;
-	char str_client[SIZELEN]; // used to denote client as a string
-	stored_file_t* file = NULL;
-	linked_list_t* names = NULL; // list of file names in storage
-	linked_list_t* tmp = NULL;
+	int err, exists;
+	stored_file_t* file;
 
-	snprintf(str_client, SIZELEN, "%d", client); // convert int client to string
+	memset(stat, 0, sizeof(file_stat_t));
 	RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadLock(storage->lock));
 
-	if (storage->files_no == 0) // storage is empty
+	RETURN_FATAL_IF_EQ(exists, -1, HashTable_Find(storage->files, (void*) pathname));
+
+	if (exists == 1) // file is inside the storage
 	{
-		*read_files = NULL;
+		RETURN_FATAL_IF_EQ(file, NULL, (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) pathname));
+		// neither contents nor usage params are touched, hence a read lock is enough
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadLock(file->rwlock));
+		stat->size = file->contents_size;
+		stat->version = file->version;
+		stat->lock_owner = file->lock_owner;
+		stat->open_count = LinkedList_GetNumberOfElements(file->called_open);
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
 		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
-		return OP_SUCCESS;
 	}
-	// storage is not empty
-	RETURN_FATAL_IF_EQ(names, NULL, LinkedList_CopyAllKeys(storage->names));
-	int readfiles_no = 0;
-	int attempts = 0;
-	bool read_all = ((n == 0) || (n >= storage->files_no));
-	RETURN_FATAL_IF_EQ(tmp, NULL, LinkedList_Init(NULL));
+	else // file is not inside the storage
+	{
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+		errno = EBADF;
+		return OP_FAILURE;
+	}
+	return OP_SUCCESS;
+}
+
+int
+Storage_listFiles(storage_t* storage, const char* prefix, linked_list_t** names)
+{
+	if (!storage || !names)
+	{
+		errno = EINVAL;
+		return OP_FAILURE;
+	}
+
+	int err;
+	linked_list_t* tmp_names = NULL;
+
+	*names = NULL;
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadLock(storage->lock));
+	// only the subtree of names matching prefix is visited
+	tmp_names = RadixTree_CopyKeysWithPrefix(storage->index, prefix, 0);
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+	if (!tmp_names) return OP_FATAL;
+	*names = tmp_names;
+	return OP_SUCCESS;
+}
+
+struct _storage_cursor
+{
+	storage_t* storage; // storage the cursor is scanning
+	linked_list_t* names; // names of files yet to be visited
+	size_t left; // number of files yet to be read
+	bool read_all; // toggled on when every readable file is to be read
+	int client; // client the scan has been requested by
+};
+
+int
+Storage_readNFiles(storage_t* storage, storage_cursor_t** cursor, size_t n, const char* prefix, int client)
+{
+	if (!storage || !cursor)
+	{
+		errno = EINVAL;
+		return OP_FAILURE;
+	}
+
+	int err;
+	storage_cursor_t* tmp = NULL;
+	linked_list_t* names = NULL; // snapshot of file names in storage
+
+	*cursor = NULL;
+	RETURN_FATAL_IF_EQ(tmp, NULL, (storage_cursor_t*) malloc(sizeof(storage_cursor_t)));
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadLock(storage->lock));
+	// only names are copied: contents will be read one file at a time
+	if (prefix && *prefix != '\0') names = RadixTree_CopyKeysWithPrefix(storage->index, prefix, 0);
+	else if (storage->files_no == 0) names = LinkedList_Init(NULL);
+	else names = LinkedList_CopyAllKeys(storage->names);
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+	if (!names)
+	{
+		free(tmp);
+		return OP_FATAL;
+	}
+	tmp->read_all = ((n == 0) || (n >= LinkedList_GetNumberOfElements(names)));
+
+	tmp->storage = storage;
+	tmp->names = names;
+	tmp->left = n;
+	tmp->client = client;
+	*cursor = tmp;
+	return OP_SUCCESS;
+}
+
+int
+Storage_cursorNext(storage_cursor_t* cursor, char** name, void** buf, size_t* size)
+{
+	if (!cursor || !name || !buf || !size)
+	{
+		errno = EINVAL;
+		return OP_FAILURE;
+	}
+
+	int err, exists;
+	storage_t* storage = cursor->storage;
+	stored_file_t* file = NULL;
+	char* pathname = NULL;
+	void* tmp_contents = NULL;
+	size_t tmp_size = 0;
+
+	*name = NULL; *buf = NULL; *size = 0;
 	while (1)
 	{
-		// if n files have been read and n is not 0
-		// or
-		// every file in storage has been read (successfully or not)
-		if ((readfiles_no == n && !read_all) || (read_all && attempts == storage->files_no)) break;
-		char* pathname = NULL;
-		RETURN_FATAL_IF_EQ(err, -1, LinkedList_PopFront(names, &pathname, NULL));
+		// n files have been read or every file has been visited
+		if ((!cursor->read_all && cursor->left == 0) || LinkedList_GetNumberOfElements(cursor->names) == 0)
+			return OP_SUCCESS;
+		errno = 0;
+		if (LinkedList_PopFront(cursor->names, &pathname, NULL) == 0 && errno == ENOMEM) return OP_FATAL;
+		/**
+		 * Storage lock is only held while a single file is being copied
+		 * so that writers can make progress in between two files.
+		*/
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadLock(storage->lock));
+		RETURN_FATAL_IF_EQ(exists, -1, HashTable_Find(storage->files, (void*) pathname));
+		if (exists == 0) // file has been removed since the scan started
+		{
+			RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+			free(pathname);
+			continue;
+		}
 		RETURN_FATAL_IF_EQ(file, NULL, (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) pathname));
 		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadLock(file->rwlock));
 		// a client already owns this file's lock
-		if (file->lock_owner != 0 && file->lock_owner != client)
+		if (file->lock_owner != 0 && file->lock_owner != cursor->client)
 		{
 			RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
+			RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
 			free(pathname);
-			attempts++;
 			continue;
 		}
 		/**
 		 * readNFiles shall work on files yet to be opened by client as doing this any other way would kill its purpose.
 		*/
-		// file is empty
-		if (file->contents_size == 0 || !file->contents)
+		if (file->contents_size != 0 && file->contents) // file is not empty
 		{
-			RETURN_FATAL_IF_NEQ(err, 0, LinkedList_PushBack(tmp, pathname, strlen(pathname) + 1, NULL, 0));
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(file->rwlock));
-			file->potential_writer = 0;
-			// edit file usage params
-			file->last_used = time(NULL);
-			file->frequency++;
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(file->rwlock));
-			free(pathname);
-			readfiles_no++;
-			attempts++;
-			continue;
-		}
-		else
-		{
-			RETURN_FATAL_IF_NEQ(err, 0, LinkedList_PushBack(tmp, pathname, strlen(pathname) + 1, file->contents,
-						file->contents_size + 1));
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(file->rwlock));
-			file->potential_writer = 0;
-			// edit file usage params
-			file->last_used = time(NULL);
-			file->frequency++;
-			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(file->rwlock));
-			free(pathname);
-			readfiles_no++;
-			attempts++;
-			continue;
+			tmp_size = file->contents_size;
+			tmp_contents = malloc(tmp_size);
+			if (!tmp_contents)
+			{
+				free(pathname);
+				RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
+				RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+				errno = ENOMEM;
+				return OP_FATAL;
+			}
+			memcpy(tmp_contents, file->contents, tmp_size);
 		}
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(file->rwlock));
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(file->rwlock));
+		file->potential_writer = 0;
+		// edit file usage params
+		file->last_used = time(NULL);
+		file->frequency++;
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(file->rwlock));
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+		if (!cursor->read_all) cursor->left--;
+		*name = pathname;
+		*buf = tmp_contents;
+		*size = tmp_size;
+		return OP_SUCCESS;
 	}
-	LinkedList_Free(names);
-	*read_files = tmp;
-	RETURN_FATAL_IF_NEQ(err, 0, RWLock_ReadUnlock(storage->lock));
+}
+
+void
+Storage_cursorFree(storage_cursor_t* cursor)
+{
+	if (!cursor) return;
+	LinkedList_Free(cursor->names);
+	free(cursor);
+}
+
+int
+Storage_reserveFile(storage_t* storage, const char* pathname, size_t length, linked_list_t** evicted, int client)
+{
+	if (!storage || !pathname)
+	{
+		errno = EINVAL;
+		return OP_FAILURE;
+	}
+
+	int err, exists;
+	bool failure = false; // toggled on if replacement algorithm chooses pathname as a victim
+	stored_file_t* stored_file = NULL; // used to denote pathname as a file inside storage
+
+	if (evicted) *evicted = NULL;
+	// file must not be bigger than storage's size
+	if (length > storage->max_storage_size)
+	{
+		errno = EFBIG;
+		return OP_FAILURE;
+	}
+
+	// as files may be deleted, no readers are allowed on storage
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(storage->lock));
+
+	// update storage info
+	storage->reached_files_no = MAX(storage->reached_files_no, storage->files_no);
+	storage->reached_storage_size = MAX(storage->reached_storage_size, storage->storage_size);
+
+	RETURN_FATAL_IF_EQ(exists, -1, HashTable_Find(storage->files, (void*) pathname));
+	if (exists == 0) // file is not inside the storage
+	{
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+		errno = EBADF;
+		return OP_FAILURE;
+	}
+	RETURN_FATAL_IF_EQ(stored_file, NULL, (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) pathname));
+	// the same requirements as writing apply, and space may be reserved only once
+	if (stored_file->potential_writer != client || stored_file->reserved_by != 0)
+	{
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+		errno = EACCES;
+		return OP_FAILURE;
+	}
+	// there's no room for this file: start replacement algorithm
+	RETURN_FATAL_IF_NEQ(err, 0, Storage_makeRoom(storage, pathname, 0, length, evicted, &failure));
+	if (failure) // file to be written got evicted
+	{
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+		errno = EIDRM;
+		return OP_FAILURE;
+	}
+	stored_file->reserved = length;
+	stored_file->reserved_by = client;
+	storage->storage_size += length;
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
 	return OP_SUCCESS;
 }
 
 int
-Storage_writeFile(storage_t* storage, const char* pathname, size_t length, const char* contents,
+Storage_writeFile(storage_t* storage, const char* pathname, size_t length, char* contents,
 			linked_list_t** evicted, int client)
 {
 	if (!storage || !pathname)
 	{
+		free(contents);
 		errno = EINVAL;
 		return OP_FAILURE;
 	}
 
 	int err, exists;
 	bool failure = false; // toggled on if replacement algorithm chooses pathname as a victim
-	char* copy_contents = NULL; // buffer of contents
-	char* victim_name = NULL; // used to denote victim's name
+	// contents were received straight into their own buffer: it is kept as it is, without being copied
+	char* copy_contents = (length != 0) ? contents : NULL;
 	stored_file_t* stored_file = NULL; // used to denote pathname as a file inside storage
-	stored_file_t* tmp = NULL; // used to denote victim as a file inside storage
-	linked_list_t* tmp_evicted = NULL; // list of evicted files
 
+	if (evicted) *evicted = NULL;
+	if (length == 0) free(contents);
 	// file must not be bigger than storage's size
 	if (length > storage->max_storage_size)
 	{
-		if (evicted) *evicted = tmp_evicted;
+		free(copy_contents);
 		errno = EFBIG;
 		return OP_FAILURE;
 	}
 
 	// file is not empty
-	if (length != 0)
-	{
-		// +1 for '\0'
-		RETURN_FATAL_IF_EQ(copy_contents, NULL, (char*) malloc(sizeof(char) * (length + 1)));
-		memcpy(copy_contents, contents, length);
-		copy_contents[length] = '\0'; // string needs to be null terminated
-	}
+	if (copy_contents) copy_contents[length] = '\0'; // string needs to be null terminated
 
 	// as files may be deleted, no readers are allowed on storage
 	RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(storage->lock));
@@ -645,53 +1011,37 @@ Storage_writeFile(storage_t* storage, const char* pathname, size_t length, const
 	{
 		// as there can be at most one writer at a time, no locks need to be acquired over file
 		RETURN_FATAL_IF_EQ(stored_file, NULL, (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) pathname));
+		// space reserved by this client is given back: room is made again for the actual contents,
+		// which is going to be enough unless other files have been stored in the meantime
+		if (stored_file->reserved_by == client)
+		{
+			storage->storage_size -= stored_file->reserved;
+			stored_file->reserved = 0;
+			stored_file->reserved_by = 0;
+		}
 
 		if (stored_file->potential_writer != client) // client cannot write this file
 		{
-			if (evicted) *evicted = tmp_evicted;
 			free(copy_contents);
 			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
 			errno = EACCES;
 			return OP_FAILURE;
 		}
-		// there's no room for this file
-		// start replacement algorithm
-		if (storage->storage_size + length > storage->max_storage_size)
+		// there's no room for this file: start replacement algorithm
+		RETURN_FATAL_IF_NEQ(err, 0, Storage_makeRoom(storage, pathname, 0, length, evicted, &failure));
+		if (failure) // file to be written got evicted
 		{
-			storage->evictions_no++;
-			if (evicted) // if a list is specified, save evicted files' data
-				{ RETURN_FATAL_IF_EQ(tmp_evicted, NULL, LinkedList_Init(NULL)); }
-			while (!failure)
-			{
-				if (storage->storage_size + length <= storage->max_storage_size) break;
-				RETURN_FATAL_IF_NEQ(err, 0, Storage_getVictim(storage, &victim_name));
-				if (strcmp(victim_name, pathname) == 0) // file to be written got evicted
-					failure = true;
-				RETURN_FATAL_IF_EQ(tmp, NULL, (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) victim_name));
-				if (evicted)
-				{
-					RETURN_FATAL_IF_NEQ(err, 0, LinkedList_PushFront(tmp_evicted, victim_name,
-								strlen(victim_name) + 1, tmp->contents, tmp->contents_size));
-				}
-				storage->storage_size -= tmp->contents_size; // update storage size
-				storage->files_no--; // update number of files
-				RETURN_FATAL_IF_NEQ(err, 0, HashTable_DeleteNode(storage->files, (void*) victim_name));
-				free(victim_name);
-			}
-			if (evicted) *evicted = tmp_evicted;
-			if (failure) // file to be written got evicted
-			{
-				free(copy_contents);
-				RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
-				errno = EIDRM;
-				return OP_FAILURE;
-			}
+			free(copy_contents);
+			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+			errno = EIDRM;
+			return OP_FAILURE;
 		}
 		if (copy_contents) // file is not empty
 		{
 			stored_file->contents_size = length;
 			stored_file->contents = (void*) copy_contents;
 		}
+		stored_file->version++;
 		stored_file->potential_writer = 0;
 		storage->storage_size += length;
 		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
@@ -719,13 +1069,11 @@ Storage_appendToFile(storage_t* storage, const char* pathname, void* buf, size_t
 	int err; // used as a placeholder for functions' return values
 	int exists; // set to 1 if file is inside the storage
 	bool failure = false; // toggled on when the file the operation should be performed on is a victim.
-	char* victim_name; // used to denote victim's name
 	stored_file_t* file; // used to denote file in storage corresponding pathname
-	stored_file_t* tmp; // used to denote victim(s)
-	linked_list_t* tmp_evicted = NULL;
 	void* new_contents;
 	char str_client[SIZELEN]; // used when converting int client to a string
 
+	if (evicted) *evicted = NULL;
 	snprintf(str_client, SIZELEN, "%d", client);
 	RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(storage->lock));
 
@@ -756,34 +1104,13 @@ Storage_appendToFile(storage_t* storage, const char* pathname, void* buf, size_t
 			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
 			return OP_SUCCESS;
 		}
-		if (storage->storage_size + size > storage->max_storage_size) // handle eventual file deletion
+		// handle eventual file deletion
+		RETURN_FATAL_IF_NEQ(err, 0, Storage_makeRoom(storage, pathname, 0, size, evicted, &failure));
+		if (failure)
 		{
-			storage->evictions_no++;
-			if (evicted) RETURN_FATAL_IF_EQ(tmp_evicted, NULL, LinkedList_Init(NULL));
-			while (!failure)
-			{
-				if (storage->storage_size + size <= storage->max_storage_size) break;
-				RETURN_FATAL_IF_NEQ(err, 0, Storage_getVictim(storage, &victim_name));
-				if (strcmp(victim_name, pathname) == 0) failure = true;
-				RETURN_FATAL_IF_EQ(tmp, NULL, (stored_file_t*)
-							HashTable_GetPointerToData(storage->files, (void*) victim_name));
-				if (evicted)
-				{
-					RETURN_FATAL_IF_NEQ(err, 0, LinkedList_PushFront(tmp_evicted, victim_name,
-								strlen(victim_name) + 1, tmp->contents, strlen(tmp->contents) + 1));
-				}
-				storage->storage_size -= tmp->contents_size;
-				storage->files_no--;
-				RETURN_FATAL_IF_NEQ(err, 0, HashTable_DeleteNode(storage->files, (void*) victim_name));
-				free(victim_name);
-			}
-			if (evicted) *evicted = tmp_evicted;
-			if (failure)
-			{
-				RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
-				errno = EIDRM;
-				return OP_FAILURE;
-			}
+			RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+			errno = EIDRM;
+			return OP_FAILURE;
 		}
 		new_contents = realloc(file->contents, file->contents_size + size);
 		if (!new_contents) // realloc failed
@@ -795,6 +1122,7 @@ Storage_appendToFile(storage_t* storage, const char* pathname, void* buf, size_t
 		file->contents = new_contents;
 		memcpy(file->contents + file->contents_size, buf, size);
 		file->contents_size += size;
+		file->version++;
 		file->potential_writer = 0;
 		storage->storage_size += size;
 		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
@@ -984,6 +1312,9 @@ Storage_closeFile(storage_t* storage, const char* pathname, int client)
 
 			RETURN_FATAL_IF_NEQ(err, 0, LinkedList_Remove(file->called_open, str_client));
 			file->potential_writer = 0;
+			// client keeps holding the file if it still owns its lock or space reserved in it
+			if (file->lock_owner != client && file->reserved_by != client)
+				RETURN_FATAL_IF_NEQ(err, 0, Storage_unrecordFile(storage, str_client, pathname));
 			// edit file usage params
 			file->last_used = time(NULL);
 			file->frequency++;
@@ -1033,10 +1364,12 @@ Storage_removeFile(storage_t* storage, const char* pathname, int client)
 			errno = EPERM;
 			return OP_FAILURE;
 		}
-		storage->storage_size -= file->contents_size;
+		storage->storage_size -= file->contents_size + file->reserved;
 		storage->files_no--;
+		RETURN_FATAL_IF_NEQ(err, 0, Storage_forgetFile(storage, file));
 		RETURN_FATAL_IF_EQ(err, -1, HashTable_DeleteNode(storage->files, (void*) pathname));
 		RETURN_FATAL_IF_EQ(err, -1, LinkedList_Remove(storage->names, pathname));
+		RETURN_FATAL_IF_EQ(err, -1, RadixTree_Remove(storage->index, pathname));
 		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
 
 	}
@@ -1049,6 +1382,56 @@ Storage_removeFile(storage_t* storage, const char* pathname, int client)
 	return OP_SUCCESS;
 }
 
+int
+Storage_clientLeft(storage_t* storage, int client)
+{
+	if (!storage)
+	{
+		errno = EINVAL;
+		return OP_FAILURE;
+	}
+
+	int err;
+	stored_file_t* file;
+	linked_list_t* const* record; // names of the files client holds
+	char* name = NULL; // name of currently visited file
+	char str_client[SIZELEN];
+
+	snprintf(str_client, SIZELEN, "%d", client);
+	// storage is locked in write mode so that no other thread may work on any file, nor on any record
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteLock(storage->lock));
+	errno = 0;
+	record = (linked_list_t* const*) HashTable_GetPointerToData(storage->clients, (void*) str_client);
+	if (!record) // client has never held any file
+	{
+		if (errno != ENOENT) return OP_FATAL;
+		RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+		return OP_SUCCESS;
+	}
+	while (LinkedList_GetNumberOfElements(*record) != 0)
+	{
+		errno = 0;
+		LinkedList_PopFront(*record, &name, NULL);
+		if (!name && errno != 0) return OP_FATAL;
+		RETURN_FATAL_IF_EQ(file, NULL, (stored_file_t*) HashTable_GetPointerToData(storage->files, (void*) name));
+		RETURN_FATAL_IF_EQ(err, -1, LinkedList_Remove(file->called_open, str_client));
+		if (file->lock_owner == client) file->lock_owner = 0;
+		if (file->potential_writer == client) file->potential_writer = 0;
+		// space reserved for contents which will never be sent is given back
+		if (file->reserved_by == client)
+		{
+			storage->storage_size -= file->reserved;
+			file->reserved = 0;
+			file->reserved_by = 0;
+		}
+		free(name); name = NULL;
+	}
+	// descriptor may be handed to a new client, which starts with an empty record
+	RETURN_FATAL_IF_EQ(err, -1, HashTable_DeleteNode(storage->clients, (void*) str_client));
+	RETURN_FATAL_IF_NEQ(err, 0, RWLock_WriteUnlock(storage->lock));
+	return OP_SUCCESS;
+}
+
 size_t
 Storage_GetReachedFiles(storage_t* storage)
 {
@@ -1101,6 +1484,9 @@ Storage_Free(storage_t* storage)
 	if (!storage) return;
 	RWLock_Free(storage->lock);
 	LinkedList_Free(storage->names);
+	RadixTree_Free(storage->index);
 	HashTable_Free(storage->files);
+	HashTable_Free(storage->clients);
+	pthread_mutex_destroy(&(storage->clients_mutex));
 	free(storage);
 }
\ No newline at end of file
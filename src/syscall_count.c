@@ -0,0 +1,119 @@
+/**
+ * @brief Counts the system calls a process issues through the libc wrappers the server uses.
+ * To be preloaded (LD_PRELOAD): counts are written to the file named by SYSCALL_COUNT_FILE, or to stderr,
+ * when the process exits. System calls libc issues on its own (e.g. futexes of pthread condition variables)
+ * are not counted.
+ * @author Giacomo Trapani.
+*/
+
+#define _GNU_SOURCE // RTLD_NEXT
+
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Used to look up the next definition of given function the first time it is called.
+#define NEXT(function) \
+	static __typeof__(function)* next = NULL; \
+	if (!next) next = (__typeof__(function)*) dlsym(RTLD_NEXT, #function)
+
+#define COUNT(counter) __atomic_fetch_add(&(counters[counter]), 1, __ATOMIC_RELAXED)
+
+enum { READ, WRITE, RECV, SENDMSG, EPOLL_WAIT, EPOLL_CTL, ACCEPT4, SYSCALL, COUNTERS };
+
+static const char* names[COUNTERS] = { "read", "write", "recv", "sendmsg", "epoll_wait", "epoll_ctl", "accept4",
+		"syscall" };
+static unsigned long counters[COUNTERS];
+
+ssize_t
+read(int fd, void* buf, size_t count)
+{
+	NEXT(read);
+	COUNT(READ);
+	return next(fd, buf, count);
+}
+
+ssize_t
+write(int fd, const void* buf, size_t count)
+{
+	NEXT(write);
+	COUNT(WRITE);
+	return next(fd, buf, count);
+}
+
+ssize_t
+recv(int fd, void* buf, size_t len, int flags)
+{
+	NEXT(recv);
+	COUNT(RECV);
+	return next(fd, buf, len, flags);
+}
+
+ssize_t
+sendmsg(int fd, const struct msghdr* msg, int flags)
+{
+	NEXT(sendmsg);
+	COUNT(SENDMSG);
+	return next(fd, msg, flags);
+}
+
+int
+epoll_wait(int epfd, struct epoll_event* events, int maxevents, int timeout)
+{
+	NEXT(epoll_wait);
+	COUNT(EPOLL_WAIT);
+	return next(epfd, events, maxevents, timeout);
+}
+
+int
+epoll_ctl(int epfd, int op, int fd, struct epoll_event* event)
+{
+	NEXT(epoll_ctl);
+	COUNT(EPOLL_CTL);
+	return next(epfd, op, fd, event);
+}
+
+int
+accept4(int fd, struct sockaddr* addr, socklen_t* addrlen, int flags)
+{
+	NEXT(accept4);
+	COUNT(ACCEPT4);
+	return next(fd, addr, addrlen, flags);
+}
+
+long
+syscall(long number, ...)
+{
+	va_list args;
+	long a[6];
+
+	NEXT(syscall);
+	COUNT(SYSCALL);
+	// every system call takes at most six arguments: passing all of them is harmless
+	va_start(args, number);
+	for (int i = 0; i < 6; i++)
+		a[i] = va_arg(args, long);
+	va_end(args);
+	return next(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+__attribute__((destructor)) static void
+dump_counters()
+{
+	const char* filename = getenv("SYSCALL_COUNT_FILE");
+	FILE* file = filename ? fopen(filename, "w") : NULL;
+	unsigned long total = 0;
+
+	if (!file) file = stderr;
+	for (int i = 0; i < COUNTERS; i++)
+		total += counters[i];
+	fprintf(file, "total %lu", total);
+	for (int i = 0; i < COUNTERS; i++)
+		fprintf(file, " %s %lu", names[i], counters[i]);
+	fprintf(file, "\n");
+	if (file != stderr) fclose(file);
+}